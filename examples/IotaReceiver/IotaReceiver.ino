@@ -23,6 +23,7 @@
  * SOFTWARE.
  */
 
+#include <IotaPaymentWatcher.h>
 #include <IotaWallet.h>
 #ifdef ESP8266
 #include <ESP8266WiFi.h>
@@ -41,7 +42,19 @@ WiFiClient networkClient;
 
 IotaClient iotaClient(networkClient, "node05.iotatoken.nl", 14265);
 IotaWallet iotaWallet(iotaClient);
-String receiveAddr;
+IotaPaymentWatcher paymentWatcher(iotaClient);
+uint64_t received;
+
+void paymentDetected(const struct iotaPayment &payment, void *arg) {
+  printf("Incoming payment of %llu IOTAs (bundle %s), waiting for "
+    "confirmation\n", payment.value, payment.bundle.c_str());
+}
+
+void paymentConfirmed(const struct iotaPayment &payment, void *arg) {
+  received += payment.value;
+  printf("Payment of %llu IOTAs confirmed, got %llu IOTAs so far\n",
+    payment.value, received);
+}
 
 void setup() {
   String seed =
@@ -69,10 +82,13 @@ void setup() {
     return;
   }
 
+  String receiveAddr;
   if (iotaWallet.getReceiveAddress(receiveAddr)) {
     printf("Please send IOTAs to this address: %s\n",
       receiveAddr.c_str());
-    receiveAddr.remove(81);	/* remove address checksum */
+    paymentWatcher.addAddress(receiveAddr);
+    paymentWatcher.onPayment(paymentDetected);
+    paymentWatcher.onConfirmed(paymentConfirmed);
   }
   else {
     printf("Couldn't get receive address\n");
@@ -80,15 +96,10 @@ void setup() {
 }
 
 void loop() {
-  std::vector<String> addrs;
-  std::vector<uint64_t> balances;
-
-  addrs.push_back(receiveAddr);
-  if (iotaClient.getBalances(addrs, balances)) {
-    printf("Got %llu IOTAs so far\n", balances[0]);
-  }
-  else {
-    printf("Cannot get balances\n");
+  /* The watcher polls the IOTA node only when its polling interval has
+   * elapsed, backing off while no payments are coming in. */
+  if (!paymentWatcher.update()) {
+    printf("Cannot check incoming payments\n");
   }
-  delay(10000);
+  delay(100);
 }
@@ -0,0 +1,212 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Tryte conversion micro-benchmark
+ *
+ * Measures the throughput of the tryte conversion kernels on whole
+ * transactions and on hashes, and compares it with a character-by-character
+ * reference implementation equivalent to the one in the IOTA C library.
+ * Build and run on a host with:
+ *   make tryte_conversion && ./tryte_conversion
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "IotaTrytes.h"
+
+#define TX_TRYTES		2673
+#define HASH_TRYTES		81
+#define BUF_TRYTES		(1024 * TX_TRYTES)
+#define MIN_SECONDS		0.5
+
+static char trytes[BUF_TRYTES];
+static int8_t values[BUF_TRYTES];
+static int8_t trits[3 * BUF_TRYTES];
+static volatile int64_t sink;
+
+static bool refValidate(const char *chars, unsigned int len) {
+	for (unsigned int i = 0; i < len; i++) {
+		char c = chars[i];
+
+		if ((c != '9') && ((c < 'A') || (c > 'Z'))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static int refCharToTryte(char c) {
+	int tryte = ((c == '9') ? 0 : (c - 'A' + 1));
+
+	return ((tryte > 13) ? (tryte - 27) : tryte);
+}
+
+static void refToValues(const char *chars, int8_t *vals, unsigned int len) {
+	for (unsigned int i = 0; i < len; i++) {
+		vals[i] = refCharToTryte(chars[i]);
+	}
+}
+
+static int64_t refToInt64(const char *chars, unsigned int len) {
+	int64_t value = 0;
+	int64_t weight = 1;
+
+	for (unsigned int i = 0; i < len; i++) {
+		value += refCharToTryte(chars[i]) * weight;
+		weight *= 27;
+	}
+	return value;
+}
+
+static double now() {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+typedef void (*benchFunc)(unsigned int unit);
+
+static void validateFast(unsigned int unit) {
+	for (unsigned int i = 0; i + unit <= BUF_TRYTES; i += unit) {
+		sink += iotaTrytesValidate(trytes + i, unit);
+	}
+}
+
+static void validateRef(unsigned int unit) {
+	for (unsigned int i = 0; i + unit <= BUF_TRYTES; i += unit) {
+		sink += refValidate(trytes + i, unit);
+	}
+}
+
+static void valuesFast(unsigned int unit) {
+	for (unsigned int i = 0; i + unit <= BUF_TRYTES; i += unit) {
+		iotaTrytesToValues(trytes + i, values + i, unit);
+	}
+	sink += values[0];
+}
+
+static void valuesRef(unsigned int unit) {
+	for (unsigned int i = 0; i + unit <= BUF_TRYTES; i += unit) {
+		refToValues(trytes + i, values + i, unit);
+	}
+	sink += values[0];
+}
+
+static void tritsFast(unsigned int unit) {
+	for (unsigned int i = 0; i + unit <= BUF_TRYTES; i += unit) {
+		iotaTrytesToTrits(trytes + i, trits + 3 * i, unit);
+	}
+	sink += trits[0];
+}
+
+static void tritsBackFast(unsigned int unit) {
+	for (unsigned int i = 0; i + unit <= BUF_TRYTES; i += unit) {
+		iotaTritsToTrytes(trits + 3 * i, trytes + i, unit);
+	}
+	sink += trytes[0];
+}
+
+/* Decodes the numeric fields of each transaction (the unit is ignored). */
+static void fieldsFast(unsigned int) {
+	for (unsigned int i = 0; i + TX_TRYTES <= BUF_TRYTES; i += TX_TRYTES) {
+		const char *tx = trytes + i;
+
+		sink += iotaTrytesToInt64(tx + 2268, 27) +
+				iotaTrytesToInt64(tx + 2322, 9) +
+				iotaTrytesToInt64(tx + 2331, 9) +
+				iotaTrytesToInt64(tx + 2340, 9);
+	}
+}
+
+static void fieldsRef(unsigned int) {
+	for (unsigned int i = 0; i + TX_TRYTES <= BUF_TRYTES; i += TX_TRYTES) {
+		const char *tx = trytes + i;
+
+		sink += refToInt64(tx + 2268, 27) + refToInt64(tx + 2322, 9) +
+				refToInt64(tx + 2331, 9) + refToInt64(tx + 2340, 9);
+	}
+}
+
+/* Returns the throughput in MB of tryte characters per second. */
+static double run(benchFunc func, unsigned int unit) {
+	unsigned int rounds = 0;
+	double start = now();
+	double elapsed;
+
+	do {
+		func(unit);
+		rounds++;
+		elapsed = now() - start;
+	} while (elapsed < MIN_SECONDS);
+	return (double) rounds * (BUF_TRYTES - BUF_TRYTES % unit) / elapsed / 1e6;
+}
+
+static void report(const char *name, benchFunc fast, benchFunc ref,
+		unsigned int unit) {
+	double fastRate = run(fast, unit);
+
+	if (ref) {
+		double refRate = run(ref, unit);
+
+		printf("%-24s %-12s %10.1f MB/s %10.1f MB/s %7.2fx\n", name,
+				(unit == TX_TRYTES) ? "transaction" : "hash", fastRate,
+				refRate, fastRate / refRate);
+	}
+	else {
+		printf("%-24s %-12s %10.1f MB/s %15s\n", name,
+				(unit == TX_TRYTES) ? "transaction" : "hash", fastRate, "-");
+	}
+}
+
+int main() {
+	static const char alphabet[] = "9ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+	static const unsigned int units[] = {TX_TRYTES, HASH_TRYTES};
+
+	srand(1);
+	for (unsigned int i = 0; i < BUF_TRYTES; i++) {
+		trytes[i] = alphabet[rand() % 27];
+	}
+#if defined(__SSE2__)
+	printf("SIMD: SSE2\n");
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	printf("SIMD: NEON\n");
+#else
+	printf("SIMD: none (scalar fallback)\n");
+#endif
+	printf("%-24s %-12s %15s %15s %8s\n", "kernel", "unit", "library",
+			"reference", "speedup");
+	for (unsigned int i = 0; i < sizeof(units) / sizeof(units[0]); i++) {
+		report("validate", validateFast, validateRef, units[i]);
+		report("trytes to values", valuesFast, valuesRef, units[i]);
+		report("trytes to trits", tritsFast, NULL, units[i]);
+		report("trits to trytes", tritsBackFast, NULL, units[i]);
+	}
+	report("numeric fields", fieldsFast, fieldsRef, TX_TRYTES);
+	return 0;
+}
@@ -0,0 +1,961 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Wallet and client benchmark suite
+ *
+ * Measures the hot paths of the library on a host: address generation, bundle
+ * creation and signing, transaction decoding, JSON serialization and parsing
+ * of IRI commands, and end-to-end wallet operations against the IRI stand-in
+ * in extras/host with a simulated round-trip time. Results are written in
+ * JSON format to the standard output (or to a file), and a summary is printed
+ * on the standard error. Build and run on a host with:
+ *   make wallet_bench && ./wallet_bench --node 127.0.0.1:14265 --rtt 0,50
+ * End-to-end benchmarks are skipped if the stand-in cannot be reached.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/utsname.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <IotaBundle.h>
+#include <IotaClient.h>
+#include <IotaPackedTx.h>
+#include <IotaTrytes.h>
+#include <IotaTxStore.h>
+#include <IotaWallet.h>
+
+#include "PosixClient.h"
+
+extern "C" {
+#include "iota-c-library/src/iota/addresses.h"
+#include "iota-c-library/src/iota/conversion.h"
+#include "iota-c-library/src/iota/signing.h"
+}
+
+#ifndef LIBRARY_NAME
+#define LIBRARY_NAME	"IotaClient"
+#endif
+#ifndef LIBRARY_VERSION
+#define LIBRARY_VERSION	"unknown"
+#endif
+
+#define BENCH_ITERATIONS	10
+#define BENCH_TX_BATCH		256		/* decoded transactions per iteration */
+#define BENCH_JSON_BATCH	64		/* JSON documents per iteration */
+#define BENCH_JSON_HASHES	16		/* addresses per address command */
+#define BENCH_JSON_TXS		4		/* transactions per transaction command */
+#define BENCH_JSON_DOC_SIZE	32768
+#define BENCH_MAX_SIGN_INPUTS	8
+#define BENCH_E2E_SECURITY	2
+#define BENCH_E2E_INPUTS	2		/* funded addresses */
+#define BENCH_E2E_BALANCE	1000	/* balance of each funded address */
+#define BENCH_E2E_VALUE		1500	/* transfer value (uses all inputs) */
+#define BENCH_E2E_RECIPIENT_IDX	100	/* seed address used as recipient */
+
+struct benchParam {
+	const char *key;
+	long value;
+};
+
+struct benchResult {
+	String name;
+	std::vector<struct benchParam> params;
+	unsigned int opsPerIteration;
+	unsigned int failures;
+	std::vector<double> wall;	/* microseconds per operation */
+	std::vector<double> cpu;	/* microseconds per operation */
+	double bytesPerOp;			/* 0 if not applicable */
+	double roundTrips;			/* node requests per operation, or -1 */
+};
+
+static const char *filter;
+static unsigned int iterations = BENCH_ITERATIONS;
+static String nodeHost = "127.0.0.1";
+static int nodePort = 14265;
+static std::vector<unsigned int> rtts(1, 0);
+
+static std::vector<struct benchResult> results;
+static char seed[NUM_HASH_TRYTES + 1];
+static unsigned char seedBytes[NUM_HASH_BYTES];
+static volatile int64_t sink;
+
+static double wallTime() {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* CPU time of this process, i.e. of the client side of network operations. */
+static double cpuTime() {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void randomTrytes(char *trytes, unsigned int len) {
+	static const char alphabet[] = "9ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+	for (unsigned int i = 0; i < len; i++) {
+		trytes[i] = alphabet[rand() % 27];
+	}
+}
+
+static String randomHash() {
+	char hash[NUM_HASH_TRYTES + 1];
+
+	randomTrytes(hash, NUM_HASH_TRYTES);
+	hash[NUM_HASH_TRYTES] = '\0';
+	return String(hash);
+}
+
+/* Returns a transaction with random hashes and signature, and valid numeric
+ * fields. */
+static String randomTx(int64_t value, unsigned int currentIndex,
+		unsigned int lastIndex) {
+	char tx[NUM_TRANSACTION_TRYTES + 1];
+
+	randomTrytes(tx, NUM_TRANSACTION_TRYTES);
+	iotaInt64ToTrytes(value, tx + 2268, 27);
+	iotaInt64ToTrytes(time(NULL), tx + 2322, 9);
+	iotaInt64ToTrytes(currentIndex, tx + 2331, 9);
+	iotaInt64ToTrytes(lastIndex, tx + 2340, 9);
+	iotaInt64ToTrytes(time(NULL) * 1000, tx + 2619, 9);
+	iotaInt64ToTrytes(0, tx + 2628, 9);
+	iotaInt64ToTrytes(3812798742493LL, tx + 2637, 9);
+	tx[NUM_TRANSACTION_TRYTES] = '\0';
+	return String(tx);
+}
+
+static String seedAddress(unsigned int index, unsigned int security,
+		bool withChecksum) {
+	unsigned char addrBytes[NUM_HASH_BYTES];
+	char addr[NUM_HASH_TRYTES + NUM_ADDR_CKSUM_TRYTES + 1];
+
+	get_public_addr(seedBytes, index, security, addrBytes);
+	if (withChecksum) {
+		get_address_with_checksum(addrBytes, addr);
+		addr[NUM_HASH_TRYTES + NUM_ADDR_CKSUM_TRYTES] = '\0';
+	}
+	else {
+		bytes_to_chars(addrBytes, addr, NUM_HASH_BYTES);
+		addr[NUM_HASH_TRYTES] = '\0';
+	}
+	return String(addr);
+}
+
+static void noop() {
+}
+
+/* Runs a benchmark: after an untimed warm-up run, each of the configured
+ * iterations calls setup() (not timed), then func(), which executes "ops"
+ * operations and returns false if any of them failed, then teardown() (not
+ * timed). If any run fails, including the warm-up run, no timings are kept
+ * for the benchmark, so that failing operations can't report numbers.
+ * Returns the result entry, which is valid until the next benchmark is run,
+ * or NULL if the benchmark is excluded by the name filter. */
+template<typename Setup, typename Func, typename Teardown>
+static struct benchResult *measure(const String &name,
+		const std::vector<struct benchParam> &params, unsigned int ops,
+		Setup setup, Func func, Teardown teardown) {
+	if (filter && !strstr(name.c_str(), filter)) {
+		return NULL;
+	}
+	results.push_back(benchResult());
+	struct benchResult &res = results.back();
+
+	res.name = name;
+	res.params = params;
+	res.opsPerIteration = ops;
+	res.failures = 0;
+	res.bytesPerOp = 0;
+	res.roundTrips = -1;
+	setup();
+	if (!func()) {
+		res.failures++;
+	}
+	for (unsigned int i = 0; i < iterations; i++) {
+		setup();
+		double startWall = wallTime();
+		double startCpu = cpuTime();
+		bool ok = func();
+		double wall = wallTime() - startWall;
+		double cpu = cpuTime() - startCpu;
+
+		teardown();
+		if (!ok) {
+			res.failures++;
+			continue;
+		}
+		res.wall.push_back(wall / ops);
+		res.cpu.push_back(cpu / ops);
+	}
+	if (res.failures) {
+		fprintf(stderr, "%s: %u failed run(s)\n", name.c_str(),
+				res.failures);
+		res.wall.clear();
+		res.cpu.clear();
+	}
+	return &res;
+}
+
+template<typename Func>
+static struct benchResult *measure(const String &name,
+		const std::vector<struct benchParam> &params, unsigned int ops,
+		Func func) {
+	return measure(name, params, ops, noop, func, noop);
+}
+
+static void benchAddresses(IotaClient &offlineClient) {
+	for (unsigned int security = 1; security <= 3; security++) {
+		IotaWallet wallet(offlineClient);
+		unsigned int index = 0;
+
+		wallet.begin(seed);
+		wallet.setSecurityLevel(security);
+		measure("address.generate", {{"security", (long)security}}, 1,
+				[&]() {
+			char addr[NUM_HASH_TRYTES + NUM_ADDR_CKSUM_TRYTES + 1];
+
+			wallet.getAddressInto(index++, addr, false);
+			sink += addr[0];
+			return true;
+		});
+	}
+}
+
+/* Bundles have one output and a change transaction, and as many inputs as fit
+ * in a bundle at each security level. */
+static void benchBundles() {
+	iota_wallet_tx_input_t inputTxs[MAX_BUNDLE_INDEX_SZ];
+	iota_wallet_tx_output_t outTx;
+	iota_wallet_tx_output_t changeTx;
+	iota_wallet_bundle_description_t descr;
+
+	memset(&outTx, 0, sizeof(outTx));
+	memset(&changeTx, 0, sizeof(changeTx));
+	memcpy(outTx.address, randomHash().c_str(), sizeof(outTx.address));
+	memset(outTx.tag, '9', sizeof(outTx.tag));
+	memcpy(changeTx.address, randomHash().c_str(), sizeof(changeTx.address));
+	memset(changeTx.tag, '9', sizeof(changeTx.tag));
+	for (unsigned int security = 1; security <= 3; security++) {
+		unsigned int maxInputs = (MAX_BUNDLE_INDEX_SZ - 2) / security;
+
+		for (unsigned int numInputs = 1; numInputs <= maxInputs;
+				numInputs++) {
+			memset(&descr, 0, sizeof(descr));
+			descr.output_txs = &outTx;
+			descr.output_txs_length = 1;
+			descr.input_txs = inputTxs;
+			descr.input_txs_length = numInputs;
+			descr.change_tx = &changeTx;
+			descr.security = security;
+			bytes_to_chars(seedBytes, descr.seed, NUM_HASH_BYTES);
+			for (unsigned int i = 0; i < numInputs; i++) {
+				memcpy(inputTxs[i].address,
+						seedAddress(i, security, false).c_str(),
+						sizeof(inputTxs[i].address));
+				inputTxs[i].key_index = i;
+				inputTxs[i].value = BENCH_E2E_BALANCE;
+			}
+			outTx.value = numInputs * BENCH_E2E_BALANCE - 1;
+			changeTx.value = 1;
+			measure("bundle.create", {{"security", (long)security},
+					{"inputs", (long)numInputs}}, 1, [&]() {
+				IotaBundle bundle(seedBytes, security);
+
+				descr.timestamp = time(NULL);
+				return bundle.create(&descr);
+			});
+			measure("bundle.sign", {{"security", (long)security},
+					{"inputs", (long)numInputs}}, 1, [&]() {
+				IotaBundle bundle(seedBytes, security);
+				std::vector<String> txs;
+
+				descr.timestamp = time(NULL);
+				if (!bundle.create(&descr)) {
+					return false;
+				}
+				bundle.signInputs(1);
+				bundle.getTransactions(txs);
+				sink += txs.size();
+				return true;
+			});
+		}
+	}
+}
+
+/* Signing with the raw signing API, for input counts that don't fit in a
+ * single bundle at the default security level. */
+static void benchSigning() {
+	tryte_t normalizedHash[NUM_HASH_TRYTES];
+	unsigned char sigBytes[SIGNATURE_FRAGMENT_SZ * NUM_HASH_BYTES];
+
+	memset(normalizedHash, 0, sizeof(normalizedHash));
+	for (unsigned int numInputs = 1; numInputs <= BENCH_MAX_SIGN_INPUTS;
+			numInputs++) {
+		measure("signing.inputs", {{"security", BENCH_E2E_SECURITY},
+				{"inputs", (long)numInputs}}, 1, [&]() {
+			for (unsigned int i = 0; i < numInputs; i++) {
+				SIGNING_CTX ctx;
+
+				signing_initialize(&ctx, seedBytes, i, BENCH_E2E_SECURITY,
+						normalizedHash);
+				while (signing_has_next_fragment(&ctx)) {
+					signing_next_fragment(&ctx, sigBytes);
+				}
+			}
+			sink += sigBytes[0];
+			return true;
+		});
+	}
+}
+
+static void benchDecoding(IotaClient &offlineClient) {
+	IotaTxStore store(1);
+	String hash = randomHash();
+	String trytes = randomTx(BENCH_E2E_BALANCE, 0, 0);
+	IotaPackedTx packedTx;
+	struct benchResult *res;
+
+	store.add(hash, trytes);
+	offlineClient.setTxStore(store);
+	/* Decoding of transactions served by a transaction store: packed data
+	 * is unpacked to trytes, which are then parsed into an IotaTx. Decoding
+	 * of node responses is covered by the JSON benchmarks. */
+	res = measure("tx.decode_stored", {}, BENCH_TX_BATCH, [&]() {
+		struct IotaTx tx;
+
+		for (unsigned int i = 0; i < BENCH_TX_BATCH; i++) {
+			if (!offlineClient.getTransaction(hash, &tx)) {
+				return false;
+			}
+			sink += tx.value;
+		}
+		return true;
+	});
+	if (res) {
+		res->bytesPerOp = NUM_TRANSACTION_TRYTES;
+	}
+	packedTx.pack(trytes);
+	res = measure("tx.unpack", {}, BENCH_TX_BATCH, [&]() {
+		struct IotaTx tx;
+
+		for (unsigned int i = 0; i < BENCH_TX_BATCH; i++) {
+			if (!packedTx.unpack(tx)) {
+				return false;
+			}
+			sink += tx.value;
+		}
+		return true;
+	});
+	if (res) {
+		res->bytesPerOp = NUM_TRANSACTION_TRYTES;
+	}
+}
+
+enum jsonItem {
+	JSON_ITEM_NONE,
+	JSON_ITEM_HASH,
+	JSON_ITEM_TX,
+	JSON_ITEM_BOOL,
+	JSON_ITEM_BALANCE,
+};
+
+struct jsonCommand {
+	const char *command;
+	const char *reqKey;		/* request array, NULL if none */
+	enum jsonItem reqItem;
+	unsigned int reqCount;
+	const char *respKey;	/* response array, NULL if none */
+	enum jsonItem respItem;
+	unsigned int respCount;
+};
+
+static const struct jsonCommand jsonCommands[] = {
+	{"getNodeInfo", NULL, JSON_ITEM_NONE, 0, NULL, JSON_ITEM_NONE, 0},
+	{"getBalances", "addresses", JSON_ITEM_HASH, BENCH_JSON_HASHES,
+			"balances", JSON_ITEM_BALANCE, BENCH_JSON_HASHES},
+	{"wereAddressesSpentFrom", "addresses", JSON_ITEM_HASH,
+			BENCH_JSON_HASHES, "states", JSON_ITEM_BOOL, BENCH_JSON_HASHES},
+	{"findTransactions", "addresses", JSON_ITEM_HASH, BENCH_JSON_HASHES,
+			"hashes", JSON_ITEM_HASH, BENCH_JSON_HASHES},
+	{"getTrytes", "hashes", JSON_ITEM_HASH, BENCH_JSON_TXS, "trytes",
+			JSON_ITEM_TX, BENCH_JSON_TXS},
+	{"getInclusionStates", "transactions", JSON_ITEM_HASH, BENCH_JSON_TXS,
+			"states", JSON_ITEM_BOOL, BENCH_JSON_TXS},
+	{"getTransactionsToApprove", NULL, JSON_ITEM_NONE, 0, NULL,
+			JSON_ITEM_NONE, 0},
+	{"attachToTangle", "trytes", JSON_ITEM_TX, BENCH_JSON_TXS, "trytes",
+			JSON_ITEM_TX, BENCH_JSON_TXS},
+	{"storeTransactions", "trytes", JSON_ITEM_TX, BENCH_JSON_TXS, NULL,
+			JSON_ITEM_NONE, 0},
+	{"checkConsistency", "tails", JSON_ITEM_HASH, 1, "state", JSON_ITEM_NONE,
+			0},
+};
+
+/* Fills a request document as IotaClient does for the command. */
+static void buildRequest(JsonDocument &jsonDoc, const struct jsonCommand &cmd,
+		const std::vector<String> &hashes, const std::vector<String> &txs) {
+	jsonDoc.clear();
+	jsonDoc["command"] = cmd.command;
+	if (cmd.reqKey) {
+		JsonArray arr = jsonDoc.createNestedArray(cmd.reqKey);
+
+		for (unsigned int i = 0; i < cmd.reqCount; i++) {
+			arr.add((cmd.reqItem == JSON_ITEM_TX) ? txs[i] : hashes[i]);
+		}
+	}
+	if (!strcmp(cmd.command, "getBalances")) {
+		jsonDoc["threshold"] = 100;
+	}
+	else if (!strcmp(cmd.command, "getInclusionStates")) {
+		jsonDoc.createNestedArray("tips").add(hashes[0]);
+	}
+	else if (!strcmp(cmd.command, "getTransactionsToApprove")) {
+		jsonDoc["depth"] = IOTAWALLET_RANDOMWALK_DEPTH;
+	}
+	else if (!strcmp(cmd.command, "attachToTangle")) {
+		jsonDoc["trunkTransaction"] = hashes[0];
+		jsonDoc["branchTransaction"] = hashes[1];
+		jsonDoc["minWeightMagnitude"] = 14;
+	}
+}
+
+/* Returns the JSON text of a typical node response to the command. */
+static String buildResponse(const struct jsonCommand &cmd,
+		const std::vector<String> &hashes, const std::vector<String> &txs) {
+	String resp = "{";
+
+	if (!strcmp(cmd.command, "getNodeInfo")) {
+		resp += "\"appName\":\"IRI\",\"appVersion\":\"1.8.6\","
+				"\"jreAvailableProcessors\":8,\"jreFreeMemory\":1073741824,"
+				"\"jreVersion\":\"1.8.0_242\",\"jreMaxMemory\":8589934592,"
+				"\"jreTotalMemory\":4294967296,\"latestMilestone\":\"" +
+				hashes[0] + "\",\"latestMilestoneIndex\":1500000,"
+				"\"latestSolidSubtangleMilestone\":\"" + hashes[0] +
+				"\",\"latestSolidSubtangleMilestoneIndex\":1500000,"
+				"\"milestoneStartIndex\":1400000,"
+				"\"lastSnapshottedMilestoneIndex\":1450000,\"neighbors\":8,"
+				"\"packetsQueueSize\":0,\"time\":1580000000000,\"tips\":5000,"
+				"\"transactionsToRequest\":0,\"features\":[\"RemotePOW\"],"
+				"\"coordinatorAddress\":\"" + hashes[1] + "\",";
+	}
+	else if (!strcmp(cmd.command, "getTransactionsToApprove")) {
+		resp += "\"trunkTransaction\":\"" + hashes[0] +
+				"\",\"branchTransaction\":\"" + hashes[1] + "\",";
+	}
+	else if (!strcmp(cmd.command, "checkConsistency")) {
+		resp += "\"state\":true,\"info\":\"\",";
+	}
+	if (cmd.respKey && (cmd.respItem != JSON_ITEM_NONE)) {
+		resp += String("\"") + cmd.respKey + "\":[";
+		for (unsigned int i = 0; i < cmd.respCount; i++) {
+			if (i > 0) {
+				resp += ",";
+			}
+			switch (cmd.respItem) {
+			case JSON_ITEM_HASH:
+				resp += "\"" + hashes[i] + "\"";
+				break;
+			case JSON_ITEM_TX:
+				resp += "\"" + txs[i] + "\"";
+				break;
+			case JSON_ITEM_BOOL:
+				resp += ((i % 2) ? "true" : "false");
+				break;
+			default:
+				resp += "\"" + String(rand() % 100000) + "\"";
+				break;
+			}
+		}
+		resp += "],";
+		if (cmd.respItem == JSON_ITEM_BALANCE) {
+			resp += "\"references\":[\"" + hashes[0] +
+					"\"],\"milestoneIndex\":1500000,";
+		}
+	}
+	resp += "\"duration\":12}";
+	return resp;
+}
+
+/* Parses a response and extracts its values as IotaClient does. */
+static bool parseResponse(JsonDocument &jsonDoc,
+		const struct jsonCommand &cmd, const String &resp) {
+	if (deserializeJson(jsonDoc, resp.c_str(), resp.length())) {
+		return false;
+	}
+	JsonObject obj = jsonDoc.as<JsonObject>();
+
+	if (!cmd.respKey || (cmd.respItem == JSON_ITEM_NONE)) {
+		for (JsonPair kv : obj) {
+			JsonVariant value = kv.value();
+
+			if (value.is<const char *>()) {
+				String str = value.as<const char *>();
+
+				sink += str.length();
+			}
+			else {
+				sink += value.as<long long>();
+			}
+		}
+		return true;
+	}
+	JsonArray arr = obj[cmd.respKey];
+
+	if (arr.isNull()) {
+		return false;
+	}
+	for (JsonVariant value : arr) {
+		switch (cmd.respItem) {
+		case JSON_ITEM_BOOL:
+			sink += value.as<bool>();
+			break;
+		case JSON_ITEM_BALANCE:
+			sink += strtoull(value.as<const char *>(), NULL, 10);
+			break;
+		default: {
+			String str = value.as<const char *>();
+
+			sink += str.length();
+			break;
+		}
+		}
+	}
+	return true;
+}
+
+static void benchJson() {
+	DynamicJsonDocument jsonDoc(BENCH_JSON_DOC_SIZE);
+	std::vector<String> hashes;
+	std::vector<String> txs;
+	static char buf[BENCH_JSON_DOC_SIZE];
+	struct benchResult *res;
+
+	for (unsigned int i = 0; i < BENCH_JSON_HASHES; i++) {
+		hashes.push_back(randomHash());
+	}
+	for (unsigned int i = 0; i < BENCH_JSON_TXS; i++) {
+		txs.push_back(randomTx(0, i, BENCH_JSON_TXS - 1));
+	}
+	for (const struct jsonCommand &cmd : jsonCommands) {
+		String resp = buildResponse(cmd, hashes, txs);
+		size_t reqLen = 0;
+		std::vector<struct benchParam> params;
+
+		if (cmd.reqKey) {
+			params.push_back({"hashes", (long)cmd.reqCount});
+		}
+		res = measure(String("json.serialize.") + cmd.command, params,
+				BENCH_JSON_BATCH, [&]() {
+			for (unsigned int i = 0; i < BENCH_JSON_BATCH; i++) {
+				buildRequest(jsonDoc, cmd, hashes, txs);
+				reqLen = serializeJson(jsonDoc, buf, sizeof(buf));
+				if (reqLen == 0) {
+					return false;
+				}
+			}
+			return true;
+		});
+		if (res) {
+			res->bytesPerOp = reqLen;
+		}
+		res = measure(String("json.parse.") + cmd.command, params,
+				BENCH_JSON_BATCH, [&]() {
+			for (unsigned int i = 0; i < BENCH_JSON_BATCH; i++) {
+				if (!parseResponse(jsonDoc, cmd, resp)) {
+					return false;
+				}
+			}
+			return true;
+		});
+		if (res) {
+			res->bytesPerOp = resp.length();
+		}
+	}
+}
+
+/* Sends a command to the node on a dedicated connection; used for the
+ * stand-in control commands, which are not part of the measurements. */
+static bool nodeCommand(const String &body, String *resp = NULL) {
+	PosixClient networkClient;
+	HttpClient httpClient(networkClient, nodeHost.c_str(), nodePort);
+	int status;
+
+	if (httpClient.post("/", "application/json", body) != 0) {
+		return false;
+	}
+	status = httpClient.responseStatusCode();
+	if (resp) {
+		*resp = httpClient.responseBody();
+	}
+	httpClient.stop();
+	return (status == 200);
+}
+
+/* Returns the number of IRI API requests served by the stand-in since the
+ * last reset, or -1 on error. */
+static long nodeRequests() {
+	DynamicJsonDocument jsonDoc(2048);
+	String resp;
+	long count = 0;
+
+	if (!nodeCommand("{\"command\":\"standin.stats\"}", &resp) ||
+			deserializeJson(jsonDoc, resp.c_str(), resp.length())) {
+		return -1;
+	}
+	for (JsonPair kv : jsonDoc["requests"].as<JsonObject>()) {
+		if (strncmp(kv.key().c_str(), "standin.", 8)) {
+			count += kv.value().as<long>();
+		}
+	}
+	return count;
+}
+
+static const char *const endToEndBenchmarks[] = {
+	"wallet.getAddrsWithBalance",
+	"wallet.getReceiveAddress",
+	"wallet.sendTransfer",
+};
+
+/* Resets the stand-in and funds the first addresses of the seed. */
+static void fundWallet() {
+	String body = "{\"command\":\"standin.setBalances\",\"balances\":{";
+
+	for (unsigned int i = 0; i < BENCH_E2E_INPUTS; i++) {
+		if (i > 0) {
+			body += ",";
+		}
+		body += "\"" + seedAddress(i, BENCH_E2E_SECURITY, false) + "\":" +
+				String(BENCH_E2E_BALANCE);
+	}
+	body += "}}";
+	if (!nodeCommand("{\"command\":\"standin.reset\"}") ||
+			!nodeCommand(body)) {
+		fprintf(stderr, "Couldn't set up node state\n");
+	}
+}
+
+static void benchEndToEnd(IotaClient &iotaClient, unsigned int rtt) {
+	String recipient = seedAddress(BENCH_E2E_RECIPIENT_IDX, BENCH_E2E_SECURITY,
+			true);
+	long totalRequests;
+	struct benchResult *res;
+	auto countRequests = [&]() {
+		long count = nodeRequests();
+
+		if ((count < 0) || (totalRequests < 0)) {
+			totalRequests = -1;
+		}
+		else {
+			totalRequests += count;
+		}
+	};
+	auto setRoundTrips = [&]() {
+		if (res && (totalRequests >= 0) && (res->wall.size() > 0)) {
+			res->roundTrips = (double)totalRequests / iterations;
+		}
+	};
+
+	if (!nodeCommand("{\"command\":\"standin.configure\",\"latency\":" +
+			String(rtt) + ",\"jitter\":0,\"failRate\":0}")) {
+		fprintf(stderr, "Couldn't configure node\n");
+		return;
+	}
+
+	totalRequests = 0;
+	res = measure(endToEndBenchmarks[0], {{"rtt_ms", (long)rtt},
+			{"security", BENCH_E2E_SECURITY}, {"inputs", BENCH_E2E_INPUTS}},
+			1, fundWallet, [&]() {
+		IotaWallet wallet(iotaClient);
+		std::vector<struct iotaAddrWithBalance> addrs;
+		uint64_t balance;
+
+		wallet.begin(seed);
+		wallet.setSecurityLevel(BENCH_E2E_SECURITY);
+		return (wallet.getAddrsWithBalance(&addrs, 0, &balance) &&
+				(balance == BENCH_E2E_INPUTS * BENCH_E2E_BALANCE));
+	}, countRequests);
+	setRoundTrips();
+
+	totalRequests = 0;
+	res = measure(endToEndBenchmarks[1], {{"rtt_ms", (long)rtt},
+			{"security", BENCH_E2E_SECURITY}, {"inputs", BENCH_E2E_INPUTS}},
+			1, fundWallet, [&]() {
+		IotaWallet wallet(iotaClient);
+		String addr;
+
+		wallet.begin(seed);
+		wallet.setSecurityLevel(BENCH_E2E_SECURITY);
+		return wallet.getReceiveAddress(addr);
+	}, countRequests);
+	setRoundTrips();
+
+	totalRequests = 0;
+	res = measure(endToEndBenchmarks[2], {{"rtt_ms", (long)rtt},
+			{"security", BENCH_E2E_SECURITY}, {"inputs", BENCH_E2E_INPUTS}},
+			1, fundWallet, [&]() {
+		IotaWallet wallet(iotaClient);
+		int ret;
+
+		wallet.begin(seed);
+		wallet.setSecurityLevel(BENCH_E2E_SECURITY);
+		ret = wallet.sendTransfer(BENCH_E2E_VALUE, recipient);
+		if (ret != IOTA_OK) {
+			fprintf(stderr, "sendTransfer failed (%d)\n", ret);
+		}
+		return (ret == IOTA_OK);
+	}, countRequests);
+	setRoundTrips();
+}
+
+static bool endToEndSelected() {
+	if (!filter) {
+		return true;
+	}
+	for (const char *name : endToEndBenchmarks) {
+		if (strstr(name, filter)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static double mean(const std::vector<double> &samples) {
+	double sum = 0;
+
+	for (double s : samples) {
+		sum += s;
+	}
+	return sum / samples.size();
+}
+
+static void writeStats(FILE *f, const char *key,
+		const std::vector<double> &samples) {
+	std::vector<double> sorted(samples);
+	double avg = mean(samples);
+	double var = 0;
+
+	std::sort(sorted.begin(), sorted.end());
+	for (double s : samples) {
+		var += (s - avg) * (s - avg);
+	}
+	fprintf(f, "\"%s\": {\"mean\": %.3f, \"median\": %.3f, \"min\": %.3f, "
+			"\"max\": %.3f, \"stddev\": %.3f}", key, avg,
+			sorted[sorted.size() / 2], sorted.front(), sorted.back(),
+			sqrt(var / samples.size()));
+}
+
+static void writeResults(FILE *f, bool nodeReachable) {
+	struct utsname uts;
+
+	uname(&uts);
+	fprintf(f, "{\n  \"library\": \"%s\",\n  \"version\": \"%s\",\n",
+			LIBRARY_NAME, LIBRARY_VERSION);
+	fprintf(f, "  \"host\": {\"system\": \"%s\", \"release\": \"%s\", "
+			"\"machine\": \"%s\"},\n", uts.sysname, uts.release, uts.machine);
+	fprintf(f, "  \"node\": {\"address\": \"%s:%d\", \"reachable\": %s},\n",
+			nodeHost.c_str(), nodePort, nodeReachable ? "true" : "false");
+	fprintf(f, "  \"timestamp\": %ld,\n  \"iterations\": %u,\n",
+			(long)time(NULL), iterations);
+	fprintf(f, "  \"results\": [");
+	for (unsigned int i = 0; i < results.size(); i++) {
+		const struct benchResult &res = results[i];
+
+		fprintf(f, "%s\n    {\"name\": \"%s\", \"params\": {",
+				(i > 0) ? "," : "", res.name.c_str());
+		for (unsigned int j = 0; j < res.params.size(); j++) {
+			fprintf(f, "%s\"%s\": %ld", (j > 0) ? ", " : "",
+					res.params[j].key, res.params[j].value);
+		}
+		fprintf(f, "}, \"ops_per_iteration\": %u, \"samples\": %u, "
+				"\"failures\": %u", res.opsPerIteration,
+				(unsigned)res.wall.size(), res.failures);
+		if (res.wall.size() > 0) {
+			double wallMean = mean(res.wall);
+
+			fprintf(f, ",\n     ");
+			writeStats(f, "wall_us", res.wall);
+			fprintf(f, ",\n     ");
+			writeStats(f, "cpu_us", res.cpu);
+			fprintf(f, ",\n     \"ops_per_s\": %.3f", 1e6 / wallMean);
+			if (res.bytesPerOp > 0) {
+				fprintf(f, ", \"bytes_per_op\": %.0f, \"mb_per_s\": %.3f",
+						res.bytesPerOp, res.bytesPerOp / wallMean);
+			}
+			if (res.roundTrips >= 0) {
+				fprintf(f, ", \"round_trips\": %.2f", res.roundTrips);
+			}
+		}
+		fprintf(f, "}");
+	}
+	fprintf(f, "\n  ]\n}\n");
+}
+
+static void printSummary() {
+	fprintf(stderr, "%-36s %-32s %12s %12s\n", "benchmark", "params",
+			"wall (us)", "cpu (us)");
+	for (const struct benchResult &res : results) {
+		String params;
+
+		for (const struct benchParam &param : res.params) {
+			if (params.length() > 0) {
+				params += ",";
+			}
+			params += String(param.key) + "=" + String(param.value);
+		}
+		if (res.wall.size() > 0) {
+			fprintf(stderr, "%-36s %-32s %12.1f %12.1f\n", res.name.c_str(),
+					params.c_str(), mean(res.wall), mean(res.cpu));
+		}
+		else {
+			fprintf(stderr, "%-36s %-32s %12s %12s\n", res.name.c_str(),
+					params.c_str(), "failed", "-");
+		}
+	}
+}
+
+static void usage(const char *prog) {
+	fprintf(stderr, "Usage: %s [options]\n"
+			"  --node host:port   IRI stand-in address (default "
+			"127.0.0.1:14265)\n"
+			"  --rtt ms[,ms...]   simulated round-trip times (default 0)\n"
+			"  --iterations n     timed iterations per benchmark (default "
+			"%u)\n"
+			"  --filter str       run only benchmarks whose name contains "
+			"str\n"
+			"  --output file      write JSON results to file instead of the "
+			"standard output\n", prog, BENCH_ITERATIONS);
+}
+
+int main(int argc, char **argv) {
+	const char *output = NULL;
+	bool nodeReachable = false;
+
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+
+		if ((i + 1 >= argc) || strncmp(arg, "--", 2)) {
+			usage(argv[0]);
+			return 1;
+		}
+		const char *val = argv[++i];
+
+		if (!strcmp(arg, "--node")) {
+			const char *colon = strrchr(val, ':');
+
+			nodeHost = String(val).substring(0, colon ? colon - val :
+					strlen(val));
+			if (colon) {
+				nodePort = atoi(colon + 1);
+			}
+		}
+		else if (!strcmp(arg, "--rtt")) {
+			rtts.clear();
+			for (const char *p = val; p; p = strchr(p, ',')) {
+				if (*p == ',') {
+					p++;
+				}
+				rtts.push_back(strtoul(p, NULL, 10));
+			}
+		}
+		else if (!strcmp(arg, "--iterations") && (atoi(val) > 0)) {
+			iterations = atoi(val);
+		}
+		else if (!strcmp(arg, "--filter")) {
+			filter = val;
+		}
+		else if (!strcmp(arg, "--output")) {
+			output = val;
+		}
+		else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	srand(1);
+	randomTrytes(seed, NUM_HASH_TRYTES);
+	seed[NUM_HASH_TRYTES] = '\0';
+	chars_to_bytes(seed, seedBytes, NUM_HASH_TRYTES);
+
+	/* Offline benchmarks don't send requests: the client points to a port
+	 * where no node is expected to listen. */
+	PosixClient offlineNetworkClient;
+	IotaClient offlineClient(offlineNetworkClient, "127.0.0.1", 1);
+
+	benchAddresses(offlineClient);
+	benchBundles();
+	benchSigning();
+	benchDecoding(offlineClient);
+	benchJson();
+
+	PosixClient networkClient;
+	IotaClient iotaClient(networkClient, nodeHost.c_str(), nodePort);
+	struct iotaNodeInfo nodeInfo;
+
+	if (endToEndSelected()) {
+		if (iotaClient.getNodeInfo(&nodeInfo) &&
+				nodeCommand("{\"command\":\"standin.stats\"}")) {
+			nodeReachable = true;
+			for (unsigned int rtt : rtts) {
+				benchEndToEnd(iotaClient, rtt);
+			}
+		}
+		else {
+			fprintf(stderr, "IRI stand-in not reachable at %s:%d, skipping "
+					"end-to-end benchmarks\n", nodeHost.c_str(), nodePort);
+		}
+	}
+
+	printSummary();
+	if (output) {
+		FILE *f = fopen(output, "w");
+
+		if (!f) {
+			perror(output);
+			return 1;
+		}
+		writeResults(f, nodeReachable);
+		fclose(f);
+	}
+	else {
+		writeResults(stdout, nodeReachable);
+	}
+	for (const struct benchResult &res : results) {
+		if (res.failures) {
+			return 1;
+		}
+	}
+	return 0;
+}
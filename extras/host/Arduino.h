@@ -0,0 +1,383 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Arduino API shim for host (Linux) builds of the IOTA wallet library
+ *
+ * Only the subset of the Arduino core used by the library, ArduinoJson and
+ * ArduinoHttpClient is provided.
+ */
+
+#ifndef _ARDUINO_HOST_H_
+#define _ARDUINO_HOST_H_
+
+#include <ctype.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define DEC	10
+#define HEX	16
+#define OCT	8
+#define BIN	2
+
+#define F(string_literal)	\
+	(reinterpret_cast<const __FlashStringHelper *>(string_literal))
+
+class __FlashStringHelper;
+
+unsigned long millis();
+unsigned long micros();
+
+/** Wait for a given time
+      On the host, the wait ends early when data is received on a PosixClient
+      connection: HTTP clients that poll for response data with delay() then
+      see the response as soon as it arrives, as if polling had no granularity.
+      @param ms  Time to wait, in milliseconds
+      @return none
+*/
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+class String : public std::string {
+public:
+	String() {}
+	String(const char *cstr) : std::string(cstr ? cstr : "") {}
+	String(const char *cstr, unsigned int length) :
+		std::string(cstr, length) {}
+	String(const std::string &str) : std::string(str) {}
+	String(std::string &&str) : std::string(std::move(str)) {}
+	String(const __FlashStringHelper *str) :
+		std::string(reinterpret_cast<const char *>(str)) {}
+	explicit String(char c) : std::string(1, c) {}
+	explicit String(unsigned char value, unsigned char base = 10);
+	String(int value, unsigned char base = 10);
+	String(unsigned int value, unsigned char base = 10);
+	String(long value, unsigned char base = 10);
+	String(unsigned long value, unsigned char base = 10);
+	String(long long value, unsigned char base = 10);
+	String(unsigned long long value, unsigned char base = 10);
+	explicit String(float value, unsigned char decimals = 2);
+	explicit String(double value, unsigned char decimals = 2);
+
+	unsigned int length() const {
+		return size();
+	}
+	unsigned char reserve(unsigned int size) {
+		std::string::reserve(size);
+		return 1;
+	}
+	unsigned char concat(const String &str) {
+		append(str);
+		return 1;
+	}
+	unsigned char concat(const char *cstr) {
+		if (!cstr) {
+			return 0;
+		}
+		append(cstr);
+		return 1;
+	}
+	unsigned char concat(const char *cstr, unsigned int length) {
+		if (!cstr) {
+			return 0;
+		}
+		append(cstr, length);
+		return 1;
+	}
+	unsigned char concat(char c) {
+		push_back(c);
+		return 1;
+	}
+	template<typename T> unsigned char concat(T value) {
+		return concat(String(value));
+	}
+	String &operator+=(const String &str) {
+		append(str);
+		return *this;
+	}
+	String &operator+=(const char *cstr) {
+		concat(cstr);
+		return *this;
+	}
+	String &operator+=(char c) {
+		push_back(c);
+		return *this;
+	}
+	template<typename T> String &operator+=(T value) {
+		append(String(value));
+		return *this;
+	}
+	unsigned char equals(const String &str) const {
+		return (compare(str) == 0);
+	}
+	unsigned char equals(const char *cstr) const {
+		return (compare(cstr ? cstr : "") == 0);
+	}
+	unsigned char equalsIgnoreCase(const String &str) const;
+	int compareTo(const String &str) const {
+		return compare(str);
+	}
+	unsigned char startsWith(const String &prefix) const {
+		return (compare(0, prefix.size(), prefix) == 0);
+	}
+	unsigned char startsWith(const String &prefix, unsigned int offset) const {
+		return ((offset <= size()) &&
+				(compare(offset, prefix.size(), prefix) == 0));
+	}
+	unsigned char endsWith(const String &suffix) const {
+		return ((suffix.size() <= size()) &&
+				(compare(size() - suffix.size(), suffix.size(), suffix) == 0));
+	}
+	char charAt(unsigned int index) const {
+		return ((index < size()) ? (*this)[index] : 0);
+	}
+	void setCharAt(unsigned int index, char c) {
+		if (index < size()) {
+			(*this)[index] = c;
+		}
+	}
+	void getBytes(unsigned char *buf, unsigned int bufsize,
+			unsigned int index = 0) const;
+	void toCharArray(char *buf, unsigned int bufsize,
+			unsigned int index = 0) const {
+		getBytes((unsigned char *) buf, bufsize, index);
+	}
+	int indexOf(char c, unsigned int fromIndex = 0) const {
+		size_type pos = find(c, fromIndex);
+
+		return ((pos == npos) ? -1 : (int) pos);
+	}
+	int indexOf(const String &str, unsigned int fromIndex = 0) const {
+		size_type pos = find(str, fromIndex);
+
+		return ((pos == npos) ? -1 : (int) pos);
+	}
+	int lastIndexOf(char c) const {
+		size_type pos = rfind(c);
+
+		return ((pos == npos) ? -1 : (int) pos);
+	}
+	int lastIndexOf(const String &str) const {
+		size_type pos = rfind(str);
+
+		return ((pos == npos) ? -1 : (int) pos);
+	}
+	String substring(unsigned int beginIndex) const {
+		return ((beginIndex < size()) ? String(substr(beginIndex)) : String());
+	}
+	String substring(unsigned int beginIndex, unsigned int endIndex) const;
+	void replace(char find, char replace);
+	void replace(const String &find, const String &replace);
+	void remove(unsigned int index) {
+		if (index < size()) {
+			erase(index);
+		}
+	}
+	void remove(unsigned int index, unsigned int count) {
+		if (index < size()) {
+			erase(index, count);
+		}
+	}
+	void toLowerCase();
+	void toUpperCase();
+	void trim();
+	long toInt() const {
+		return atol(c_str());
+	}
+	float toFloat() const {
+		return atof(c_str());
+	}
+	double toDouble() const {
+		return atof(c_str());
+	}
+};
+
+class Print {
+public:
+	virtual ~Print() {}
+	virtual size_t write(uint8_t c) = 0;
+	virtual size_t write(const uint8_t *buf, size_t size);
+	size_t write(const char *str) {
+		return (str ? write((const uint8_t *) str, strlen(str)) : 0);
+	}
+	size_t write(const char *buf, size_t size) {
+		return write((const uint8_t *) buf, size);
+	}
+	virtual void flush() {}
+
+	size_t print(const __FlashStringHelper *str) {
+		return write(reinterpret_cast<const char *>(str));
+	}
+	size_t print(const String &str) {
+		return write(str.c_str(), str.length());
+	}
+	size_t print(const char *str) {
+		return write(str);
+	}
+	size_t print(char c) {
+		return write((uint8_t) c);
+	}
+	size_t print(unsigned char value, int base = DEC) {
+		return print(String(value, base));
+	}
+	size_t print(int value, int base = DEC) {
+		return print(String(value, base));
+	}
+	size_t print(unsigned int value, int base = DEC) {
+		return print(String(value, base));
+	}
+	size_t print(long value, int base = DEC) {
+		return print(String(value, base));
+	}
+	size_t print(unsigned long value, int base = DEC) {
+		return print(String(value, base));
+	}
+	size_t print(double value, int decimals = 2) {
+		return print(String(value, decimals));
+	}
+	size_t println() {
+		return write("\r\n");
+	}
+	template<typename T> size_t println(T value) {
+		return print(value) + println();
+	}
+	template<typename T> size_t println(T value, int format) {
+		return print(value, format) + println();
+	}
+};
+
+class Stream : public Print {
+public:
+	Stream() : _timeout(1000) {}
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+
+	void setTimeout(unsigned long timeout) {
+		_timeout = timeout;
+	}
+	unsigned long getTimeout() {
+		return _timeout;
+	}
+	bool find(const char *target) {
+		return findUntil(target, NULL);
+	}
+	bool find(const char *target, size_t length);
+	bool find(char target) {
+		char str[2] = {target, '\0'};
+
+		return find(str);
+	}
+	bool findUntil(const char *target, const char *terminator);
+	long parseInt();
+	size_t readBytes(char *buffer, size_t length);
+	size_t readBytes(uint8_t *buffer, size_t length) {
+		return readBytes((char *) buffer, length);
+	}
+	size_t readBytesUntil(char terminator, char *buffer, size_t length);
+	String readString();
+	String readStringUntil(char terminator);
+
+protected:
+	int timedRead();
+	int timedPeek();
+
+	unsigned long _timeout;
+};
+
+class IPAddress {
+public:
+	IPAddress() {
+		_address.dword = 0;
+	}
+	IPAddress(uint8_t b0, uint8_t b1, uint8_t b2, uint8_t b3) {
+		_address.bytes[0] = b0;
+		_address.bytes[1] = b1;
+		_address.bytes[2] = b2;
+		_address.bytes[3] = b3;
+	}
+	IPAddress(uint32_t address) {
+		_address.dword = address;
+	}
+	operator uint32_t() const {
+		return _address.dword;
+	}
+	bool operator==(const IPAddress &addr) const {
+		return (_address.dword == addr._address.dword);
+	}
+	bool operator!=(const IPAddress &addr) const {
+		return (_address.dword != addr._address.dword);
+	}
+	uint8_t operator[](int index) const {
+		return _address.bytes[index];
+	}
+	uint8_t &operator[](int index) {
+		return _address.bytes[index];
+	}
+	bool fromString(const char *address);
+	String toString() const;
+
+private:
+	union {
+		uint8_t bytes[4];
+		uint32_t dword;
+	} _address;
+};
+
+class Client : public Stream {
+public:
+	virtual int connect(IPAddress ip, uint16_t port) = 0;
+	virtual int connect(const char *host, uint16_t port) = 0;
+	virtual size_t write(uint8_t c) = 0;
+	virtual size_t write(const uint8_t *buf, size_t size) = 0;
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int read(uint8_t *buf, size_t size) = 0;
+	virtual int peek() = 0;
+	virtual void flush() = 0;
+	virtual void stop() = 0;
+	virtual uint8_t connected() = 0;
+	virtual operator bool() = 0;
+
+	using Print::write;
+
+protected:
+	uint8_t *rawIPAddress(IPAddress &addr) {
+		return &addr[0];
+	}
+};
+
+#endif
@@ -0,0 +1,417 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+
+#include <vector>
+
+#include "Arduino.h"
+#include "PosixClient.h"
+
+static unsigned long long hostNow(clockid_t clock, unsigned long long div) {
+	struct timespec ts;
+
+	clock_gettime(clock, &ts);
+	return ((unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec) / div;
+}
+
+unsigned long millis() {
+	return hostNow(CLOCK_MONOTONIC, 1000000);
+}
+
+unsigned long micros() {
+	return hostNow(CLOCK_MONOTONIC, 1000);
+}
+
+void delay(unsigned long ms) {
+	struct timespec ts = {(time_t) (ms / 1000), (long) (ms % 1000) * 1000000};
+
+	while ((nanosleep(&ts, &ts) < 0) && (errno == EINTR)) {
+	}
+}
+
+void delayMicroseconds(unsigned int us) {
+	struct timespec ts = {(time_t) (us / 1000000), (long) (us % 1000000) * 1000};
+
+	nanosleep(&ts, NULL);
+}
+
+void yield() {
+}
+
+long random(long max) {
+	return ((max > 0) ? (::random() % max) : 0);
+}
+
+long random(long min, long max) {
+	return ((max > min) ? (min + random(max - min)) : min);
+}
+
+void randomSeed(unsigned long seed) {
+	if (seed != 0) {
+		srandom(seed);
+	}
+}
+
+static std::string hostUtoa(unsigned long long value, unsigned char base) {
+	char buf[8 * sizeof(value) + 1];
+	char *p = buf + sizeof(buf) - 1;
+
+	if ((base < 2) || (base > 36)) {
+		base = 10;
+	}
+	*p = '\0';
+	do {
+		unsigned int digit = value % base;
+
+		*--p = ((digit < 10) ? ('0' + digit) : ('a' + digit - 10));
+		value /= base;
+	} while (value != 0);
+	return std::string(p);
+}
+
+static std::string hostLtoa(long long value, unsigned char base) {
+	if ((value < 0) && (base == 10)) {
+		return "-" + hostUtoa(-(unsigned long long) value, base);
+	}
+	return hostUtoa((unsigned long long) value, base);
+}
+
+String::String(unsigned char value, unsigned char base) :
+	std::string(hostUtoa(value, base)) {
+}
+
+String::String(int value, unsigned char base) :
+	std::string(hostLtoa(value, base)) {
+}
+
+String::String(unsigned int value, unsigned char base) :
+	std::string(hostUtoa(value, base)) {
+}
+
+String::String(long value, unsigned char base) :
+	std::string(hostLtoa(value, base)) {
+}
+
+String::String(unsigned long value, unsigned char base) :
+	std::string(hostUtoa(value, base)) {
+}
+
+String::String(long long value, unsigned char base) :
+	std::string(hostLtoa(value, base)) {
+}
+
+String::String(unsigned long long value, unsigned char base) :
+	std::string(hostUtoa(value, base)) {
+}
+
+String::String(float value, unsigned char decimals) :
+	String((double) value, decimals) {
+}
+
+String::String(double value, unsigned char decimals) {
+	char buf[64];
+
+	snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+	assign(buf);
+}
+
+unsigned char String::equalsIgnoreCase(const String &str) const {
+	return ((size() == str.size()) && !strcasecmp(c_str(), str.c_str()));
+}
+
+void String::getBytes(unsigned char *buf, unsigned int bufsize,
+		unsigned int index) const {
+	unsigned int n;
+
+	if (!bufsize || !buf) {
+		return;
+	}
+	if (index >= size()) {
+		buf[0] = '\0';
+		return;
+	}
+	n = size() - index;
+	if (n > bufsize - 1) {
+		n = bufsize - 1;
+	}
+	memcpy(buf, c_str() + index, n);
+	buf[n] = '\0';
+}
+
+String String::substring(unsigned int beginIndex,
+		unsigned int endIndex) const {
+	if (beginIndex > endIndex) {
+		unsigned int tmp = beginIndex;
+
+		beginIndex = endIndex;
+		endIndex = tmp;
+	}
+	if (beginIndex >= size()) {
+		return String();
+	}
+	if (endIndex > size()) {
+		endIndex = size();
+	}
+	return String(substr(beginIndex, endIndex - beginIndex));
+}
+
+void String::replace(char find, char replace) {
+	for (size_type i = 0; i < size(); i++) {
+		if ((*this)[i] == find) {
+			(*this)[i] = replace;
+		}
+	}
+}
+
+void String::replace(const String &find, const String &replace) {
+	size_type pos = 0;
+
+	if (find.empty()) {
+		return;
+	}
+	while ((pos = this->find(find, pos)) != npos) {
+		std::string::replace(pos, find.size(), replace);
+		pos += replace.size();
+	}
+}
+
+void String::toLowerCase() {
+	for (size_type i = 0; i < size(); i++) {
+		(*this)[i] = tolower((unsigned char) (*this)[i]);
+	}
+}
+
+void String::toUpperCase() {
+	for (size_type i = 0; i < size(); i++) {
+		(*this)[i] = toupper((unsigned char) (*this)[i]);
+	}
+}
+
+void String::trim() {
+	size_type first = 0;
+	size_type last = size();
+
+	while ((first < last) && isspace((unsigned char) (*this)[first])) {
+		first++;
+	}
+	while ((last > first) && isspace((unsigned char) (*this)[last - 1])) {
+		last--;
+	}
+	assign(substr(first, last - first));
+}
+
+size_t Print::write(const uint8_t *buf, size_t size) {
+	size_t n = 0;
+
+	while ((n < size) && write(buf[n])) {
+		n++;
+	}
+	return n;
+}
+
+int Stream::timedRead() {
+	unsigned long start = millis();
+	unsigned long elapsed;
+	int c;
+
+	while ((c = read()) < 0) {
+		elapsed = millis() - start;
+		if (elapsed >= _timeout) {
+			break;
+		}
+		PosixClient::waitReadable(_timeout - elapsed);
+	}
+	return c;
+}
+
+int Stream::timedPeek() {
+	unsigned long start = millis();
+	unsigned long elapsed;
+	int c;
+
+	while ((c = peek()) < 0) {
+		elapsed = millis() - start;
+		if (elapsed >= _timeout) {
+			break;
+		}
+		PosixClient::waitReadable(_timeout - elapsed);
+	}
+	return c;
+}
+
+bool Stream::find(const char *target, size_t length) {
+	std::string str(target, length);
+
+	return find(str.c_str());
+}
+
+/* Knuth-Morris-Pratt matching of a string in a stream of characters. */
+static void hostMatchInit(const char *pattern, size_t len,
+		std::vector<size_t> &fail) {
+	fail.assign(len, 0);
+	for (size_t i = 1, k = 0; i < len; i++) {
+		while ((k > 0) && (pattern[i] != pattern[k])) {
+			k = fail[k - 1];
+		}
+		if (pattern[i] == pattern[k]) {
+			k++;
+		}
+		fail[i] = k;
+	}
+}
+
+static size_t hostMatchNext(const char *pattern,
+		const std::vector<size_t> &fail, size_t index, char c) {
+	while ((index > 0) && (c != pattern[index])) {
+		index = fail[index - 1];
+	}
+	return ((c == pattern[index]) ? (index + 1) : 0);
+}
+
+bool Stream::findUntil(const char *target, const char *terminator) {
+	size_t targetLen = strlen(target);
+	size_t termLen = (terminator ? strlen(terminator) : 0);
+	std::vector<size_t> targetFail, termFail;
+	size_t index = 0;
+	size_t termIndex = 0;
+	int c;
+
+	if (targetLen == 0) {
+		return true;
+	}
+	hostMatchInit(target, targetLen, targetFail);
+	hostMatchInit(terminator, termLen, termFail);
+	while ((c = timedRead()) >= 0) {
+		index = hostMatchNext(target, targetFail, index, c);
+		if (index == targetLen) {
+			return true;
+		}
+		if (termLen) {
+			termIndex = hostMatchNext(terminator, termFail, termIndex, c);
+			if (termIndex == termLen) {
+				return false;
+			}
+		}
+	}
+	return false;
+}
+
+long Stream::parseInt() {
+	bool negative = false;
+	long value = 0;
+	int c;
+
+	while (((c = timedPeek()) >= 0) && (c != '-') && !isdigit(c)) {
+		read();
+	}
+	if (c < 0) {
+		return 0;
+	}
+	if (c == '-') {
+		negative = true;
+		read();
+	}
+	while (((c = timedPeek()) >= 0) && isdigit(c)) {
+		value = value * 10 + c - '0';
+		read();
+	}
+	return (negative ? -value : value);
+}
+
+size_t Stream::readBytes(char *buffer, size_t length) {
+	size_t count = 0;
+
+	while (count < length) {
+		int c = timedRead();
+
+		if (c < 0) {
+			break;
+		}
+		buffer[count++] = c;
+	}
+	return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length) {
+	size_t count = 0;
+
+	while (count < length) {
+		int c = timedRead();
+
+		if ((c < 0) || (c == terminator)) {
+			break;
+		}
+		buffer[count++] = c;
+	}
+	return count;
+}
+
+String Stream::readString() {
+	String str;
+	int c;
+
+	while ((c = timedRead()) >= 0) {
+		str += (char) c;
+	}
+	return str;
+}
+
+String Stream::readStringUntil(char terminator) {
+	String str;
+	int c;
+
+	while (((c = timedRead()) >= 0) && (c != terminator)) {
+		str += (char) c;
+	}
+	return str;
+}
+
+bool IPAddress::fromString(const char *address) {
+	unsigned int bytes[4];
+	char extra;
+
+	if (sscanf(address, "%u.%u.%u.%u%c", &bytes[0], &bytes[1], &bytes[2],
+			&bytes[3], &extra) != 4) {
+		return false;
+	}
+	for (int i = 0; i < 4; i++) {
+		if (bytes[i] > 255) {
+			return false;
+		}
+		_address.bytes[i] = bytes[i];
+	}
+	return true;
+}
+
+String IPAddress::toString() const {
+	char buf[16];
+
+	snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _address.bytes[0],
+			_address.bytes[1], _address.bytes[2], _address.bytes[3]);
+	return String(buf);
+}
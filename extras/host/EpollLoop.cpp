@@ -0,0 +1,600 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "EpollLoop.h"
+#include "IotaHeap.h"
+#include "IotaTrace.h"
+
+#ifdef EPOLLLOOP_DEBUG
+#define DPRINTF	printf
+#else
+#define DPRINTF(fmt, ...)	do {} while(0)
+#endif
+
+struct EpollLoop::Fiber {
+	ucontext_t ctx;
+	void (*task)(void *arg);
+	void *arg;
+	void *stack;
+	struct iotaHeapContext heap;
+	bool done;
+};
+
+/* A task (or the thread calling post() from outside the loop) waiting for a
+ * connection event, for a free connection or for a deadline. */
+struct EpollLoop::Waiter {
+	Fiber *fiber;
+	unsigned long deadline;
+	bool woken;
+};
+
+struct EpollLoop::Conn {
+	int fd;
+	Waiter *waiter;
+};
+
+/* Parsing state of a HTTP response. */
+struct epollLoopResp {
+	size_t hdrLen;
+	int status;
+	long contentLen;
+	bool chunked;
+	bool close;
+	size_t chunkPos;	/* start of the first chunk not decoded yet */
+};
+
+static bool epollLoopExpired(unsigned long deadline) {
+	return ((long) (millis() - deadline) >= 0);
+}
+
+static bool epollLoopHeaderIs(const char *line, const char *name) {
+	size_t len = strlen(name);
+
+	return (!strncasecmp(line, name, len) && (line[len] == ':'));
+}
+
+/* Parses the status line and the headers of a response whose header section
+ * has been received entirely. */
+static bool epollLoopParseHeaders(const std::string &rx,
+		struct epollLoopResp &resp) {
+	int minor;
+	size_t pos, eol;
+
+	if (sscanf(rx.c_str(), "HTTP/1.%d %d", &minor, &resp.status) != 2) {
+		return false;
+	}
+	resp.contentLen = -1;
+	resp.chunked = false;
+	resp.close = (minor == 0);
+	for (pos = rx.find("\r\n") + 2; pos < resp.hdrLen - 2; pos = eol + 2) {
+		const char *line = rx.c_str() + pos;
+		const char *value;
+
+		eol = rx.find("\r\n", pos);
+		value = strchr(line, ':');
+		if (!value || (value > rx.c_str() + eol)) {
+			continue;
+		}
+		value++;
+		if (epollLoopHeaderIs(line, "Content-Length")) {
+			resp.contentLen = strtol(value, NULL, 10);
+		}
+		else if (epollLoopHeaderIs(line, "Transfer-Encoding")) {
+			resp.chunked = !strncasecmp(value + strspn(value, " \t"),
+					"chunked", 7);
+		}
+		else if (epollLoopHeaderIs(line, "Connection")) {
+			resp.close = !strncasecmp(value + strspn(value, " \t"),
+					"close", 5);
+		}
+	}
+	return true;
+}
+
+/* Decodes the chunks of a body received since the last call, appending them
+ * to the body; returns 1 if the body is complete, 0 if more data is needed, -1
+ * if the body is malformed. */
+static int epollLoopDecodeChunked(const std::string &rx, size_t &chunkPos,
+		String &body) {
+	for (;;) {
+		size_t pos = chunkPos;
+		size_t eol = rx.find("\r\n", pos);
+		unsigned long size;
+		char *end;
+
+		if (eol == std::string::npos) {
+			return 0;
+		}
+		size = strtoul(rx.c_str() + pos, &end, 16);
+		if (end == rx.c_str() + pos) {
+			return -1;
+		}
+		pos = eol + 2;
+		if (size == 0) {
+			/* Skip trailer fields until the empty line. */
+			while ((eol = rx.find("\r\n", pos)) != pos) {
+				if (eol == std::string::npos) {
+					return 0;
+				}
+				pos = eol + 2;
+			}
+			return 1;
+		}
+		if (rx.length() < pos + size + 2) {
+			return 0;
+		}
+		body.append(rx, pos, size);
+		chunkPos = pos + size + 2;
+	}
+}
+
+/* Returns 1 if a response has been received entirely, 0 if more data is
+ * needed, -1 if the response is malformed. */
+static int epollLoopParse(const std::string &rx, struct epollLoopResp &resp,
+		String &body) {
+	if (resp.hdrLen == 0) {
+		size_t end = rx.find("\r\n\r\n");
+
+		if (end == std::string::npos) {
+			return 0;
+		}
+		resp.hdrLen = end + 4;
+		if (!epollLoopParseHeaders(rx, resp)) {
+			return -1;
+		}
+		resp.chunkPos = resp.hdrLen;
+		body.clear();
+	}
+	if ((resp.status == 204) || (resp.status == 304)) {
+		body.clear();
+		return 1;
+	}
+	if (resp.chunked) {
+		return epollLoopDecodeChunked(rx, resp.chunkPos, body);
+	}
+	if ((resp.contentLen >= 0) &&
+			(rx.length() - resp.hdrLen >= (size_t) resp.contentLen)) {
+		body.assign(rx, resp.hdrLen, resp.contentLen);
+		return 1;
+	}
+	return 0;	/* body delimited by the end of the connection */
+}
+
+EpollLoop::EpollLoop(const char *host, int port, unsigned int maxConnections)
+: _host(host), _port(port), _maxConns(maxConnections), _addrLen(0),
+  _epfd(-1), _current(NULL), _tasks(0), _conns(0), _inFlight(0),
+  _maxInFlight(0), _requests(0) {
+}
+
+EpollLoop::~EpollLoop() {
+	while (!_idle.empty()) {
+		Conn *conn = _idle.back();
+
+		_idle.pop_back();
+		close(conn);
+	}
+	if (_epfd >= 0) {
+		::close(_epfd);
+	}
+}
+
+bool EpollLoop::begin() {
+	struct addrinfo hints, *res;
+	char service[8];
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	snprintf(service, sizeof(service), "%u", _port);
+	if (getaddrinfo(_host.c_str(), service, &hints, &res) != 0) {
+		DPRINTF("%s: cannot resolve %s\n", __FUNCTION__, _host.c_str());
+		return false;
+	}
+	memcpy(&_addr, res->ai_addr, res->ai_addrlen);
+	_addrLen = res->ai_addrlen;
+	freeaddrinfo(res);
+	if (_epfd < 0) {
+		_epfd = epoll_create1(EPOLL_CLOEXEC);
+	}
+	return (_epfd >= 0);
+}
+
+bool EpollLoop::spawn(void (*task)(void *arg), void *arg, size_t stackSize) {
+	Fiber *fiber = new Fiber;
+	uintptr_t ptr = (uintptr_t) fiber;
+
+	fiber->task = task;
+	fiber->arg = arg;
+	fiber->done = false;
+	memset(&fiber->heap, 0, sizeof(fiber->heap));
+	fiber->stack = malloc(stackSize);
+	if (!fiber->stack) {
+		delete fiber;
+		return false;
+	}
+	getcontext(&fiber->ctx);
+	fiber->ctx.uc_stack.ss_sp = fiber->stack;
+	fiber->ctx.uc_stack.ss_size = stackSize;
+	fiber->ctx.uc_link = &_schedCtx;
+	/* makecontext() passes int arguments: split the pointer in two halves. */
+	makecontext(&fiber->ctx, (void (*)()) fiberMain, 2,
+			(unsigned int) ((ptr >> 16) >> 16), (unsigned int) ptr);
+	_runnable.push_back(fiber);
+	_tasks++;
+	return true;
+}
+
+void EpollLoop::run() {
+	while (_tasks != 0) {
+		step();
+	}
+}
+
+int EpollLoop::post(const String &content, String &response,
+		unsigned long timeout) {
+	unsigned long deadline = millis() + timeout;
+	std::string request;
+	char hdr[256];
+
+	snprintf(hdr, sizeof(hdr), "POST / HTTP/1.1\r\nHost: %s:%d\r\n"
+			"Content-Type: application/json\r\nX-IOTA-API-Version: 1\r\n"
+			"Content-Length: %u\r\n\r\n", _host.c_str(), _port,
+			content.length());
+	request.reserve(strlen(hdr) + content.length());
+	request += hdr;
+	request += content;
+	for (int attempt = 0; attempt < 2; attempt++) {
+		bool reused, keepAlive = false;
+		Conn *conn = acquire(deadline, reused);
+		int status;
+
+		if (!conn) {
+			return -1;
+		}
+		_requests++;
+		if (++_inFlight > _maxInFlight) {
+			_maxInFlight = _inFlight;
+		}
+		status = exchange(conn, request, response, deadline, keepAlive);
+		_inFlight--;
+		if ((status >= 0) && keepAlive) {
+			release(conn);
+		}
+		else {
+			close(conn);
+		}
+		/* A keep-alive connection may have been closed by the node while the
+		 * request was being sent: retry once on a new connection. */
+		if ((status != -2) || !reused) {
+			return ((status >= 0) ? status : -1);
+		}
+		DPRINTF("%s: connection closed by node, retrying\n", __FUNCTION__);
+	}
+	return -1;
+}
+
+unsigned int EpollLoop::getTaskCount() {
+	return _tasks;
+}
+
+unsigned int EpollLoop::getConnectionCount() {
+	return _conns;
+}
+
+unsigned long EpollLoop::getRequestCount() {
+	return _requests;
+}
+
+unsigned int EpollLoop::getMaxInFlight() {
+	return _maxInFlight;
+}
+
+void EpollLoop::fiberMain(unsigned int hi, unsigned int lo) {
+	Fiber *fiber = (Fiber *) ((((uintptr_t) hi << 16) << 16) | lo);
+
+	fiber->task(fiber->arg);
+	fiber->done = true;
+	/* Returning resumes the loop through uc_link. */
+}
+
+/* Heap accounting and trace events of the library are kept per thread: they
+ * are switched to the task while it runs, so that they are not mixed with
+ * those of other tasks. */
+void EpollLoop::resume(Fiber *fiber) {
+	_current = fiber;
+	iotaHeapSwapContext(fiber->heap);
+	iotaTraceSetContext(fiber);
+	swapcontext(&_schedCtx, &fiber->ctx);
+	iotaTraceSetContext(NULL);
+	iotaHeapSwapContext(fiber->heap);
+	_current = NULL;
+	if (fiber->done) {
+		free(fiber->stack);
+		delete fiber;
+		_tasks--;
+	}
+}
+
+/* Runs the tasks that are ready, then waits for connection events until the
+ * nearest deadline and wakes up the tasks waiting for them. */
+void EpollLoop::step() {
+	struct epoll_event events[EPOLLLOOP_MAX_EVENTS];
+	std::vector<Waiter *> expired;
+	int timeout = -1;
+	int count;
+
+	while (!_runnable.empty()) {
+		Fiber *fiber = _runnable.front();
+
+		_runnable.erase(_runnable.begin());
+		resume(fiber);
+	}
+	if ((_tasks == 0) && _waiters.empty()) {
+		return;
+	}
+	for (auto it = _waiters.cbegin(); it != _waiters.cend(); it++) {
+		long left = (long) ((*it)->deadline - millis());
+
+		if (left < 0) {
+			left = 0;
+		}
+		if ((timeout < 0) || (left < timeout)) {
+			timeout = left;
+		}
+	}
+	count = epoll_wait(_epfd, events, EPOLLLOOP_MAX_EVENTS, timeout);
+	for (int i = 0; i < count; i++) {
+		Conn *conn = (Conn *) events[i].data.ptr;
+
+		if (conn->waiter) {
+			wake(conn->waiter);
+		}
+	}
+	for (auto it = _waiters.cbegin(); it != _waiters.cend(); it++) {
+		if (epollLoopExpired((*it)->deadline)) {
+			expired.push_back(*it);
+		}
+	}
+	for (auto it = expired.cbegin(); it != expired.cend(); it++) {
+		wake(*it);
+	}
+}
+
+/* Suspends the current task, or runs the loop if called from outside a task,
+ * until the waiter is woken up. */
+void EpollLoop::wait(Waiter &waiter) {
+	Fiber *fiber = _current;
+
+	waiter.fiber = fiber;
+	waiter.woken = false;
+	_waiters.push_back(&waiter);
+	if (fiber) {
+		swapcontext(&fiber->ctx, &_schedCtx);
+	}
+	else {
+		while (!waiter.woken) {
+			step();
+		}
+	}
+}
+
+void EpollLoop::wake(Waiter *waiter) {
+	if (waiter->woken) {
+		return;
+	}
+	waiter->woken = true;
+	_waiters.erase(std::find(_waiters.begin(), _waiters.end(), waiter));
+	if (waiter->fiber) {
+		_runnable.push_back(waiter->fiber);
+	}
+}
+
+/* Waits for a connection to be ready for the given events; returns false if
+ * the deadline has expired. */
+bool EpollLoop::waitConn(Conn *conn, uint32_t events, unsigned long deadline) {
+	struct epoll_event ev;
+	Waiter waiter;
+
+	if (epollLoopExpired(deadline)) {
+		return false;
+	}
+	ev.events = events | EPOLLONESHOT;
+	ev.data.ptr = conn;
+	if (epoll_ctl(_epfd, EPOLL_CTL_MOD, conn->fd, &ev) < 0) {
+		return false;
+	}
+	waiter.deadline = deadline;
+	conn->waiter = &waiter;
+	wait(waiter);
+	conn->waiter = NULL;
+	return !epollLoopExpired(deadline);
+}
+
+/* Returns an idle connection or a new one; waits for a connection to be
+ * released when the maximum number of connections is open. */
+EpollLoop::Conn *EpollLoop::acquire(unsigned long deadline, bool &reused) {
+	for (;;) {
+		while (!_idle.empty()) {
+			Conn *conn = _idle.back();
+			char c;
+
+			_idle.pop_back();
+			if ((recv(conn->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) < 0) &&
+					((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+				reused = true;
+				return conn;
+			}
+			close(conn);	/* closed by the node while idle */
+		}
+		if (_conns < _maxConns) {
+			reused = false;
+			return open(deadline);
+		}
+
+		Waiter waiter;
+
+		waiter.deadline = deadline;
+		_connWaiters.push_back(&waiter);
+		wait(waiter);
+		auto it = std::find(_connWaiters.begin(), _connWaiters.end(), &waiter);
+		if (it != _connWaiters.end()) {
+			_connWaiters.erase(it);
+		}
+		if (epollLoopExpired(deadline)) {
+			return NULL;
+		}
+	}
+}
+
+EpollLoop::Conn *EpollLoop::open(unsigned long deadline) {
+	struct epoll_event ev;
+	Conn *conn;
+	int one = 1;
+	int err = 0;
+	socklen_t errLen = sizeof(err);
+	int fd = socket(_addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK |
+			SOCK_CLOEXEC, 0);
+
+	if (fd < 0) {
+		return NULL;
+	}
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	ev.events = 0;
+	ev.data.ptr = conn = new Conn;
+	conn->fd = fd;
+	conn->waiter = NULL;
+	if (epoll_ctl(_epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+		::close(fd);
+		delete conn;
+		return NULL;
+	}
+	_conns++;
+	if (connect(fd, (struct sockaddr *) &_addr, _addrLen) < 0) {
+		if ((errno != EINPROGRESS) || !waitConn(conn, EPOLLOUT, deadline) ||
+				(getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errLen) < 0) ||
+				(err != 0)) {
+			DPRINTF("%s: cannot connect to %s:%d\n", __FUNCTION__,
+					_host.c_str(), _port);
+			close(conn);
+			return NULL;
+		}
+	}
+	return conn;
+}
+
+void EpollLoop::release(Conn *conn) {
+	_idle.push_back(conn);
+	if (!_connWaiters.empty()) {
+		Waiter *waiter = _connWaiters.front();
+
+		_connWaiters.erase(_connWaiters.begin());
+		wake(waiter);
+	}
+}
+
+void EpollLoop::close(Conn *conn) {
+	::close(conn->fd);	/* also removes the descriptor from epoll */
+	delete conn;
+	_conns--;
+	if (!_connWaiters.empty()) {
+		Waiter *waiter = _connWaiters.front();
+
+		_connWaiters.erase(_connWaiters.begin());
+		wake(waiter);
+	}
+}
+
+/* Sends a request over a connection and receives the response; returns the
+ * response status, -1 on error, or -2 if the connection has been closed
+ * before any response data has been received. */
+int EpollLoop::exchange(Conn *conn, const std::string &request,
+		String &response, unsigned long deadline, bool &keepAlive) {
+	struct epollLoopResp resp;
+	std::string rx;
+	size_t sent = 0;
+
+	while (sent < request.length()) {
+		ssize_t ret = send(conn->fd, request.data() + sent,
+				request.length() - sent, MSG_NOSIGNAL);
+
+		if (ret > 0) {
+			sent += ret;
+		}
+		else if ((ret < 0) && ((errno == EAGAIN) || (errno == EINTR))) {
+			if ((errno == EAGAIN) && !waitConn(conn, EPOLLOUT, deadline)) {
+				return -1;
+			}
+		}
+		else {
+			return ((errno == EPIPE) || (errno == ECONNRESET)) ? -2 : -1;
+		}
+	}
+	resp.hdrLen = 0;
+	for (;;) {
+		ssize_t ret = recv(conn->fd, _rxBuf, sizeof(_rxBuf), 0);
+
+		if (ret > 0) {
+			int done;
+
+			rx.append(_rxBuf, ret);
+			done = epollLoopParse(rx, resp, response);
+			if (done != 0) {
+				keepAlive = !resp.close;
+				return ((done > 0) ? resp.status : -1);
+			}
+		}
+		else if (ret == 0) {
+			if (rx.empty()) {
+				return -2;
+			}
+			if ((resp.hdrLen != 0) && !resp.chunked &&
+					(resp.contentLen < 0)) {
+				response.assign(rx, resp.hdrLen, std::string::npos);
+				keepAlive = false;
+				return resp.status;
+			}
+			return -1;
+		}
+		else if (errno == EAGAIN) {
+			if (!waitConn(conn, EPOLLIN, deadline)) {
+				DPRINTF("%s: timeout\n", __FUNCTION__);
+				return -1;
+			}
+		}
+		else if (errno != EINTR) {
+			return ((rx.empty() && (errno == ECONNRESET)) ? -2 : -1);
+		}
+	}
+}
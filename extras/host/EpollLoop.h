@@ -0,0 +1,179 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _EPOLL_LOOP_H_
+#define _EPOLL_LOOP_H_
+
+#include <sys/socket.h>
+#include <ucontext.h>
+
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+
+/* Maximum number of connections opened by a loop to the IOTA node. */
+#ifndef EPOLLLOOP_MAX_CONNECTIONS
+#define EPOLLLOOP_MAX_CONNECTIONS	64
+#endif
+
+/* Stack size of tasks; pages are committed by the kernel when first used, so
+ * unused stack space does not take physical memory. */
+#ifndef EPOLLLOOP_STACK_SIZE
+#define EPOLLLOOP_STACK_SIZE	(256 * 1024)
+#endif
+
+/* Size of the buffer used to receive response data. */
+#ifndef EPOLLLOOP_RX_BUF_SIZE
+#define EPOLLLOOP_RX_BUF_SIZE	16384
+#endif
+
+/* Maximum number of events retrieved by a single epoll_wait() call. */
+#define EPOLLLOOP_MAX_EVENTS	64
+
+/** Event loop sending requests of many tasks to a IOTA node concurrently
+      Tasks run as fibers (user-level threads with their own stack) on the
+      thread that calls run(). A task that sends a request is suspended until
+      the response is received, while the other tasks run, so that hundreds of
+      wallet operations written with the blocking IotaClient and IotaWallet
+      API have their requests in flight at the same time on one thread.
+      Requests are sent over a pool of non-blocking keep-alive connections to
+      the node, multiplexed with epoll.
+      A loop must be used by one thread at a time; to spread tasks over
+      several threads, create one loop per thread. Library state kept per
+      thread (heap accounting and the trace execution context) is switched
+      to each task while it runs.
+*/
+class EpollLoop {
+public:
+
+	/** Create an event loop
+      @param host  IOTA node host, expressed as either host name or IP address
+             with dotted notation
+      @param port  IOTA node port
+      @param maxConnections  Maximum number of connections to the node, i.e.
+             of requests in flight; tasks wait for a free connection when the
+             maximum is reached
+      @return none
+	*/
+	EpollLoop(const char *host, int port,
+			unsigned int maxConnections = EPOLLLOOP_MAX_CONNECTIONS);
+
+	~EpollLoop();
+
+	/** Resolve the address of the IOTA node and set up the loop
+      @return true if the loop has been set up, false otherwise
+	*/
+	bool begin();
+
+	/** Add a task to the loop
+      The task starts running when the loop is run.
+      @param task  Task function
+      @param arg  Opaque argument passed to the task function
+      @param stackSize  Stack size of the task, in bytes
+      @return true if the task has been added, false if memory for the task
+              could not be allocated
+	*/
+	bool spawn(void (*task)(void *arg), void *arg,
+			size_t stackSize = EPOLLLOOP_STACK_SIZE);
+
+	/** Run the loop until all tasks have returned
+      @return none
+	*/
+	void run();
+
+	/** Send a POST request to the IOTA node and wait for the response
+      When called from a task, only the task waits; when called from outside
+      the loop, the loop runs on the calling thread until the response is
+      received.
+      @param content  JSON request
+      @param response  String that is filled with the response body
+      @param timeout  Timeout in milliseconds for the whole request
+      @return HTTP status code of the response, or -1 if the request could not
+              be sent or no response has been received
+	*/
+	int post(const String &content, String &response, unsigned long timeout);
+
+	/** Retrieve number of tasks that have not returned yet
+      @return number of tasks
+	*/
+	unsigned int getTaskCount();
+
+	/** Retrieve number of open connections to the node
+      @return number of connections
+	*/
+	unsigned int getConnectionCount();
+
+	/** Retrieve number of requests sent
+      @return number of requests
+	*/
+	unsigned long getRequestCount();
+
+	/** Retrieve maximum number of requests that have been in flight at the
+      same time
+      @return number of requests
+	*/
+	unsigned int getMaxInFlight();
+
+private:
+	struct Fiber;
+	struct Waiter;
+	struct Conn;
+
+	EpollLoop(const EpollLoop &);
+	EpollLoop &operator=(const EpollLoop &);
+	static void fiberMain(unsigned int hi, unsigned int lo);
+	void resume(Fiber *fiber);
+	void step();
+	void wait(Waiter &waiter);
+	void wake(Waiter *waiter);
+	bool waitConn(Conn *conn, uint32_t events, unsigned long deadline);
+	Conn *acquire(unsigned long deadline, bool &reused);
+	Conn *open(unsigned long deadline);
+	void release(Conn *conn);
+	void close(Conn *conn);
+	int exchange(Conn *conn, const std::string &request, String &response,
+			unsigned long deadline, bool &keepAlive);
+
+	String _host;
+	int _port;
+	unsigned int _maxConns;
+	struct sockaddr_storage _addr;
+	socklen_t _addrLen;
+	int _epfd;
+	ucontext_t _schedCtx;
+	Fiber *_current;
+	std::vector<Fiber *> _runnable;
+	std::vector<Waiter *> _waiters;
+	std::vector<Waiter *> _connWaiters;
+	std::vector<Conn *> _idle;
+	unsigned int _tasks;
+	unsigned int _conns;
+	unsigned int _inFlight, _maxInFlight;
+	unsigned long _requests;
+	char _rxBuf[EPOLLLOOP_RX_BUF_SIZE];
+};
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "EpollTransport.h"
+
+EpollTransport::EpollTransport(EpollLoop &loop) : _loop(loop),
+	_requestTimeout(EPOLLTRANSPORT_TIMEOUT), _respPos(0) {
+	setTimeout(0);
+}
+
+void EpollTransport::setRequestTimeout(unsigned long timeout) {
+	_requestTimeout = timeout;
+}
+
+int EpollTransport::available() {
+	return _resp.length() - _respPos;
+}
+
+int EpollTransport::read() {
+	return ((_respPos < _resp.length()) ?
+			(unsigned char) _resp[_respPos++] : -1);
+}
+
+int EpollTransport::peek() {
+	return ((_respPos < _resp.length()) ?
+			(unsigned char) _resp[_respPos] : -1);
+}
+
+size_t EpollTransport::write(uint8_t) {
+	return 0;
+}
+
+int EpollTransport::sendRequest(JsonDocument &jsonDoc) {
+	_req.clear();
+	_req.reserve(measureJson(jsonDoc));
+	serializeJson(jsonDoc, _req);
+	_resp.clear();
+	_respPos = 0;
+	return _loop.post(_req, _resp, _requestTimeout);
+}
+
+Stream &EpollTransport::getResponseStream() {
+	return *this;
+}
+
+/* The response body is already in memory: parse it without going through
+ * the stream interface. */
+DeserializationError EpollTransport::readResponse(JsonDocument &jsonDoc) {
+	DeserializationError error = deserializeJson(jsonDoc, _resp.c_str(),
+			_resp.length());
+
+	_respPos = _resp.length();
+	return error;
+}
+
+void EpollTransport::dropResponse() {
+	_resp.clear();
+	_respPos = 0;
+}
@@ -0,0 +1,83 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _EPOLL_TRANSPORT_H_
+#define _EPOLL_TRANSPORT_H_
+
+#include <IotaTransport.h>
+
+#include "EpollLoop.h"
+
+/* Timeout in milliseconds for a request, including the wait for a free
+ * connection. */
+#ifndef EPOLLTRANSPORT_TIMEOUT
+#define EPOLLTRANSPORT_TIMEOUT	60000
+#endif
+
+/** Transport sending the requests of an IotaClient through an event loop
+      Each IotaClient (and the wallet using it) needs its own transport; the
+      transports of many clients share the same loop and its connections. The
+      client must be used from a task of the loop, or from the thread owning
+      the loop while the loop is not running.
+
+      EpollLoop loop(host, port);
+      EpollTransport transport(loop);
+      IotaClient iotaClient(transport);
+      IotaWallet iotaWallet(iotaClient);
+*/
+class EpollTransport : public Stream, public IotaTransport {
+public:
+
+	/** Create a transport
+      @param loop  Event loop through which requests are sent
+      @return none
+	*/
+	EpollTransport(EpollLoop &loop);
+
+	/** Set timeout for requests
+      @param timeout  Timeout in milliseconds
+      @return none
+	*/
+	void setRequestTimeout(unsigned long timeout);
+
+	int available();
+	int read();
+	int peek();
+	size_t write(uint8_t b);
+
+	int sendRequest(JsonDocument &jsonDoc);
+	Stream &getResponseStream();
+	DeserializationError readResponse(JsonDocument &jsonDoc);
+	void dropResponse();
+
+private:
+	EpollLoop &_loop;
+	unsigned long _requestTimeout;
+	String _req;
+	String _resp;
+	unsigned int _respPos;
+};
+
+#endif
@@ -0,0 +1,86 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "FileStream.h"
+
+FileStream::FileStream() : _file(NULL) {
+	setTimeout(0);
+}
+
+FileStream::~FileStream() {
+	close();
+}
+
+bool FileStream::open(const char *path, const char *mode) {
+	close();
+	_file = fopen(path, mode);
+	return (_file != NULL);
+}
+
+void FileStream::close() {
+	if (_file) {
+		fclose(_file);
+		_file = NULL;
+	}
+}
+
+size_t FileStream::write(uint8_t c) {
+	return write(&c, 1);
+}
+
+size_t FileStream::write(const uint8_t *buf, size_t size) {
+	return (_file ? fwrite(buf, 1, size, _file) : 0);
+}
+
+int FileStream::available() {
+	return ((peek() >= 0) ? 1 : 0);
+}
+
+int FileStream::read() {
+	return (_file ? getc(_file) : -1);
+}
+
+int FileStream::peek() {
+	int c;
+
+	if (!_file) {
+		return -1;
+	}
+	c = getc(_file);
+	if (c >= 0) {
+		ungetc(c, _file);
+	}
+	return c;
+}
+
+void FileStream::flush() {
+	if (_file) {
+		fflush(_file);
+	}
+}
+
+FileStream::operator bool() {
+	return (_file != NULL);
+}
@@ -0,0 +1,71 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _FILE_STREAM_H_
+#define _FILE_STREAM_H_
+
+#include <stdio.h>
+
+#include "Arduino.h"
+
+/** Arduino stream over a file
+      Can be used wherever a File from an Arduino file system library would
+      be used on a device, e.g. for traffic logs of an IotaClient.
+*/
+class FileStream : public Stream {
+public:
+	FileStream();
+	~FileStream();
+
+	/** Open a file
+      @param path  File path
+      @param mode  Access mode, as in fopen()
+      @return true if the file has been opened, false otherwise
+	*/
+	bool open(const char *path, const char *mode);
+
+	/** Close the file, if open
+      @return none
+	*/
+	void close();
+
+	size_t write(uint8_t c);
+	size_t write(const uint8_t *buf, size_t size);
+	int available();
+	int read();
+	int peek();
+	void flush();
+	operator bool();
+
+	using Print::write;
+
+private:
+	FileStream(const FileStream &);
+	FileStream &operator=(const FileStream &);
+
+	FILE *_file;
+};
+
+#endif
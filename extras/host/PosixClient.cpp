@@ -0,0 +1,230 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "PosixClient.h"
+
+/* File descriptors of open connections, polled by waitReadable(). */
+static std::vector<int> posixClientFds;
+static pthread_mutex_t posixClientLock = PTHREAD_MUTEX_INITIALIZER;
+
+static void posixClientRegister(int fd) {
+	pthread_mutex_lock(&posixClientLock);
+	posixClientFds.push_back(fd);
+	pthread_mutex_unlock(&posixClientLock);
+}
+
+static void posixClientUnregister(int fd) {
+	pthread_mutex_lock(&posixClientLock);
+	for (auto it = posixClientFds.begin(); it != posixClientFds.end(); it++) {
+		if (*it == fd) {
+			posixClientFds.erase(it);
+			break;
+		}
+	}
+	pthread_mutex_unlock(&posixClientLock);
+}
+
+PosixClient::PosixClient() : _fd(-1), _eof(false), _head(0), _len(0) {
+}
+
+PosixClient::~PosixClient() {
+	stop();
+}
+
+int PosixClient::connect(IPAddress ip, uint16_t port) {
+	return connect(ip.toString().c_str(), port);
+}
+
+int PosixClient::connect(const char *host, uint16_t port) {
+	struct addrinfo hints, *res, *ai;
+	char service[8];
+	int one = 1;
+
+	stop();
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	snprintf(service, sizeof(service), "%u", port);
+	if (getaddrinfo(host, service, &hints, &res) != 0) {
+		return 0;
+	}
+	for (ai = res; ai; ai = ai->ai_next) {
+		_fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+		if (_fd < 0) {
+			continue;
+		}
+		if (::connect(_fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+			break;
+		}
+		::close(_fd);
+		_fd = -1;
+	}
+	freeaddrinfo(res);
+	if (_fd < 0) {
+		return 0;
+	}
+	setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL) | O_NONBLOCK);
+	posixClientRegister(_fd);
+	return 1;
+}
+
+size_t PosixClient::write(uint8_t c) {
+	return write(&c, 1);
+}
+
+size_t PosixClient::write(const uint8_t *buf, size_t size) {
+	size_t sent = 0;
+
+	while ((_fd >= 0) && (sent < size)) {
+		ssize_t ret = send(_fd, buf + sent, size - sent, MSG_NOSIGNAL);
+
+		if (ret > 0) {
+			sent += ret;
+		}
+		else if ((ret < 0) && ((errno == EAGAIN) || (errno == EINTR))) {
+			struct pollfd pfd = {_fd, POLLOUT, 0};
+
+			poll(&pfd, 1, -1);
+		}
+		else {
+			break;
+		}
+	}
+	return sent;
+}
+
+bool PosixClient::fill() {
+	ssize_t ret;
+
+	if (_len != 0) {
+		return true;
+	}
+	if ((_fd < 0) || _eof) {
+		return false;
+	}
+	ret = recv(_fd, _buf, sizeof(_buf), MSG_DONTWAIT);
+	if (ret > 0) {
+		_head = 0;
+		_len = ret;
+		return true;
+	}
+	if ((ret == 0) || ((errno != EAGAIN) && (errno != EINTR))) {
+		/* End of stream: stop polling the connection. */
+		_eof = true;
+		posixClientUnregister(_fd);
+	}
+	return false;
+}
+
+int PosixClient::available() {
+	fill();
+	return _len;
+}
+
+int PosixClient::read() {
+	int c;
+
+	if (!fill()) {
+		return -1;
+	}
+	c = _buf[_head++];
+	_len--;
+	return c;
+}
+
+int PosixClient::read(uint8_t *buf, size_t size) {
+	size_t count = 0;
+
+	while ((count < size) && fill()) {
+		size_t n = ((_len < size - count) ? _len : (size - count));
+
+		memcpy(buf + count, _buf + _head, n);
+		_head += n;
+		_len -= n;
+		count += n;
+	}
+	return ((count != 0) ? (int) count : -1);
+}
+
+int PosixClient::peek() {
+	return (fill() ? _buf[_head] : -1);
+}
+
+void PosixClient::flush() {
+}
+
+void PosixClient::stop() {
+	if (_fd >= 0) {
+		if (!_eof) {
+			posixClientUnregister(_fd);
+		}
+		::close(_fd);
+	}
+	_fd = -1;
+	_eof = false;
+	_head = _len = 0;
+}
+
+uint8_t PosixClient::connected() {
+	return (fill() || ((_fd >= 0) && !_eof));
+}
+
+PosixClient::operator bool() {
+	return (_fd >= 0);
+}
+
+bool PosixClient::waitReadable(unsigned long ms) {
+	std::vector<struct pollfd> pfds;
+
+	pthread_mutex_lock(&posixClientLock);
+	for (auto it = posixClientFds.cbegin(); it != posixClientFds.cend();
+			it++) {
+		struct pollfd pfd = {*it, POLLIN, 0};
+
+		pfds.push_back(pfd);
+	}
+	pthread_mutex_unlock(&posixClientLock);
+	if (pfds.empty()) {
+		struct timespec ts = {(time_t) (ms / 1000), (long) (ms % 1000) * 1000000};
+
+		nanosleep(&ts, NULL);
+		return false;
+	}
+	return (poll(pfds.data(), pfds.size(), ms) > 0);
+}
@@ -0,0 +1,79 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _POSIX_CLIENT_H_
+#define _POSIX_CLIENT_H_
+
+#include "Arduino.h"
+
+/* Size of the receive buffer of a connection. */
+#ifndef POSIXCLIENT_RX_BUF_SIZE
+#define POSIXCLIENT_RX_BUF_SIZE	4096
+#endif
+
+/** Arduino network client over a POSIX TCP socket
+      Can be used wherever a WiFiClient or EthernetClient would be used on a
+      device, e.g. to create an IotaClient in a host build.
+*/
+class PosixClient : public Client {
+public:
+	PosixClient();
+	~PosixClient();
+
+	int connect(IPAddress ip, uint16_t port);
+	int connect(const char *host, uint16_t port);
+	size_t write(uint8_t c);
+	size_t write(const uint8_t *buf, size_t size);
+	int available();
+	int read();
+	int read(uint8_t *buf, size_t size);
+	int peek();
+	void flush();
+	void stop();
+	uint8_t connected();
+	operator bool();
+
+	using Print::write;
+
+	/** Wait for data to be received on any open connection
+      @param ms  Maximum time to wait, in milliseconds
+      @return true if data (or end of stream) is available on a connection,
+              false if the wait timed out
+	*/
+	static bool waitReadable(unsigned long ms);
+
+private:
+	PosixClient(const PosixClient &);
+	PosixClient &operator=(const PosixClient &);
+	bool fill();
+	void close();
+
+	int _fd;
+	bool _eof;
+	size_t _head, _len;
+	uint8_t _buf[POSIXCLIENT_RX_BUF_SIZE];
+};
+
+#endif
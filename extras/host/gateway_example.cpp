@@ -0,0 +1,167 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Gateway example: scans the balance and finds a receive address of many
+ * wallets concurrently, with one event loop per thread and one loop task per
+ * wallet; all requests of a thread share its loop's connections to the node.
+ *
+ * Usage: gateway_example <host> <port> <threads> <wallets> <seed>
+ * Wallet seeds are derived from the given seed by replacing its last trytes
+ * with the wallet index.
+ */
+
+#include <pthread.h>
+
+#include <IotaWallet.h>
+
+#include "EpollTransport.h"
+
+#define SEED_LEN	81
+
+struct gatewayWallet {
+	char seed[SEED_LEN + 1];
+	uint64_t balance;
+	String addr;
+	bool ok;
+};
+
+struct gatewayThread {
+	pthread_t thread;
+	const char *host;
+	int port;
+	struct gatewayWallet *wallets;
+	unsigned int count;
+	unsigned long requests;
+	unsigned int maxInFlight;
+	bool ok;
+};
+
+static __thread EpollLoop *threadLoop;
+
+static void walletTask(void *arg) {
+	struct gatewayWallet *wallet = (struct gatewayWallet *) arg;
+	EpollTransport transport(*threadLoop);
+	IotaClient iotaClient(transport);
+	IotaWallet iotaWallet(iotaClient);
+
+	wallet->ok = (iotaWallet.begin(wallet->seed) &&
+			iotaWallet.getBalance(&wallet->balance) &&
+			iotaWallet.getReceiveAddress(wallet->addr));
+}
+
+static void *loopThread(void *arg) {
+	struct gatewayThread *thread = (struct gatewayThread *) arg;
+	EpollLoop loop(thread->host, thread->port);
+
+	thread->ok = loop.begin();
+	if (!thread->ok) {
+		return NULL;
+	}
+	threadLoop = &loop;
+	for (unsigned int i = 0; i < thread->count; i++) {
+		if (!loop.spawn(walletTask, &thread->wallets[i])) {
+			thread->ok = false;
+			break;
+		}
+	}
+	loop.run();
+	thread->requests = loop.getRequestCount();
+	thread->maxInFlight = loop.getMaxInFlight();
+	return NULL;
+}
+
+static void deriveSeed(const char *seed, unsigned int idx, char *walletSeed) {
+	static const char trytes[] = "9ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+	memcpy(walletSeed, seed, SEED_LEN);
+	for (int i = SEED_LEN - 1; idx != 0; i--, idx /= 27) {
+		walletSeed[i] = trytes[idx % 27];
+	}
+	walletSeed[SEED_LEN] = '\0';
+}
+
+int main(int argc, char **argv) {
+	struct gatewayThread *threads;
+	struct gatewayWallet *wallets;
+	unsigned int numThreads, numWallets, failed = 0;
+	unsigned long requests = 0;
+	unsigned long startTime;
+
+	if ((argc != 6) || (strlen(argv[5]) != SEED_LEN)) {
+		printf("Usage: %s <host> <port> <threads> <wallets> <seed>\n",
+				argv[0]);
+		return 1;
+	}
+	numThreads = atoi(argv[3]);
+	numWallets = atoi(argv[4]);
+	if ((numThreads == 0) || (numWallets < numThreads)) {
+		printf("Invalid number of threads or wallets\n");
+		return 1;
+	}
+	wallets = new struct gatewayWallet[numWallets];
+	for (unsigned int i = 0; i < numWallets; i++) {
+		deriveSeed(argv[5], i, wallets[i].seed);
+	}
+	threads = new struct gatewayThread[numThreads];
+	startTime = millis();
+	for (unsigned int i = 0; i < numThreads; i++) {
+		unsigned int first = numWallets * i / numThreads;
+
+		threads[i].host = argv[1];
+		threads[i].port = atoi(argv[2]);
+		threads[i].wallets = &wallets[first];
+		threads[i].count = numWallets * (i + 1) / numThreads - first;
+		pthread_create(&threads[i].thread, NULL, loopThread, &threads[i]);
+	}
+	for (unsigned int i = 0; i < numThreads; i++) {
+		pthread_join(threads[i].thread, NULL);
+		if (!threads[i].ok) {
+			printf("Couldn't run event loop %u\n", i);
+			return 1;
+		}
+		printf("Thread %u: %u wallets, %lu requests, %u max in flight\n", i,
+				threads[i].count, threads[i].requests,
+				threads[i].maxInFlight);
+		requests += threads[i].requests;
+	}
+	for (unsigned int i = 0; i < numWallets; i++) {
+		if (!wallets[i].ok) {
+			failed++;
+		}
+	}
+	printf("%u wallets (%u failed), %lu requests in %lu ms\n", numWallets,
+			failed, requests, millis() - startTime);
+	for (unsigned int i = 0; i < numWallets; i++) {
+		if (wallets[i].ok) {
+			printf("Wallet %u balance: %llu, receive address: %s\n", i,
+					(unsigned long long) wallets[i].balance,
+					wallets[i].addr.c_str());
+			break;
+		}
+	}
+	delete[] threads;
+	delete[] wallets;
+	return ((failed == 0) ? 0 : 1);
+}
@@ -0,0 +1,16 @@
+# Build settings shared by the host build and by host programs using the
+# library (e.g. benchmarks). HOST_DIR is the path of this directory, relative to
+# the including Makefile; other paths are relative to directories at the same
+# depth as this one in the library tree.
+
+HOST_DIR ?= .
+SRC := ../../src
+ARDUINOJSON ?= ../../../ArduinoJson/src
+HTTPCLIENT ?= ../../../ArduinoHttpClient/src
+HOST_LIB := $(HOST_DIR)/build/libiotahost.a
+
+HOST_CPPFLAGS := -I$(HOST_DIR) -I$(SRC) -I$(ARDUINOJSON) -I$(HTTPCLIENT) \
+	-DARDUINOJSON_ENABLE_ARDUINO_STRING=1 \
+	-DARDUINOJSON_ENABLE_ARDUINO_STREAM=1 \
+	-DARDUINOJSON_ENABLE_ARDUINO_PRINT=1
+HOST_LDLIBS := -lpthread
@@ -0,0 +1,71 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Host example: prints node information and, if a seed is supplied, the
+ * wallet balance and a receive address.
+ *
+ * Usage: host_example [host [port [seed]]]
+ */
+
+#include <IotaWallet.h>
+
+#include "PosixClient.h"
+
+int main(int argc, char **argv) {
+	const char *host = ((argc > 1) ? argv[1] : "127.0.0.1");
+	int port = ((argc > 2) ? atoi(argv[2]) : 14265);
+	PosixClient networkClient;
+	IotaClient iotaClient(networkClient, host, port);
+	IotaWallet iotaWallet(iotaClient);
+	struct iotaNodeInfo nodeInfo;
+
+	if (!iotaClient.getNodeInfo(&nodeInfo)) {
+		printf("Couldn't get node info from %s:%d\n", host, port);
+		return 1;
+	}
+	printf("App Name: %s\n", nodeInfo.appName.c_str());
+	printf("App Version: %s\n", nodeInfo.appVersion.c_str());
+	printf("Latest Milestone Index: %d\n", nodeInfo.latestMilestoneIndex);
+	if (argc > 3) {
+		uint64_t balance;
+		String addr;
+
+		if (!iotaWallet.begin(argv[3])) {
+			printf("Invalid seed\n");
+			return 1;
+		}
+		if (!iotaWallet.getBalance(&balance)) {
+			printf("Couldn't get balance\n");
+			return 1;
+		}
+		printf("Balance: %llu\n", (unsigned long long) balance);
+		if (!iotaWallet.getReceiveAddress(addr)) {
+			printf("Couldn't get receive address\n");
+			return 1;
+		}
+		printf("Receive address: %s\n", addr.c_str());
+	}
+	return 0;
+}
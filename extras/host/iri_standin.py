@@ -0,0 +1,437 @@
+#!/usr/bin/env python3
+#
+# MIT License
+#
+# Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+# and Contributors
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Local stand-in for an IOTA IRI node.
+
+Implements the HTTP API commands used by IotaClient on an in-memory tangle, so
+that the library can be exercised and benchmarked on a host without network
+access. Transaction hashes are derived with Curl-P-81 as on a real node, but
+attachToTangle() does no Proof of Work; the stand-in is not meant to validate
+transactions.
+
+Node state (balances, spent addresses, transactions) can be loaded from a JSON
+file and changed at run time with the following extra commands:
+  standin.setBalances     {"balances": {"<address>": <value>, ...}}
+  standin.setSpent        {"addresses": ["<address>", ...]}
+  standin.addTransactions {"trytes": ["<trytes>", ...]}
+  standin.configure       {"latency": ms, "jitter": ms, "failRate": p,
+                           "failCommands": [...], "failMode": mode,
+                           "commands": {"<command>": {"latency": ms, ...}}}
+  standin.reset           {}
+  standin.stats           {}
+Failure modes are "error" (HTTP 500), "drop" (connection closed without
+response) and "timeout" (response delayed by "failDelay" milliseconds).
+"""
+
+import argparse
+import json
+import operator
+import random
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+TRYTES = '9ABCDEFGHIJKLMNOPQRSTUVWXYZ'
+HASH_LEN = 81
+TX_LEN = 2673
+NULL_HASH = '9' * HASH_LEN
+
+# Transaction field offsets, in trytes
+ADDRESS = 2187
+VALUE = 2268
+TIMESTAMP = 2322
+CURRENT_INDEX = 2331
+LAST_INDEX = 2340
+BUNDLE = 2349
+TRUNK = 2430
+BRANCH = 2511
+TAG = 2592
+ATTACHMENT_TIMESTAMP = 2619
+NONCE = 2646
+
+
+def trytes_to_int(trytes):
+    value = 0
+    for c in reversed(trytes):
+        t = TRYTES.index(c)
+        value = value * 27 + (t - 27 if t > 13 else t)
+    return value
+
+
+def int_to_trytes(value, length):
+    out = []
+    for _ in range(length):
+        t = value % 27
+        value //= 27
+        if t > 13:
+            t -= 27
+            value += 1
+        out.append(TRYTES[t])
+    return ''.join(out)
+
+
+# Curl-P-81, as in src/IotaCurl.cpp. Trits are kept in bytes as trit + 1, so
+# that a round is a gather of the state followed by a byte-wise table lookup:
+# state[i] depends on the trits at 364 * i and 364 * (i + 1) (mod 729).
+CURL_STATE_TRITS = 729
+CURL_ROUNDS = 81
+_curl_gather = operator.itemgetter(
+    *[364 * i % CURL_STATE_TRITS for i in range(CURL_STATE_TRITS)])
+_CURL_TRUTH_TABLE = bytes(t + 1 for t in (1, 0, -1, 2, 1, -1, 0, 2, -1, 1, 0))
+_CURL_TRUTH_TABLE += bytes(256 - len(_CURL_TRUTH_TABLE))
+
+
+def _tryte_trits(c):
+    value = trytes_to_int(c)
+    trits = []
+    for _ in range(3):
+        trit = (value + 1) % 3 - 1
+        trits.append(trit + 1)
+        value = (value - trit) // 3
+    return bytes(trits)
+
+
+_TRYTE_TRITS = {c: _tryte_trits(c) for c in TRYTES}
+_TRITS_TRYTE = {trits: c for c, trits in _TRYTE_TRITS.items()}
+
+
+def curl_transform(state):
+    for _ in range(CURL_ROUNDS):
+        first = bytes(_curl_gather(state))
+        second = first[1:] + first[:1]
+        # Byte-wise first + 4 * second, which never carries between bytes.
+        index = (int.from_bytes(first, 'little') +
+                 (int.from_bytes(second, 'little') << 2))
+        state = index.to_bytes(CURL_STATE_TRITS, 'little').translate(
+            _CURL_TRUTH_TABLE)
+    return state
+
+
+def tx_hash(trytes):
+    state = b'\x01' * CURL_STATE_TRITS
+    for i in range(0, len(trytes), HASH_LEN):
+        chunk = b''.join(map(_TRYTE_TRITS.__getitem__, trytes[i:i + HASH_LEN]))
+        state = curl_transform(chunk + state[len(chunk):])
+    return ''.join(_TRITS_TRYTE[state[i:i + 3]]
+                   for i in range(0, 3 * HASH_LEN, 3))
+
+
+class Tangle:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.reset()
+
+    def reset(self):
+        with self.lock:
+            self.balances = {}
+            self.spent = set()
+            self.txs = {}
+            self.milestone_index = 1
+
+    def load(self, state):
+        with self.lock:
+            for addr, value in state.get('balances', {}).items():
+                self.balances[addr[:HASH_LEN]] = int(value)
+            for addr in state.get('spent', []):
+                self.spent.add(addr[:HASH_LEN])
+        self.add_transactions(state.get('transactions', []), apply=False)
+
+    def add_transactions(self, trytes_list, apply):
+        hashes = []
+        with self.lock:
+            for trytes in trytes_list:
+                if len(trytes) != TX_LEN:
+                    raise ValueError('invalid transaction length')
+                h = tx_hash(trytes)
+                if apply and h not in self.txs:
+                    addr = trytes[ADDRESS:ADDRESS + HASH_LEN]
+                    value = trytes_to_int(trytes[VALUE:VALUE + 27])
+                    if value:
+                        self.balances[addr] = self.balances.get(addr, 0) + value
+                    if value < 0:
+                        self.spent.add(addr)
+                self.txs[h] = trytes
+                hashes.append(h)
+        return hashes
+
+    def find(self, field, values, width):
+        values = set(v[:width] for v in values)
+        with self.lock:
+            return [h for h, t in self.txs.items()
+                    if t[field:field + width] in values]
+
+    def tips(self):
+        with self.lock:
+            hashes = list(self.txs.keys())
+        if len(hashes) < 2:
+            return NULL_HASH, NULL_HASH
+        return random.choice(hashes), random.choice(hashes)
+
+
+class Config:
+    def __init__(self, args):
+        self.latency = args.latency
+        self.jitter = args.jitter
+        self.fail_rate = args.fail_rate
+        self.fail_commands = set(args.fail_commands.split(',')) if args.fail_commands else set()
+        self.fail_mode = args.fail_mode
+        self.fail_delay = args.fail_delay
+        self.commands = {}
+
+    def update(self, req):
+        self.latency = req.get('latency', self.latency)
+        self.jitter = req.get('jitter', self.jitter)
+        self.fail_rate = req.get('failRate', self.fail_rate)
+        if 'failCommands' in req:
+            self.fail_commands = set(req['failCommands'])
+        self.fail_mode = req.get('failMode', self.fail_mode)
+        self.fail_delay = req.get('failDelay', self.fail_delay)
+        self.commands.update(req.get('commands', {}))
+
+    def get(self, command, key, default):
+        return self.commands.get(command, {}).get(key, default)
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+    server_version = 'IRI-standin/1.0'
+
+    def log_message(self, fmt, *args):
+        if self.server.verbose:
+            super().log_message(fmt, *args)
+
+    def send_json(self, status, obj):
+        body = json.dumps(obj, separators=(',', ':')).encode()
+        self.send_response(status)
+        self.send_header('Content-Type', 'application/json')
+        self.send_header('Content-Length', str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def do_POST(self):
+        length = int(self.headers.get('Content-Length', 0))
+        try:
+            req = json.loads(self.rfile.read(length))
+            command = req['command']
+        except (ValueError, KeyError, TypeError):
+            self.send_json(400, {'error': 'Invalid request'})
+            return
+        server = self.server
+        config = server.config
+        server.count(command)
+        start = time.monotonic()
+        fail_rate = config.get(command, 'failRate', config.fail_rate)
+        if ((not config.fail_commands or command in config.fail_commands) and
+                random.random() < fail_rate):
+            server.count('failures')
+            mode = config.get(command, 'failMode', config.fail_mode)
+            if mode == 'drop':
+                self.close_connection = True
+                return
+            if mode == 'timeout':
+                time.sleep(config.fail_delay / 1000.0)
+            self.send_json(500, {'error': 'Injected failure'})
+            return
+        try:
+            status, resp = server.execute(command, req)
+        except (ValueError, KeyError, TypeError) as e:
+            status, resp = 400, {'error': str(e)}
+        latency = config.get(command, 'latency', config.latency)
+        jitter = config.get(command, 'jitter', config.jitter)
+        if latency or jitter:
+            delay = max(0.0, latency + random.uniform(-jitter, jitter)) / 1000.0
+            delay -= time.monotonic() - start
+            if delay > 0:
+                time.sleep(delay)
+        if status == 200:
+            resp['duration'] = int((time.monotonic() - start) * 1000)
+        self.send_json(status, resp)
+
+
+class StandinServer(ThreadingHTTPServer):
+    daemon_threads = True
+    # Clients with many concurrent connections (e.g. EpollLoop) connect in
+    # bursts: avoid dropping connection requests.
+    request_queue_size = 1024
+
+    def __init__(self, address, config, tangle, verbose):
+        super().__init__(address, Handler)
+        self.config = config
+        self.tangle = tangle
+        self.verbose = verbose
+        self.stats = {}
+        self.stats_lock = threading.Lock()
+
+    def count(self, key):
+        with self.stats_lock:
+            self.stats[key] = self.stats.get(key, 0) + 1
+
+    def execute(self, command, req):
+        tangle = self.tangle
+        if command == 'getNodeInfo':
+            with tangle.lock:
+                index = tangle.milestone_index
+                tips = len(tangle.txs)
+            return 200, {
+                'appName': 'IRI', 'appVersion': '1.8.6-standin',
+                'jreAvailableProcessors': 1, 'jreFreeMemory': 0,
+                'jreVersion': '1.8', 'jreMaxMemory': 0, 'jreTotalMemory': 0,
+                'latestMilestone': NULL_HASH, 'latestMilestoneIndex': index,
+                'latestSolidSubtangleMilestone': NULL_HASH,
+                'latestSolidSubtangleMilestoneIndex': index,
+                'milestoneStartIndex': 0, 'lastSnapshottedMilestoneIndex': 0,
+                'neighbors': 0, 'packetsQueueSize': 0,
+                'time': int(time.time() * 1000), 'tips': tips,
+                'transactionsToRequest': 0, 'features': ['standin'],
+                'coordinatorAddress': NULL_HASH,
+            }
+        if command == 'getBalances':
+            with tangle.lock:
+                balances = [str(tangle.balances.get(a[:HASH_LEN], 0))
+                            for a in req['addresses']]
+                index = tangle.milestone_index
+            return 200, {'balances': balances, 'references': [NULL_HASH],
+                         'milestoneIndex': index}
+        if command == 'wereAddressesSpentFrom':
+            with tangle.lock:
+                states = [a[:HASH_LEN] in tangle.spent for a in req['addresses']]
+            return 200, {'states': states}
+        if command == 'findTransactions':
+            hashes = set()
+            for key, field, width in (('addresses', ADDRESS, HASH_LEN),
+                                      ('bundles', BUNDLE, HASH_LEN),
+                                      ('tags', TAG, 27),
+                                      ('approvees', TRUNK, HASH_LEN),
+                                      ('approvees', BRANCH, HASH_LEN)):
+                if key in req:
+                    hashes.update(tangle.find(field, req[key], width))
+            return 200, {'hashes': sorted(hashes)}
+        if command == 'getTrytes':
+            with tangle.lock:
+                trytes = [tangle.txs.get(h, '9' * TX_LEN) for h in req['hashes']]
+            return 200, {'trytes': trytes}
+        if command == 'getInclusionStates':
+            with tangle.lock:
+                states = [h in tangle.txs for h in req['transactions']]
+            return 200, {'states': states}
+        if command == 'checkConsistency':
+            return 200, {'state': True}
+        if command == 'getTransactionsToApprove':
+            trunk, branch = tangle.tips()
+            return 200, {'trunkTransaction': trunk, 'branchTransaction': branch}
+        if command == 'attachToTangle':
+            return 200, {'trytes': attach(req['trytes'],
+                                          req['trunkTransaction'],
+                                          req['branchTransaction'])}
+        if command == 'storeTransactions':
+            tangle.add_transactions(req['trytes'], apply=True)
+            return 200, {}
+        if command == 'broadcastTransactions':
+            with tangle.lock:
+                tangle.milestone_index += 1
+            return 200, {}
+        if command == 'standin.setBalances':
+            tangle.load({'balances': req['balances']})
+            return 200, {}
+        if command == 'standin.setSpent':
+            tangle.load({'spent': req['addresses']})
+            return 200, {}
+        if command == 'standin.addTransactions':
+            return 200, {'hashes': tangle.add_transactions(req['trytes'], apply=False)}
+        if command == 'standin.configure':
+            self.config.update(req)
+            return 200, {}
+        if command == 'standin.reset':
+            tangle.reset()
+            with self.stats_lock:
+                self.stats = {}
+            return 200, {}
+        if command == 'standin.stats':
+            with self.stats_lock:
+                return 200, {'requests': dict(self.stats)}
+        return 400, {'error': "Command [%s] is unknown" % command}
+
+
+def attach(trytes_list, trunk, branch):
+    """Chain the transactions of a bundle as attachToTangle() would, without
+    doing Proof of Work (the nonce is left as supplied)."""
+    attached = []
+    prev = None
+    now = int(time.time() * 1000)
+    # Transactions are supplied from the last to the first of the bundle.
+    for trytes in trytes_list:
+        if len(trytes) != TX_LEN:
+            raise ValueError('invalid transaction length')
+        tx_trunk, tx_branch = (trunk, branch) if prev is None else (prev, trunk)
+        tx = (trytes[:TRUNK] + tx_trunk + tx_branch + trytes[TAG:TAG + 27] +
+              int_to_trytes(now, 9) + int_to_trytes(0, 9) +
+              int_to_trytes(3 ** 27 // 2, 9) + trytes[NONCE:])
+        prev = tx_hash(tx)
+        attached.append(tx)
+    return attached
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--host', default='127.0.0.1')
+    parser.add_argument('--port', type=int, default=14265)
+    parser.add_argument('--state', help='JSON file with initial balances, '
+                        'spent addresses and transactions')
+    parser.add_argument('--latency', type=float, default=0,
+                        help='response latency, in milliseconds')
+    parser.add_argument('--jitter', type=float, default=0,
+                        help='maximum latency variation, in milliseconds')
+    parser.add_argument('--fail-rate', type=float, default=0,
+                        help='probability of an injected failure (0 to 1)')
+    parser.add_argument('--fail-commands', default='',
+                        help='comma-separated commands subject to failures '
+                        '(default: all)')
+    parser.add_argument('--fail-mode', default='error',
+                        choices=('error', 'drop', 'timeout'))
+    parser.add_argument('--fail-delay', type=float, default=30000,
+                        help='response delay of timeout failures, in '
+                        'milliseconds')
+    parser.add_argument('--seed', type=int, help='random number generator seed')
+    parser.add_argument('-v', '--verbose', action='store_true')
+    args = parser.parse_args()
+
+    if args.seed is not None:
+        random.seed(args.seed)
+    tangle = Tangle()
+    if args.state:
+        with open(args.state) as f:
+            tangle.load(json.load(f))
+    server = StandinServer((args.host, args.port), Config(args), tangle,
+                           args.verbose)
+    print('IRI stand-in listening on %s:%d' % server.server_address[:2],
+          flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
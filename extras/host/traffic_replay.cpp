@@ -0,0 +1,159 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Traffic record and replay example: runs a wallet operation while recording
+ * the traffic with the IOTA node to a log, or replays a log (which may have
+ * been recorded on a device) without a node, so that the operation can be
+ * profiled repeatedly against the same data.
+ *
+ * Usage: traffic_replay [-t <trace>] record <log> <host> <port> <seed> <op>
+ *        traffic_replay [-t <trace>] replay|replay-fast <log> <seed> <op>
+ * where op is one of:
+ *        balance
+ *        receive
+ *        send <value> <recipient>
+ * With -t, a timeline of the operation is written to a file in Chrome trace
+ * event format.
+ */
+
+#include <IotaTrace.h>
+#include <IotaTrafficLog.h>
+#include <IotaWallet.h>
+
+#include "FileStream.h"
+#include "PosixClient.h"
+
+#define TRACE_EVENTS	65536
+
+static int runOperation(IotaWallet &iotaWallet, int argc, char **argv) {
+	if ((argc == 1) && !strcmp(argv[0], "balance")) {
+		uint64_t balance;
+
+		if (!iotaWallet.getBalance(&balance)) {
+			printf("Couldn't get balance\n");
+			return 1;
+		}
+		printf("Balance: %llu\n", (unsigned long long) balance);
+	}
+	else if ((argc == 1) && !strcmp(argv[0], "receive")) {
+		String addr;
+
+		if (!iotaWallet.getReceiveAddress(addr)) {
+			printf("Couldn't get receive address\n");
+			return 1;
+		}
+		printf("Receive address: %s\n", addr.c_str());
+	}
+	else if ((argc == 3) && !strcmp(argv[0], "send")) {
+		int ret = iotaWallet.sendTransfer(strtoull(argv[1], NULL, 10),
+				argv[2]);
+
+		if (ret != IOTA_OK) {
+			printf("Transfer failed (%d)\n", ret);
+			return 1;
+		}
+		printf("Transfer sent\n");
+	}
+	else {
+		printf("Unknown operation\n");
+		return 1;
+	}
+	return 0;
+}
+
+static struct iotaTraceEvent traceEvents[TRACE_EVENTS];
+
+int main(int argc, char **argv) {
+	const char *prog = argv[0];
+	const char *tracePath = NULL;
+	bool record;
+	int opArg;
+	FileStream log;
+	unsigned long startTime;
+	int ret;
+
+	if ((argc > 2) && !strcmp(argv[1], "-t")) {
+		tracePath = argv[2];
+		argc -= 2;
+		argv += 2;
+	}
+	record = ((argc > 1) && !strcmp(argv[1], "record"));
+	opArg = (record ? 6 : 4);
+	if ((argc <= opArg) || (!record && strcmp(argv[1], "replay") &&
+			strcmp(argv[1], "replay-fast"))) {
+		printf("Usage: %s [-t <trace>] record <log> <host> <port> <seed> "
+				"<operation>\n"
+				"       %s [-t <trace>] replay|replay-fast <log> <seed> "
+				"<operation>\n", prog, prog);
+		return 1;
+	}
+	if (!log.open(argv[2], record ? "w" : "r")) {
+		perror(argv[2]);
+		return 1;
+	}
+	PosixClient networkClient;
+	IotaClient iotaClient(networkClient, record ? argv[3] : "127.0.0.1",
+			record ? atoi(argv[4]) : 14265);
+	IotaTrafficRecorder recorder(log);
+	IotaTrafficReplayer replayer(log, strcmp(argv[1], "replay-fast"));
+	IotaWallet iotaWallet(iotaClient);
+
+	if (record) {
+		iotaClient.setRecorder(recorder);
+	}
+	else {
+		iotaClient.setReplayer(replayer);
+	}
+	if (!iotaWallet.begin(argv[opArg - 1])) {
+		printf("Invalid seed\n");
+		return 1;
+	}
+	if (tracePath) {
+		iotaTraceStart(traceEvents, TRACE_EVENTS);
+	}
+	startTime = millis();
+	ret = runOperation(iotaWallet, argc - opArg, argv + opArg);
+	printf("Elapsed time: %lu ms\n", millis() - startTime);
+	if (tracePath) {
+		FileStream trace;
+
+		iotaTraceStop();
+		if (!trace.open(tracePath, "w")) {
+			perror(tracePath);
+			return 1;
+		}
+		printf("Trace events: %u\n", iotaTraceExport(trace));
+	}
+	if (record) {
+		recorder.flush();
+		printf("Recorded requests: %u\n", recorder.getCount());
+	}
+	else {
+		printf("Replayed requests: %u (%u mismatched, %u with different "
+				"contents)\n", replayer.getCount(), replayer.getMismatches(),
+				replayer.getDivergences());
+	}
+	return ret;
+}
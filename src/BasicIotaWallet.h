@@ -0,0 +1,118 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _BASIC_IOTA_WALLET_H_
+#define _BASIC_IOTA_WALLET_H_
+
+#include "IotaHashList.h"
+#include "IotaWallet.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "iota-c-library/src/iota/bundle.h"
+#include "iota-c-library/src/iota/common.h"
+#include "iota-c-library/src/iota/transfers.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+struct iotaWalletBundle {
+	iota_wallet_bundle_description_t descr;
+	char bundleHash[NUM_HASH_TRYTES];
+	iota_wallet_tx_output_t outTx;
+	BUNDLE_CTX bundle_ctx;
+};
+
+struct iotaWalletStorage {
+	IotaHashList *scanAddrs;
+	uint64_t *scanBalances;
+	bool *scanSpent;
+	struct iotaWalletBundle *bundle;
+	iota_wallet_tx_input_t *inputTxs;
+	unsigned int maxInputs;
+	iota_wallet_tx_output_t *changeTx;
+};
+
+/** IOTA wallet with compile-time configuration and fixed-capacity storage
+      Security level, address scan batch, maximum number of transfer inputs and
+      random walk depth are template parameters; the buffers used to scan
+      addresses and to create bundles are embedded in the wallet object, so
+      its memory footprint is known at build time and transfers never fail
+      because bundle memory cannot be allocated. Transfers that would need
+      more than MaxInputs input addresses fail with IOTA_ERR_FRAGM_BALANCE.
+      @param Security  Security level, between 1 and 3
+      @param ScanBatch  Number of addresses derived and queried at once when
+             looking for balances and receive addresses
+      @param MaxInputs  Maximum number of input addresses in a transfer
+      @param Depth  Depth of the random walk used to select transactions to
+             approve
+*/
+template<unsigned int Security, unsigned int ScanBatch, unsigned int MaxInputs,
+		unsigned int Depth = IOTAWALLET_RANDOMWALK_DEPTH>
+class BasicIotaWallet : public IotaWallet {
+public:
+	static constexpr unsigned int security = Security;
+	static constexpr unsigned int scanBatch = ScanBatch;
+	static constexpr unsigned int maxInputs = MaxInputs;
+	static constexpr unsigned int depth = Depth;
+
+	static_assert(in_range(Security, MIN_SECURITY_LEVEL, MAX_SECURITY_LEVEL),
+			"invalid security level");
+	static_assert(ScanBatch > 0, "scan batch must not be empty");
+	static_assert((MaxInputs > 0) &&
+			(MaxInputs <= (MAX_BUNDLE_INDEX_SZ - 2) / Security),
+			"inputs do not fit in a bundle at this security level");
+	static_assert(Depth > 0, "invalid random walk depth");
+
+	/** Create an IOTA wallet that manages funds associated to a IOTA seed
+      @param iotaClient  IOTA client used to communicate with full IOTA node
+      @return none
+	*/
+	BasicIotaWallet(IotaClient &iotaClient) :
+			IotaWallet(iotaClient, Security, Depth, _walletStorage) {
+		_walletStorage.scanAddrs = &_scanAddrs;
+		_walletStorage.scanBalances = _scanBalances;
+		_walletStorage.scanSpent = _scanSpent;
+		_walletStorage.bundle = &_bundle;
+		_walletStorage.inputTxs = _inputTxs;
+		_walletStorage.maxInputs = MaxInputs;
+		_walletStorage.changeTx = &_changeTx;
+	}
+
+private:
+	IotaHashArray<ScanBatch> _scanAddrs;
+	uint64_t _scanBalances[ScanBatch];
+	bool _scanSpent[ScanBatch];
+	struct iotaWalletBundle _bundle;
+	iota_wallet_tx_input_t _inputTxs[MaxInputs];
+	iota_wallet_tx_output_t _changeTx;
+	struct iotaWalletStorage _walletStorage;
+};
+
+#endif
@@ -0,0 +1,228 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "IotaBalanceTracker.h"
+
+#ifdef IOTABALANCE_DEBUG
+#define DPRINTF	printf
+#else
+#define DPRINTF(fmt, ...)	do {} while(0)
+#endif
+
+IotaBalanceTracker::IotaBalanceTracker(IotaWallet &wallet,
+		IotaClient &iotaClient) : _wallet(wallet), _iotaClient(iotaClient) {
+	_nextAddrIdx = 0;
+}
+
+bool IotaBalanceTracker::rescan(unsigned int startAddrIdx) {
+	std::vector<struct iotaAddrWithBalance> list;
+	std::vector<struct iotaWatchedAddr> watched;
+
+	if (!_wallet.getAddrsWithBalance(&list, 0, NULL, 0, startAddrIdx,
+			&_nextAddrIdx)) {
+		DPRINTF("%s: couldn't get addresses with balance\n", __FUNCTION__);
+		return false;
+	}
+
+	/* Keep addresses with pending payments, spent addresses of unconfirmed
+	 * transfers, and addresses below the scan range; addresses in the scan
+	 * range are replaced with scan results. */
+	watched.swap(_watched);
+	for (auto it = watched.begin(); it != watched.end(); it++) {
+		if (it->pending || it->spent || (it->addrIdx < startAddrIdx)) {
+			if (it->addrIdx >= startAddrIdx) {
+				it->balance = 0;
+			}
+			_watched.push_back(*it);
+		}
+	}
+	for (auto it = list.cbegin(); it != list.cend(); it++) {
+		auto w = find(it->addrIdx);
+
+		if ((w != _watched.end()) && (w->addrIdx == it->addrIdx)) {
+			if (!w->spent) {
+				w->balance = it->balance;
+			}
+			w->pending = false;
+			continue;
+		}
+		auto old = watched.cbegin();
+		for (; old != watched.cend(); old++) {
+			if (old->addrIdx == it->addrIdx) {
+				break;
+			}
+		}
+		if (old != watched.cend()) {
+			struct iotaWatchedAddr elem = *old;
+
+			/* Reuse the address string, avoiding a new derivation. */
+			elem.balance = it->balance;
+			elem.pending = false;
+			_watched.insert(find(it->addrIdx), elem);
+		}
+		else {
+			add(it->addrIdx, it->balance, false);
+		}
+	}
+	DPRINTF("%s: watching %d address(es)\n", __FUNCTION__, _watched.size());
+	return true;
+}
+
+bool IotaBalanceTracker::refresh() {
+	std::vector<String> addrs;
+	std::vector<uint64_t> balances;
+
+	if (_watched.empty()) {
+		return true;
+	}
+	for (auto it = _watched.cbegin(); it != _watched.cend(); it++) {
+		addrs.push_back(it->addr);
+	}
+	if (!_iotaClient.getBalances(addrs, balances) ||
+			(balances.size() != _watched.size())) {
+		DPRINTF("%s: couldn't get balances\n", __FUNCTION__);
+		return false;
+	}
+	unsigned int i = 0;
+	for (auto it = _watched.begin(); it != _watched.end(); i++) {
+		if (it->spent) {
+			/* Input of an unconfirmed transfer: the node reports its balance
+			 * until the transfer is confirmed. */
+			if (balances[i] != 0) {
+				it++;
+				continue;
+			}
+			it->spent = false;
+		}
+		it->balance = balances[i];
+		if (it->balance != 0) {
+			it->pending = false;
+		}
+		if ((it->balance == 0) && !it->pending) {
+			it = _watched.erase(it);
+		}
+		else {
+			it++;
+		}
+	}
+	return true;
+}
+
+void IotaBalanceTracker::watch(unsigned int addrIdx) {
+	auto it = find(addrIdx);
+
+	if ((it != _watched.end()) && (it->addrIdx == addrIdx)) {
+		if (it->balance == 0) {
+			it->pending = true;
+		}
+		return;
+	}
+	add(addrIdx, 0, true);
+}
+
+void IotaBalanceTracker::unwatch(unsigned int addrIdx) {
+	auto it = find(addrIdx);
+
+	if ((it == _watched.end()) || (it->addrIdx != addrIdx)) {
+		return;
+	}
+	it->pending = false;
+	if (it->balance == 0) {
+		_watched.erase(it);
+	}
+}
+
+void IotaBalanceTracker::addTransfer(
+		const std::vector<struct iotaAddrWithBalance> &inputs,
+		unsigned int changeAddrIdx) {
+	for (auto it = inputs.cbegin(); it != inputs.cend(); it++) {
+		auto w = find(it->addrIdx);
+
+		if ((w == _watched.end()) || (w->addrIdx != it->addrIdx)) {
+			add(it->addrIdx, 0, false);
+			w = find(it->addrIdx);
+		}
+		w->balance = 0;
+		w->spent = true;
+	}
+	if (changeAddrIdx != (unsigned int)-1) {
+		watch(changeAddrIdx);
+	}
+}
+
+uint64_t IotaBalanceTracker::getBalance() {
+	uint64_t balance = 0;
+
+	for (auto it = _watched.cbegin(); it != _watched.cend(); it++) {
+		balance += it->balance;
+	}
+	return balance;
+}
+
+void IotaBalanceTracker::getAddrsWithBalance(
+		std::vector<struct iotaAddrWithBalance> &list) {
+	list.clear();
+	for (auto it = _watched.cbegin(); it != _watched.cend(); it++) {
+		if (it->balance != 0) {
+			struct iotaAddrWithBalance elem = {
+					.addrIdx = it->addrIdx,
+					.balance = it->balance,
+			};
+			list.push_back(elem);
+		}
+	}
+}
+
+const std::vector<struct iotaWatchedAddr> &
+		IotaBalanceTracker::getWatchedAddrs() {
+	return _watched;
+}
+
+unsigned int IotaBalanceTracker::getNextAddrIdx() {
+	return _nextAddrIdx;
+}
+
+std::vector<struct iotaWatchedAddr>::iterator IotaBalanceTracker::find(
+		unsigned int addrIdx) {
+	auto it = _watched.begin();
+
+	/* Returns the first element with index not lower than addrIdx. */
+	while ((it != _watched.end()) && (it->addrIdx < addrIdx)) {
+		it++;
+	}
+	return it;
+}
+
+void IotaBalanceTracker::add(unsigned int addrIdx, uint64_t balance,
+		bool pending) {
+	struct iotaWatchedAddr elem;
+
+	elem.addrIdx = addrIdx;
+	elem.addr = _wallet.getAddress(addrIdx, false);
+	elem.balance = balance;
+	elem.pending = pending;
+	elem.spent = false;
+	_watched.insert(find(addrIdx), elem);
+}
@@ -0,0 +1,146 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _IOTA_BALANCE_TRACKER_H_
+#define _IOTA_BALANCE_TRACKER_H_
+
+#include <Arduino.h>
+#ifdef min
+#undef min
+#endif
+#ifdef max
+#undef max
+#endif
+#include <vector>
+
+#include "IotaClient.h"
+#include "IotaWallet.h"
+
+struct iotaWatchedAddr {
+	unsigned int addrIdx;
+	String addr;
+	uint64_t balance;
+	bool pending;
+	bool spent;
+};
+
+class IotaBalanceTracker {
+public:
+
+	/** Create a tracker of wallet balance
+      The tracker keeps a watched set of wallet addresses, made of addresses
+      with positive balance and addresses for which an incoming payment is
+      expected, so that the wallet balance can be updated with a single
+      request to the IOTA full node instead of scanning all addresses.
+      @param wallet  IOTA wallet whose addresses are tracked
+      @param iotaClient  IOTA client used to communicate with full IOTA node
+      @return none
+	*/
+	IotaBalanceTracker(IotaWallet &wallet, IotaClient &iotaClient);
+
+	/** Rebuild the watched set by scanning wallet addresses
+      This method retrieves all addresses with positive balance via the
+      getAddrsWithBalance() method of the wallet; addresses with pending
+      incoming payments are kept in the watched set. It should be called
+      when the tracker is first used, and whenever funds may have been moved
+      without the tracker knowing (e.g. by another wallet instance with the
+      same seed).
+      @param startAddrIdx  Starting index of the scan
+      @return true if communication with the IOTA full node is successful, false
+              otherwise
+	*/
+	bool rescan(unsigned int startAddrIdx = 0);
+
+	/** Update balance of watched addresses
+      This method retrieves the balance of all watched addresses in a single
+      request; addresses whose balance goes to zero are removed from the
+      watched set, unless an incoming payment is still expected on them.
+      @return true if communication with the IOTA full node is successful, false
+              otherwise
+	*/
+	bool refresh();
+
+	/** Add an address with a pending incoming payment to the watched set
+      The address is watched until a positive balance is found on it, or until
+      unwatch() is called.
+      @param addrIdx  Index of wallet address
+      @return none
+	*/
+	void watch(unsigned int addrIdx);
+
+	/** Stop expecting an incoming payment on an address
+      If the address has a positive balance, it is kept in the watched set.
+      @param addrIdx  Index of wallet address
+      @return none
+	*/
+	void unwatch(unsigned int addrIdx);
+
+	/** Update watched set after a transfer sent by the wallet
+      Input addresses are marked as spent: their balance is counted as zero
+      from now on, and they are kept in the watched set until the IOTA node
+      reports a zero balance for them, i.e. until the transfer is confirmed.
+      The change address (if any) is added to the watched set, and its balance
+      is counted when the transfer is confirmed.
+      @param inputs  Input addresses of the transfer
+      @param changeAddrIdx  Index of the change address, or -1 if the transfer
+             has no change
+      @return none
+	*/
+	void addTransfer(const std::vector<struct iotaAddrWithBalance> &inputs,
+			unsigned int changeAddrIdx);
+
+	/** Retrieve total balance of watched addresses
+      @return balance as of the last call to rescan() or refresh()
+	*/
+	uint64_t getBalance();
+
+	/** Retrieve addresses with positive balance
+      @param list  Reference to list to be filled with watched addresses with
+             positive balance, in ascending index order
+      @return none
+	*/
+	void getAddrsWithBalance(std::vector<struct iotaAddrWithBalance> &list);
+
+	/** Retrieve watched set
+      @return list of watched addresses, in ascending index order
+	*/
+	const std::vector<struct iotaWatchedAddr> &getWatchedAddrs();
+
+	/** Retrieve index following the last scanned address
+      @return index of the first address not scanned by the last call to
+              rescan()
+	*/
+	unsigned int getNextAddrIdx();
+
+private:
+	std::vector<struct iotaWatchedAddr>::iterator find(unsigned int addrIdx);
+	void add(unsigned int addrIdx, uint64_t balance, bool pending);
+	IotaWallet &_wallet;
+	IotaClient &_iotaClient;
+	std::vector<struct iotaWatchedAddr> _watched;
+	unsigned int _nextAddrIdx;
+};
+
+#endif
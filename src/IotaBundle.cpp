@@ -0,0 +1,222 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "IotaBundle.h"
+#include "IotaClient.h"
+#include "IotaTrace.h"
+#include "IotaTrytes.h"
+#include "IotaWorkers.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "iota-c-library/src/iota/common.h"
+#include "iota-c-library/src/iota/conversion.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+#define IOTABUNDLE_SIG_CHUNKS	(IOTA_TX_SIGNATURE_TRYTES / NUM_HASH_TRYTES)
+
+static char tryteToChar(int tryte) {
+	if (tryte < 0) {
+		tryte += 27;
+	}
+	return ((tryte == 0) ? '9' : ('A' + tryte - 1));
+}
+
+static int charToTryte(char c) {
+	int tryte = ((c == '9') ? 0 : (c - 'A' + 1));
+
+	return ((tryte > 13) ? (tryte - 27) : tryte);
+}
+
+static void incrementChars(char *chars, unsigned int numChars,
+		unsigned int increment) {
+	while (increment--) {
+		for (unsigned int i = 0; i < numChars; i++) {
+			int tryte = charToTryte(chars[i]);
+
+			if (tryte < 13) {
+				chars[i] = tryteToChar(tryte + 1);
+				break;
+			}
+			chars[i] = tryteToChar(-13);
+		}
+	}
+}
+
+static void iotaBundleSignWorker(void *arg, unsigned int input) {
+	((IotaBundle *) arg)->signInput(input);
+}
+
+IotaBundle::IotaBundle(const unsigned char *seedBytes, unsigned int security)
+: _seedBytes(seedBytes), _security(security) {
+}
+
+bool IotaBundle::create(const iota_wallet_bundle_description_t *descr) {
+	unsigned int numTxs = descr->output_txs_length +
+			descr->input_txs_length * _security + (descr->change_tx ? 1 : 0);
+	char nullTag[NUM_TAG_TRYTES];
+	BUNDLE_CTX *ctx;
+	unsigned int tagIncrement;
+	unsigned int txIdx = 0;
+
+	if ((numTxs == 0) || (numTxs > MAX_BUNDLE_INDEX_SZ)) {
+		return false;
+	}
+	_txs.clear();
+	_inputs.clear();
+	_txs.reserve(numTxs);
+	for (unsigned int i = 0; i < numTxs; i++) {
+		_txs.push_back(String());
+		String &tx = _txs[i];
+
+		if (tx.reserve(NUM_TRANSACTION_TRYTES) == 0) {
+			_txs.clear();
+			return false;
+		}
+		for (unsigned int j = 0; j < NUM_TRANSACTION_TRYTES; j++) {
+			tx += '9';
+		}
+	}
+	ctx = (BUNDLE_CTX *) malloc(sizeof(*ctx));
+	if (!ctx) {
+		_txs.clear();
+		return false;
+	}
+	bundle_initialize(ctx, numTxs - 1);
+	memset(nullTag, '9', sizeof(nullTag));
+	for (unsigned int i = 0; i < descr->output_txs_length; i++) {
+		iota_wallet_tx_output_t *out = &descr->output_txs[i];
+
+		setTx(ctx, txIdx++, out->address, out->value, out->tag,
+				descr->timestamp, numTxs - 1);
+	}
+	for (unsigned int i = 0; i < descr->input_txs_length; i++) {
+		iota_wallet_tx_input_t *in = &descr->input_txs[i];
+		struct iotaBundleInput input = {
+				.keyIndex = in->key_index,
+				.firstTx = txIdx,
+		};
+
+		_inputs.push_back(input);
+		for (unsigned int j = 0; j < _security; j++) {
+			setTx(ctx, txIdx++, in->address, (j == 0) ? -(int64_t)in->value : 0,
+					nullTag, descr->timestamp, numTxs - 1);
+		}
+	}
+	if (descr->change_tx) {
+		setTx(ctx, txIdx++, descr->change_tx->address, descr->change_tx->value,
+				descr->change_tx->tag, descr->timestamp, numTxs - 1);
+	}
+
+	/* The obsolete tag of the first transaction may have been incremented to
+	 * obtain a secure bundle hash. */
+	tagIncrement = bundle_finalize(ctx);
+	incrementChars((char *) _txs[0].c_str() + IOTA_TX_OBSOLETE_TAG_OFFSET,
+			NUM_TAG_TRYTES, tagIncrement);
+	bytes_to_chars(bundle_get_hash(ctx), _hash, NUM_HASH_BYTES);
+	bundle_get_normalized_hash(ctx, _normalizedHash);
+	free(ctx);
+	for (unsigned int i = 0; i < numTxs; i++) {
+		memcpy((char *) _txs[i].c_str() + IOTA_TX_BUNDLE_OFFSET, _hash,
+				NUM_HASH_TRYTES);
+	}
+	return true;
+}
+
+unsigned int IotaBundle::getNumInputs() {
+	return _inputs.size();
+}
+
+unsigned int IotaBundle::getSignSteps() {
+	return _security * (IOTABUNDLE_SIG_CHUNKS / SIGNATURE_FRAGMENT_SZ);
+}
+
+void IotaBundle::beginSignInput(unsigned int input, SIGNING_CTX *ctx) {
+	signing_initialize(ctx, _seedBytes, _inputs[input].keyIndex, _security,
+			_normalizedHash);
+}
+
+void IotaBundle::signInputStep(unsigned int input, unsigned int step,
+		SIGNING_CTX *ctx) {
+	unsigned char sigBytes[SIGNATURE_FRAGMENT_SZ * NUM_HASH_BYTES];
+	unsigned int stepsPerTx = IOTABUNDLE_SIG_CHUNKS / SIGNATURE_FRAGMENT_SZ;
+	String &tx = _txs[_inputs[input].firstTx + step / stepsPerTx];
+	char *sig = (char *) tx.c_str() +
+			(step % stepsPerTx) * SIGNATURE_FRAGMENT_SZ * NUM_HASH_TRYTES;
+
+	signing_next_fragment(ctx, sigBytes);
+	for (unsigned int i = 0; i < SIGNATURE_FRAGMENT_SZ; i++) {
+		bytes_to_chars(sigBytes + i * NUM_HASH_BYTES, sig, NUM_HASH_BYTES);
+		sig += NUM_HASH_TRYTES;
+	}
+}
+
+void IotaBundle::signInput(unsigned int input) {
+	IOTA_TRACE_SCOPE("signInput");
+	SIGNING_CTX ctx;
+
+	beginSignInput(input, &ctx);
+	for (unsigned int step = 0; step < getSignSteps(); step++) {
+		signInputStep(input, step, &ctx);
+	}
+}
+
+void IotaBundle::signInputs(unsigned int workers) {
+	iotaParallelFor(_inputs.size(), workers, iotaBundleSignWorker, this);
+}
+
+const char *IotaBundle::getHash() {
+	return _hash;
+}
+
+void IotaBundle::getTransactions(std::vector<String> &txs) {
+	txs.clear();
+	for (unsigned int i = _txs.size(); i-- > 0; ) {
+		txs.push_back(std::move(_txs[i]));
+	}
+	_txs.clear();
+}
+
+void IotaBundle::setTx(BUNDLE_CTX *ctx, unsigned int index, const char *addr,
+		int64_t value, const char *tag, uint32_t timestamp,
+		unsigned int lastIndex) {
+	char *tx = (char *) _txs[index].c_str();
+
+	memcpy(tx + IOTA_TX_ADDRESS_OFFSET, addr, NUM_HASH_TRYTES);
+	iotaInt64ToTrytes(value, tx + IOTA_TX_VALUE_OFFSET, 27);
+	memcpy(tx + IOTA_TX_OBSOLETE_TAG_OFFSET, tag, NUM_TAG_TRYTES);
+	iotaInt64ToTrytes(timestamp, tx + IOTA_TX_TIMESTAMP_OFFSET, 9);
+	iotaInt64ToTrytes(index, tx + IOTA_TX_CURRENT_INDEX_OFFSET, 9);
+	iotaInt64ToTrytes(lastIndex, tx + IOTA_TX_LAST_INDEX_OFFSET, 9);
+	memcpy(tx + IOTA_TX_TAG_OFFSET, tag, NUM_TAG_TRYTES);
+	bundle_set_external_address(ctx, addr);
+	bundle_add_tx(ctx, value, tag, timestamp);
+}
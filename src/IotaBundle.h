@@ -0,0 +1,145 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _IOTA_BUNDLE_H_
+#define _IOTA_BUNDLE_H_
+
+#include <Arduino.h>
+#ifdef min
+#undef min
+#endif
+#ifdef max
+#undef max
+#endif
+#include <vector>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "iota-c-library/src/iota/bundle.h"
+#include "iota-c-library/src/iota/signing.h"
+#include "iota-c-library/src/iota/transfers.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+class IotaBundle {
+public:
+
+	/** Create a bundle whose inputs are signed with a given seed
+      @param seedBytes  Seed, in the 48-byte format used by the IOTA library
+      @param security  Security level of the input addresses
+      @return none
+	*/
+	IotaBundle(const unsigned char *seedBytes, unsigned int security);
+
+	/** Lay out the transactions of the bundle and compute the bundle hash
+      After this method returns successfully, all transaction fields except
+      input signatures and Proof of Work data are filled in.
+      @param descr  Bundle description (outputs, inputs, optional change and
+             timestamp)
+      @return true if successful, false if the bundle has too many
+              transactions or memory allocation failed
+	*/
+	bool create(const iota_wallet_bundle_description_t *descr);
+
+	/** Retrieve the number of inputs of the bundle
+      @return number of inputs to be signed
+	*/
+	unsigned int getNumInputs();
+
+	/** Sign an input of the bundle
+      The signature fragments are written directly in the signature field of
+      the transactions belonging to the input; inputs can be signed in any
+      order, and different inputs can be signed concurrently.
+      @param input  Input index (between 0 and getNumInputs() - 1)
+      @return none
+	*/
+	void signInput(unsigned int input);
+
+	/** Retrieve the number of signing steps needed for each input
+      @return number of times signInputStep() must be called to sign an input
+	*/
+	unsigned int getSignSteps();
+
+	/** Start signing an input of the bundle incrementally
+      @param input  Input index (between 0 and getNumInputs() - 1)
+      @param ctx  Signing context to be used in subsequent calls to
+             signInputStep() for this input
+      @return none
+	*/
+	void beginSignInput(unsigned int input, SIGNING_CTX *ctx);
+
+	/** Compute a portion of the signature of an input
+      Steps must be executed in order, from 0 to getSignSteps() - 1.
+      @param input  Input index (between 0 and getNumInputs() - 1)
+      @param step  Step index
+      @param ctx  Signing context initialized with beginSignInput()
+      @return none
+	*/
+	void signInputStep(unsigned int input, unsigned int step,
+			SIGNING_CTX *ctx);
+
+	/** Sign all inputs of the bundle
+      @param workers  Maximum number of inputs signed in parallel; on
+             single-core platforms inputs are always signed serially
+      @return none
+	*/
+	void signInputs(unsigned int workers);
+
+	/** Retrieve the bundle hash
+      @return pointer to the 81-character bundle hash (not null-terminated)
+	*/
+	const char *getHash();
+
+	/** Retrieve the bundle transactions
+      The transaction trytes are moved out of this object.
+      @param txs  List to be filled with the bundle transactions, in the order
+             expected by the attachToTangle() method of the IOTA client (i.e.
+             starting from the last transaction of the bundle)
+      @return none
+	*/
+	void getTransactions(std::vector<String> &txs);
+
+private:
+	struct iotaBundleInput {
+		uint32_t keyIndex;
+		unsigned int firstTx;
+	};
+	void setTx(BUNDLE_CTX *ctx, unsigned int index, const char *addr,
+			int64_t value, const char *tag, uint32_t timestamp,
+			unsigned int lastIndex);
+	const unsigned char *_seedBytes;
+	unsigned int _security;
+	std::vector<String> _txs;
+	std::vector<struct iotaBundleInput> _inputs;
+	tryte_t _normalizedHash[NUM_HASH_TRYTES];
+	char _hash[NUM_HASH_TRYTES];
+};
+
+#endif
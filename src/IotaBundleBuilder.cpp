@@ -0,0 +1,187 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <time.h>
+#include <new>
+
+#include "IotaBundleBuilder.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "iota-c-library/src/iota/addresses.h"
+#include "iota-c-library/src/iota/conversion.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+IotaBundleBuilder::IotaBundleBuilder() {
+	_bundle = NULL;
+	_state = IOTABUILDER_IDLE;
+	_updateSpentAddr = false;
+}
+
+IotaBundleBuilder::~IotaBundleBuilder() {
+	reset();
+}
+
+int IotaBundleBuilder::step(unsigned long budgetMicros) {
+	unsigned long startTime = micros();
+
+	if (_state == IOTABUILDER_IDLE) {
+		return IOTA_ERR_NOT_READY;
+	}
+	while ((_state != IOTABUILDER_DONE) && (_state != IOTABUILDER_ERROR)) {
+		int state = _state;
+		unsigned long unitStart = micros();
+
+		runUnit();
+		unsigned long unitTime = micros() - unitStart;
+		if (unitTime > _unitTime[state]) {
+			_unitTime[state] = unitTime;
+		}
+		_doneUnits++;
+		if ((_state == IOTABUILDER_DONE) || (_state == IOTABUILDER_ERROR)) {
+			break;
+		}
+		if (micros() - startTime + _unitTime[_state] > budgetMicros) {
+			break;
+		}
+	}
+	if (_state == IOTABUILDER_ERROR) {
+		return IOTA_ERR_NO_MEM;
+	}
+	return (_doneUnits * 100) / _totalUnits;
+}
+
+int IotaBundleBuilder::getState() {
+	return _state;
+}
+
+bool IotaBundleBuilder::isDone() {
+	return (_state == IOTABUILDER_DONE);
+}
+
+void IotaBundleBuilder::reset() {
+	delete _bundle;
+	_bundle = NULL;
+	_txInputs.clear();
+	_inputs.clear();
+	_state = IOTABUILDER_IDLE;
+}
+
+bool IotaBundleBuilder::begin(const unsigned char *seedBytes,
+		unsigned int security, uint64_t value, const char *recipient,
+		const char *tag, const std::vector<struct iotaAddrWithBalance> &inputs,
+		const char *changeAddr, uint64_t changeValue) {
+	reset();
+	_bundle = new (std::nothrow) IotaBundle(seedBytes, security);
+	if (!_bundle) {
+		return false;
+	}
+	_seedBytes = seedBytes;
+	_security = security;
+	memset(&_descr, 0, sizeof(_descr));
+	memcpy(_output.address, recipient, sizeof(_output.address));
+	_output.value = (int64_t)value;
+	memset(_output.tag, '9', sizeof(_output.tag));
+	memcpy(_output.tag, tag, strlen(tag));
+	if (changeAddr) {
+		memcpy(_change.address, changeAddr, sizeof(_change.address));
+		_change.value = (int64_t)changeValue;
+		memcpy(_change.tag, _output.tag, sizeof(_change.tag));
+	}
+	_descr.output_txs = &_output;
+	_descr.output_txs_length = 1;
+	_descr.change_tx = (changeAddr ? &_change : NULL);
+	_descr.security = security;
+	_descr.timestamp = time(NULL);
+	_inputs = inputs;
+	_txInputs.resize(inputs.size());
+	for (unsigned int i = 0; i < inputs.size(); i++) {
+		_txInputs[i].key_index = inputs[i].addrIdx;
+		_txInputs[i].value = inputs[i].balance;
+	}
+	_unit = _signStep = 0;
+	_doneUnits = 0;
+	_totalUnits = inputs.size() * (1 + security *
+			(2187 / NUM_HASH_TRYTES / SIGNATURE_FRAGMENT_SZ)) + 1;
+	memset(_unitTime, 0, sizeof(_unitTime));
+	_state = (inputs.size() ? IOTABUILDER_DERIVING : IOTABUILDER_ASSEMBLING);
+	return true;
+}
+
+bool IotaBundleBuilder::getTransactions(std::vector<String> &txs) {
+	if (_state != IOTABUILDER_DONE) {
+		return false;
+	}
+	_bundle->getTransactions(txs);
+	delete _bundle;
+	_bundle = NULL;
+	_state = IOTABUILDER_IDLE;
+	return true;
+}
+
+void IotaBundleBuilder::runUnit() {
+	switch (_state) {
+	case IOTABUILDER_DERIVING: {
+		unsigned char addrBytes[NUM_HASH_BYTES];
+
+		get_public_addr(_seedBytes, _txInputs[_unit].key_index, _security,
+				addrBytes);
+		bytes_to_chars(addrBytes, _txInputs[_unit].address, NUM_HASH_BYTES);
+		if (++_unit == _txInputs.size()) {
+			_state = IOTABUILDER_ASSEMBLING;
+		}
+		break;
+	}
+	case IOTABUILDER_ASSEMBLING:
+		_descr.input_txs = (_txInputs.size() ? &_txInputs[0] : NULL);
+		_descr.input_txs_length = _txInputs.size();
+		if (!_bundle->create(&_descr)) {
+			_state = IOTABUILDER_ERROR;
+			break;
+		}
+		_unit = _signStep = 0;
+		_state = (_bundle->getNumInputs() ? IOTABUILDER_SIGNING :
+				IOTABUILDER_DONE);
+		break;
+	case IOTABUILDER_SIGNING:
+		if (_signStep == 0) {
+			_bundle->beginSignInput(_unit, &_signCtx);
+		}
+		_bundle->signInputStep(_unit, _signStep, &_signCtx);
+		if (++_signStep == _bundle->getSignSteps()) {
+			_signStep = 0;
+			if (++_unit == _bundle->getNumInputs()) {
+				_state = IOTABUILDER_DONE;
+			}
+		}
+		break;
+	}
+}
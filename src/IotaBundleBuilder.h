@@ -0,0 +1,118 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _IOTA_BUNDLE_BUILDER_H_
+#define _IOTA_BUNDLE_BUILDER_H_
+
+#include <Arduino.h>
+#ifdef min
+#undef min
+#endif
+#ifdef max
+#undef max
+#endif
+#include <vector>
+
+#include "IotaBundle.h"
+#include "IotaWallet.h"
+
+#define IOTABUILDER_IDLE		0
+#define IOTABUILDER_DERIVING	1
+#define IOTABUILDER_ASSEMBLING	2
+#define IOTABUILDER_SIGNING		3
+#define IOTABUILDER_DONE		4
+#define IOTABUILDER_ERROR		5
+
+class IotaBundleBuilder {
+public:
+
+	/** Create a resumable bundle builder
+      A builder is initialized with the prepareTransfer() method of an IOTA
+      wallet, then creates the bundle in time-bounded steps via repeated calls
+      to step(), so that the CPU-intensive work of creating a bundle can be
+      interleaved with time-critical tasks without using threads; the bundle is
+      then sent with the completeTransfer() method of the IOTA wallet.
+      @return none
+	*/
+	IotaBundleBuilder();
+
+	~IotaBundleBuilder();
+
+	/** Do a bounded amount of work on the bundle
+      This method executes units of work (derivation of an input address,
+      assembly of the bundle, computation of a portion of an input signature)
+      until the time budget is used up. A unit of work is not started if, based
+      on the duration of previous units of the same kind, it is not expected to
+      complete within the budget; at least one unit of work is executed in
+      each call, so that progress is always made.
+      @param budgetMicros  Time budget, in microseconds
+      @return percentage of work done (100 when the bundle is complete), or
+              IOTA_ERR_NO_MEM if the bundle could not be created, or
+              IOTA_ERR_NOT_READY if the builder has not been initialized
+	*/
+	int step(unsigned long budgetMicros);
+
+	/** Retrieve builder state
+      @return one of the IOTABUILDER_* values
+	*/
+	int getState();
+
+	/** Check whether the bundle is complete
+      @return true if the bundle has been completely built, false otherwise
+	*/
+	bool isDone();
+
+	/** Reset the builder
+      Any work done is discarded, and memory allocated for the bundle is
+      released.
+      @return none
+	*/
+	void reset();
+
+private:
+	friend class IotaWallet;
+	bool begin(const unsigned char *seedBytes, unsigned int security,
+			uint64_t value, const char *recipient, const char *tag,
+			const std::vector<struct iotaAddrWithBalance> &inputs,
+			const char *changeAddr, uint64_t changeValue);
+	bool getTransactions(std::vector<String> &txs);
+	void runUnit();
+	const unsigned char *_seedBytes;
+	unsigned int _security;
+	int _state;
+	IotaBundle *_bundle;
+	iota_wallet_bundle_description_t _descr;
+	iota_wallet_tx_output_t _output, _change;
+	std::vector<iota_wallet_tx_input_t> _txInputs;
+	std::vector<struct iotaAddrWithBalance> _inputs;
+	SIGNING_CTX _signCtx;
+	unsigned int _unit, _signStep;
+	unsigned int _doneUnits, _totalUnits;
+	unsigned long _unitTime[IOTABUILDER_ERROR];
+	bool _updateSpentAddr;
+	unsigned int _changeAddrIdx;
+};
+
+#endif
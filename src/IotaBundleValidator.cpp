@@ -0,0 +1,246 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "IotaBundleValidator.h"
+#include "IotaKerl.h"
+#include "IotaTrytes.h"
+#include "IotaWorkers.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "iota-c-library/src/iota/common.h"
+#include "iota-c-library/src/iota/conversion.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+#define IOTABUNDLE_ESSENCE_TRYTES	162
+/* Offset of a transaction field within the essence, which starts at the
+ * address. */
+#define IOTABUNDLE_ESSENCE_FIELD(offset)	((offset) - IOTA_TX_ADDRESS_OFFSET)
+#define IOTABUNDLE_SIG_CHUNKS		(IOTA_TX_SIGNATURE_TRYTES / NUM_HASH_TRYTES)
+#define IOTABUNDLE_MAX_SECURITY		3
+#define IOTABUNDLE_MAX_SUPPLY		2779530283277761LL
+
+struct iotaTxView {
+	const char *signature;
+	const char *essence;
+	const char *bundle;
+	int64_t value;
+	int64_t currentIndex;
+	int64_t lastIndex;
+};
+
+struct iotaValidateCtx {
+	const std::vector<String> *bundles;
+	std::vector<int> *results;
+};
+
+static int charToTryte(char c) {
+	int tryte = ((c == '9') ? 0 : (c - 'A' + 1));
+
+	return ((tryte > 13) ? (tryte - 27) : tryte);
+}
+
+static void normalizeHash(const char *hash, int *normalized) {
+	for (int i = 0; i < 3; i++) {
+		int *fragment = normalized + i * 27;
+		int sum = 0;
+
+		for (int j = 0; j < 27; j++) {
+			fragment[j] = charToTryte(hash[i * 27 + j]);
+			sum += fragment[j];
+		}
+		for (int j = 0; (sum > 0) && (j < 27); j++) {
+			while ((sum > 0) && (fragment[j] > -13)) {
+				fragment[j]--;
+				sum--;
+			}
+		}
+		for (int j = 0; (sum < 0) && (j < 27); j++) {
+			while ((sum < 0) && (fragment[j] < 13)) {
+				fragment[j]++;
+				sum++;
+			}
+		}
+	}
+}
+
+static bool verifySignature(const struct iotaTxView *txs,
+		unsigned int numFragments, const int *normalized) {
+	IotaKerl addrKerl;
+	IotaKerl digestKerl;
+	uint32_t words[IOTAKERL_WORDS];
+	char addr[NUM_HASH_TRYTES];
+
+	for (unsigned int f = 0; f < numFragments; f++) {
+		const int *fragment = normalized + (f % 3) * 27;
+
+		/* Signature chunks are hashed in binary form: conversion to trytes
+		 * is needed only for the resulting address. */
+		for (int c = 0; c < IOTABUNDLE_SIG_CHUNKS; c++) {
+			iotaKerlTrytesToWords(txs[f].signature + c * NUM_HASH_TRYTES,
+					words);
+			IotaKerl::hashWords(words, 13 + fragment[c]);
+			digestKerl.absorbWords(words);
+		}
+		digestKerl.squeezeWords(words);
+		addrKerl.absorbWords(words);
+	}
+	addrKerl.squeeze(addr);
+	return !memcmp(addr, txs[0].essence, NUM_HASH_TRYTES);
+}
+
+static int validate(const struct iotaTxView *txs, unsigned int numTxs) {
+	int64_t sum = 0;
+	IotaKerl kerl;
+	char hash[NUM_HASH_TRYTES];
+	int normalized[NUM_HASH_TRYTES];
+
+	if (numTxs == 0) {
+		return IOTABUNDLE_ERR_STRUCTURE;
+	}
+	for (unsigned int i = 0; i < numTxs; i++) {
+		if ((txs[i].currentIndex != i) ||
+				(txs[i].lastIndex != numTxs - 1) ||
+				memcmp(txs[i].bundle, txs[0].bundle, NUM_HASH_TRYTES)) {
+			return IOTABUNDLE_ERR_STRUCTURE;
+		}
+		if ((txs[i].value > IOTABUNDLE_MAX_SUPPLY) ||
+				(txs[i].value < -IOTABUNDLE_MAX_SUPPLY)) {
+			return IOTABUNDLE_ERR_VALUE;
+		}
+		sum += txs[i].value;
+		kerl.absorb(txs[i].essence, IOTABUNDLE_ESSENCE_TRYTES);
+	}
+	if (sum != 0) {
+		return IOTABUNDLE_ERR_VALUE;
+	}
+	kerl.squeeze(hash);
+	if (memcmp(hash, txs[0].bundle, NUM_HASH_TRYTES)) {
+		return IOTABUNDLE_ERR_HASH;
+	}
+	normalizeHash(hash, normalized);
+	for (unsigned int i = 0; i < numTxs; ) {
+		unsigned int numFragments = 1;
+
+		if (txs[i].value >= 0) {
+			i++;
+			continue;
+		}
+		while ((i + numFragments < numTxs) &&
+				(numFragments < IOTABUNDLE_MAX_SECURITY) &&
+				(txs[i + numFragments].value == 0) &&
+				!memcmp(txs[i + numFragments].essence, txs[i].essence,
+				NUM_HASH_TRYTES)) {
+			numFragments++;
+		}
+		if (!verifySignature(txs + i, numFragments, normalized)) {
+			return IOTABUNDLE_ERR_SIGNATURE;
+		}
+		i += numFragments;
+	}
+	return IOTABUNDLE_VALID;
+}
+
+static void iotaBundleValidateWorker(void *arg, unsigned int idx) {
+	struct iotaValidateCtx *ctx = (struct iotaValidateCtx *) arg;
+	const String &bundle = (*ctx->bundles)[idx];
+
+	(*ctx->results)[idx] = ((bundle.length() % NUM_TRANSACTION_TRYTES) ?
+			IOTABUNDLE_ERR_STRUCTURE :
+			iotaBundleValidate(bundle.c_str(),
+			bundle.length() / NUM_TRANSACTION_TRYTES));
+}
+
+int iotaBundleValidate(const char *bundle, unsigned int numTxs) {
+	std::vector<struct iotaTxView> txs(numTxs);
+
+	if (!iotaTrytesValidate(bundle, numTxs * NUM_TRANSACTION_TRYTES)) {
+		return IOTABUNDLE_ERR_STRUCTURE;
+	}
+	for (unsigned int i = 0; i < numTxs; i++) {
+		const char *tx = bundle + i * NUM_TRANSACTION_TRYTES;
+
+		txs[i].signature = tx;
+		txs[i].essence = tx + IOTA_TX_ADDRESS_OFFSET;
+		txs[i].bundle = tx + IOTA_TX_BUNDLE_OFFSET;
+		txs[i].value = iotaTrytesToInt64(tx + IOTA_TX_VALUE_OFFSET, 27);
+		txs[i].currentIndex = iotaTrytesToInt64(tx +
+				IOTA_TX_CURRENT_INDEX_OFFSET, 9);
+		txs[i].lastIndex = iotaTrytesToInt64(tx + IOTA_TX_LAST_INDEX_OFFSET,
+				9);
+	}
+	return validate(txs.data(), numTxs);
+}
+
+int iotaBundleValidate(const std::vector<struct IotaTx> &txs) {
+	std::vector<struct iotaTxView> views(txs.size());
+	std::vector<char> essences(txs.size() * IOTABUNDLE_ESSENCE_TRYTES);
+
+	for (unsigned int i = 0; i < txs.size(); i++) {
+		const struct IotaTx &tx = txs[i];
+		char *essence = &essences[i * IOTABUNDLE_ESSENCE_TRYTES];
+
+		if ((tx.signatureMessage.length() != IOTA_TX_SIGNATURE_TRYTES) ||
+				(tx.address.length() < NUM_HASH_TRYTES) ||
+				(tx.obsoleteTag.length() != NUM_TAG_TRYTES) ||
+				(tx.bundle.length() != NUM_HASH_TRYTES)) {
+			return IOTABUNDLE_ERR_STRUCTURE;
+		}
+		memcpy(essence, tx.address.c_str(), NUM_HASH_TRYTES);
+		iotaInt64ToTrytes(tx.value, essence +
+				IOTABUNDLE_ESSENCE_FIELD(IOTA_TX_VALUE_OFFSET), 27);
+		memcpy(essence + IOTABUNDLE_ESSENCE_FIELD(IOTA_TX_OBSOLETE_TAG_OFFSET),
+				tx.obsoleteTag.c_str(), NUM_TAG_TRYTES);
+		iotaInt64ToTrytes(tx.timestamp, essence +
+				IOTABUNDLE_ESSENCE_FIELD(IOTA_TX_TIMESTAMP_OFFSET), 9);
+		iotaInt64ToTrytes(tx.currentIndex, essence +
+				IOTABUNDLE_ESSENCE_FIELD(IOTA_TX_CURRENT_INDEX_OFFSET), 9);
+		iotaInt64ToTrytes(tx.lastIndex, essence +
+				IOTABUNDLE_ESSENCE_FIELD(IOTA_TX_LAST_INDEX_OFFSET), 9);
+		views[i].signature = tx.signatureMessage.c_str();
+		views[i].essence = essence;
+		views[i].bundle = tx.bundle.c_str();
+		views[i].value = tx.value;
+		views[i].currentIndex = tx.currentIndex;
+		views[i].lastIndex = tx.lastIndex;
+	}
+	return validate(views.data(), views.size());
+}
+
+void iotaBundleValidate(const std::vector<String> &bundles,
+		std::vector<int> &results, unsigned int workers) {
+	struct iotaValidateCtx ctx;
+
+	results.assign(bundles.size(), IOTABUNDLE_VALID);
+	ctx.bundles = &bundles;
+	ctx.results = &results;
+	iotaParallelFor(bundles.size(), workers, iotaBundleValidateWorker, &ctx);
+}
@@ -0,0 +1,82 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _IOTA_BUNDLE_VALIDATOR_H_
+#define _IOTA_BUNDLE_VALIDATOR_H_
+
+#include <Arduino.h>
+#ifdef min
+#undef min
+#endif
+#ifdef max
+#undef max
+#endif
+#include <vector>
+
+#include "IotaClient.h"
+
+#define IOTABUNDLE_VALID			0
+#define IOTABUNDLE_ERR_STRUCTURE	-1
+#define IOTABUNDLE_ERR_VALUE		-2
+#define IOTABUNDLE_ERR_HASH			-3
+#define IOTABUNDLE_ERR_SIGNATURE	-4
+
+/** Validate a bundle
+      The following checks are done: transactions have consecutive current
+      indexes starting from 0, the same last index and the same bundle hash;
+      transaction values are within the total supply and sum up to zero; the
+      bundle hash matches the hash computed from the bundle essence; the
+      signature of each input (which spans the input transaction and the
+      following zero-value transactions with the same address) matches the
+      input address.
+      @param bundle  Trytes of bundle transactions, ordered by current index
+             (as returned by the getBundle() method of the IOTA client)
+      @param numTxs  Number of transactions in the bundle
+      @return IOTABUNDLE_VALID if the bundle is valid, or one of the
+              IOTABUNDLE_ERR_* codes
+*/
+int iotaBundleValidate(const char *bundle, unsigned int numTxs);
+
+/** Validate a bundle from parsed transactions
+      @param txs  Bundle transactions (as returned by the getTransaction()
+             method of the IOTA client), ordered by current index
+      @return IOTABUNDLE_VALID if the bundle is valid, or one of the
+              IOTABUNDLE_ERR_* codes
+*/
+int iotaBundleValidate(const std::vector<struct IotaTx> &txs);
+
+/** Validate multiple bundles
+      Bundles are validated in parallel by a pool of workers.
+      @param bundles  List of bundles, each made of the trytes of its
+             transactions ordered by current index
+      @param results  List that will be filled with the validation result of
+             each bundle (IOTABUNDLE_VALID or one of the IOTABUNDLE_ERR_* codes)
+      @param workers  Maximum number of bundles validated in parallel
+      @return none
+*/
+void iotaBundleValidate(const std::vector<String> &bundles,
+		std::vector<int> &results, unsigned int workers = 1);
+
+#endif
@@ -24,6 +24,12 @@
  */
 
 #include "IotaClient.h"
+#include "IotaCurl.h"
+#include "IotaHeap.h"
+#include "IotaTrace.h"
+#include "IotaTrafficLog.h"
+#include "IotaTrytes.h"
+#include "IotaTxStore.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -36,24 +42,52 @@ extern "C"
 }
 #endif
 
+/* Size of the JSON document used for requests on fixed-capacity hash
+ * lists; hashes are referenced, not copied, by the document. */
+#define IOTACLIENT_STATIC_JSON_SIZE	(JSON_OBJECT_SIZE(4) + \
+		2 * JSON_ARRAY_SIZE(IOTACLIENT_STATIC_BATCH))
+
+struct iotaClientValues {
+	void *values;
+	unsigned int count;
+	unsigned int max;
+};
+
 #ifdef IOTACLIENT_DEBUG
 #define DPRINTF	printf
 #else
 #define DPRINTF(fmt, ...)	do {} while(0)
 #endif
 
-#ifdef ESP8266
-IotaClient::IotaClient(Client &networkClient, const char *host, int port) {
-	_client.begin(static_cast<WiFiClient&>(networkClient), host, port);
-	_client.setTimeout(16 * 1024);
-}
-#else
 IotaClient::IotaClient(Client &networkClient, const char *host, int port)
-: _client(networkClient, host, port) {
+: _txStore(NULL), _recorder(NULL) {
+	_httpTransport = new IotaHttpTransport(networkClient, host, port);
+	_transport = _httpTransport;
+}
+
+IotaClient::IotaClient(IotaTransport &transport)
+: _transport(&transport), _httpTransport(NULL), _txStore(NULL),
+  _recorder(NULL) {
+}
+
+IotaClient::~IotaClient() {
+	delete _httpTransport;
+}
+
+void IotaClient::setTxStore(IotaTxStore &store) {
+	_txStore = &store;
+}
+
+void IotaClient::setRecorder(IotaTrafficRecorder &recorder) {
+	_recorder = &recorder;
+}
+
+void IotaClient::setReplayer(IotaTrafficReplayer &replayer) {
+	_transport = &replayer;
 }
-#endif
 
 bool IotaClient::getNodeInfo(struct iotaNodeInfo *info) {
+	IOTA_TRACE_SCOPE("getNodeInfo");
 	DynamicJsonDocument jsonDoc(2048);
 	JsonObject jsonReq = jsonDoc.to<JsonObject>();
 	int respStatus;
@@ -117,7 +151,9 @@ bool IotaClient::getNodeInfo(struct iotaNodeInfo *info) {
 
 bool IotaClient::getBalances(std::vector<String> &addrs,
 		std::vector<uint64_t> &balances) {
-	DynamicJsonDocument jsonDoc(1024);
+	IOTA_TRACE_SCOPE("getBalances");
+	DynamicJsonDocument jsonDoc(1024 + addrs.size() *
+			(JSON_ARRAY_SIZE(1) + NUM_HASH_TRYTES + 1));
 	JsonObject jsonReq = jsonDoc.to<JsonObject>();
 	int respStatus;
 
@@ -143,10 +179,95 @@ bool IotaClient::getBalances(std::vector<String> &addrs,
 	return false;
 }
 
+static void iotaClientAddHashes(JsonArray array, const IotaHashList &hashes,
+		unsigned int first) {
+	for (unsigned int i = first;
+			(i < hashes.size()) && (i < first + IOTACLIENT_STATIC_BATCH); i++) {
+		array.add(hashes[i]);
+	}
+}
+
+static bool iotaClientAddBalance(const char *value, void *arg) {
+	struct iotaClientValues *values = (struct iotaClientValues *) arg;
+
+	if (values->count == values->max) {
+		return false;
+	}
+	((uint64_t *) values->values)[values->count++] = strtoull(value, NULL, 10);
+	return true;
+}
+
+bool IotaClient::getBalances(const IotaHashList &addrs, uint64_t *balances) {
+	for (unsigned int first = 0; first < addrs.size();
+			first += IOTACLIENT_STATIC_BATCH) {
+		IOTA_TRACE_SCOPE("getBalances");
+		StaticJsonDocument<IOTACLIENT_STATIC_JSON_SIZE> jsonDoc;
+		JsonObject jsonReq = jsonDoc.to<JsonObject>();
+		struct iotaClientValues values;
+		int respStatus;
+
+		values.values = balances + first;
+		values.count = 0;
+		values.max = addrs.size() - first;
+		if (values.max > IOTACLIENT_STATIC_BATCH) {
+			values.max = IOTACLIENT_STATIC_BATCH;
+		}
+		jsonReq["command"] = "getBalances";
+		iotaClientAddHashes(jsonReq.createNestedArray("addresses"), addrs,
+				first);
+		jsonReq["threshold"] = 100;
+		respStatus = sendRequest(jsonDoc);
+		if (respStatus != 200) {
+			DPRINTF("%s: response status code %d\n", __FUNCTION__,
+					respStatus);
+			return false;
+		}
+		if (!readValues("\"balances\"", iotaClientAddBalance, &values) ||
+				(values.count != values.max)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool iotaClientAddHash(const char *hash, void *arg) {
+	((std::vector<String> *) arg)->push_back(hash);
+	return true;
+}
+
+static int iotaClientRead(Stream &stream) {
+	char c;
+
+	return ((stream.readBytes(&c, 1) == 1) ? (unsigned char) c : -1);
+}
+
+static int iotaClientReadToken(Stream &stream) {
+	int c;
+
+	do {
+		c = iotaClientRead(stream);
+	} while ((c == ' ') || (c == '\t') || (c == '\r') || (c == '\n'));
+	return c;
+}
+
 bool IotaClient::findTransactions(std::vector<String> &txs,
 		std::vector<String> bundles, std::vector<String> addrs,
 		std::vector<String> tags, std::vector<String> approvees) {
-	DynamicJsonDocument jsonDoc(2048);
+	IOTA_HEAP_SCOPE(IOTA_HEAP_OP_FIND);
+
+	txs.clear();
+	return findTransactions(iotaClientAddHash, &txs, bundles, addrs, tags,
+			approvees);
+}
+
+bool IotaClient::findTransactions(iotaHashCallback callback, void *arg,
+		std::vector<String> bundles, std::vector<String> addrs,
+		std::vector<String> tags, std::vector<String> approvees) {
+	IOTA_HEAP_SCOPE(IOTA_HEAP_OP_FIND);
+	IOTA_TRACE_SCOPE("findTransactions");
+	DynamicJsonDocument jsonDoc(JSON_OBJECT_SIZE(5) + 64 +
+			(bundles.size() + addrs.size() + tags.size() + approvees.size()) *
+			(JSON_ARRAY_SIZE(1) + NUM_HASH_TRYTES + 1));
 	JsonObject jsonReq = jsonDoc.to<JsonObject>();
 	int respStatus;
 
@@ -180,64 +301,277 @@ bool IotaClient::findTransactions(std::vector<String> &txs,
 		DPRINTF("%s: response status code %d\n", __FUNCTION__, respStatus);
 		return false;
 	}
-	txs.clear();
-	JsonObject jsonResp = getRespObj(jsonDoc);
-	if (jsonResp["hashes"].is<JsonArray>()) {
-		JsonArray hashArray = jsonResp["hashes"].as<JsonArray>();
-		for (int i = 0; i < hashArray.size(); i++) {
-			txs.push_back(hashArray[i]);
-		}
+
+	/* The response is parsed while it is received, instead of being
+	 * deserialized into a JSON document whose size would have to accommodate
+	 * all returned hashes. */
+	return readHashes("\"hashes\"", callback, arg);
+}
+
+struct iotaClientFindCtx {
+	iotaHashCallback callback;
+	void *arg;
+	bool stopped;
+};
+
+static bool iotaClientFindHash(const char *hash, void *arg) {
+	struct iotaClientFindCtx *ctx = (struct iotaClientFindCtx *) arg;
+
+	if (!ctx->callback(hash, ctx->arg)) {
+		ctx->stopped = true;
+		return false;
 	}
 	return true;
 }
 
-bool IotaClient::getTransaction(String &hash, struct IotaTx *tx) {
-	DynamicJsonDocument jsonDoc(4096);
-	JsonObject jsonReq = jsonDoc.to<JsonObject>();
-	JsonArray hashArray = jsonReq.createNestedArray("hashes");
-	int respStatus;
+bool IotaClient::findTransactions(iotaHashCallback callback, void *arg,
+		const IotaHashList *bundles, const IotaHashList *addrs) {
+	IOTA_HEAP_SCOPE(IOTA_HEAP_OP_FIND);
+	const IotaHashList *list = (bundles ? bundles : addrs);
+	struct iotaClientFindCtx ctx = {callback, arg, false};
 
-	jsonReq["command"] = "getTrytes";
-	hashArray.add(hash);
-	respStatus = sendRequest(jsonDoc);
-	if (respStatus != 200) {
-		DPRINTF("%s: response status code %d\n", __FUNCTION__, respStatus);
+	if (!list || (bundles && addrs &&
+			((bundles->size() > IOTACLIENT_STATIC_BATCH) ||
+			(addrs->size() > IOTACLIENT_STATIC_BATCH)))) {
 		return false;
 	}
-	JsonObject jsonResp = getRespObj(jsonDoc);
-	if (!jsonResp["trytes"].is<JsonArray>()) {
-		return false;
+	for (unsigned int first = 0; (first < list->size()) && !ctx.stopped;
+			first += IOTACLIENT_STATIC_BATCH) {
+		IOTA_TRACE_SCOPE("findTransactions");
+		StaticJsonDocument<IOTACLIENT_STATIC_JSON_SIZE> jsonDoc;
+		JsonObject jsonReq = jsonDoc.to<JsonObject>();
+		int respStatus;
+
+		jsonReq["command"] = "findTransactions";
+		if (bundles) {
+			iotaClientAddHashes(jsonReq.createNestedArray("bundles"), *bundles,
+					first);
+		}
+		if (addrs) {
+			iotaClientAddHashes(jsonReq.createNestedArray("addresses"), *addrs,
+					first);
+		}
+		respStatus = sendRequest(jsonDoc);
+		if (respStatus != 200) {
+			DPRINTF("%s: response status code %d\n", __FUNCTION__,
+					respStatus);
+			return false;
+		}
+		if (!readHashes("\"hashes\"", iotaClientFindHash, &ctx)) {
+			return false;
+		}
 	}
-	JsonArray txArray = jsonResp["trytes"].as<JsonArray>();
-	if (txArray.size() != 1) {
+	return true;
+}
+
+bool IotaClient::getTransaction(String &hash, struct IotaTx *tx) {
+	std::vector<String> hashes;
+	std::vector<String> trytes;
+
+	hashes.push_back(hash);
+	if (!getTrytes(hashes, trytes)) {
 		return false;
 	}
-	String txChars = txArray[0];
-	if (txChars.length() != NUM_TRANSACTION_TRYTES) {
+	String &txChars = trytes[0];
+	if ((txChars.length() != NUM_TRANSACTION_TRYTES) ||
+			!iotaTrytesValidate(txChars.c_str(), NUM_TRANSACTION_TRYTES)) {
 		return false;
 	}
 	tx->signatureMessage = txChars.substring(0, 2187);
 	tx->address = txChars.substring(2187, 2268);
-	chars_to_int64(txChars.c_str() + 2268, &tx->value, 27);
+	tx->value = iotaTrytesToInt64(txChars.c_str() + 2268, 27);
 	tx->obsoleteTag = txChars.substring(2295, 2322);
-	chars_to_int64(txChars.c_str() + 2322, &tx->timestamp, 9);
-	chars_to_int64(txChars.c_str() + 2331, &tx->currentIndex, 9);
-	chars_to_int64(txChars.c_str() + 2340, &tx->lastIndex, 9);
+	tx->timestamp = iotaTrytesToInt64(txChars.c_str() + 2322, 9);
+	tx->currentIndex = iotaTrytesToInt64(txChars.c_str() + 2331, 9);
+	tx->lastIndex = iotaTrytesToInt64(txChars.c_str() + 2340, 9);
 	tx->bundle = txChars.substring(2349, 2430);
 	tx->trunk = txChars.substring(2430, 2511);
 	tx->branch = txChars.substring(2511, 2592);
 	tx->tag = txChars.substring(2592, 2619);
-	chars_to_int64(txChars.c_str() + 2619, &tx->attachmentTimestamp, 9);
-	chars_to_int64(txChars.c_str() + 2628, &tx->attachmentTimestampLowerBound,
-			9);
-	chars_to_int64(txChars.c_str() + 2637, &tx->attachmentTimestampUpperBound,
-			9);
+	tx->attachmentTimestamp = iotaTrytesToInt64(txChars.c_str() + 2619, 9);
+	tx->attachmentTimestampLowerBound =
+			iotaTrytesToInt64(txChars.c_str() + 2628, 9);
+	tx->attachmentTimestampUpperBound =
+			iotaTrytesToInt64(txChars.c_str() + 2637, 9);
 	tx->nonce = txChars.substring(2646, NUM_TRANSACTION_TRYTES);
 	return true;
 }
 
+bool IotaClient::getTrytes(std::vector<String> &hashes,
+		std::vector<String> &trytes) {
+	std::vector<String> missing;
+	std::vector<String> fetched;
+	std::vector<unsigned int> missingIdx;
+
+	if (!_txStore) {
+		return fetchTrytes(hashes, trytes);
+	}
+	trytes.clear();
+	trytes.resize(hashes.size());
+	for (unsigned int i = 0; i < hashes.size(); i++) {
+		if (!_txStore->getTrytes(hashes[i], trytes[i])) {
+			missing.push_back(hashes[i]);
+			missingIdx.push_back(i);
+		}
+	}
+	DPRINTF("%s: %u of %u transactions found in local store\n", __FUNCTION__,
+			(unsigned) (hashes.size() - missing.size()),
+			(unsigned) hashes.size());
+	if (missing.size() == 0) {
+		return true;
+	}
+	if (!fetchTrytes(missing, fetched)) {
+		trytes.clear();
+		return false;
+	}
+	for (unsigned int i = 0; i < missing.size(); i++) {
+		String &tx = fetched[i];
+		char hash[NUM_HASH_TRYTES];
+
+		/* The node returns all-9 trytes for unknown transactions; the bundle
+		 * hash of a real transaction is never null. Transactions are stored
+		 * only if their trytes hash to the requested hash, so that the store
+		 * never serves data the node could not have attached. */
+		if ((tx.length() == NUM_TRANSACTION_TRYTES) &&
+				(strspn(tx.c_str() + IOTA_TX_BUNDLE_OFFSET, "9") <
+				NUM_HASH_TRYTES)) {
+			iotaCurlTxHash(tx.c_str(), hash);
+			if (!strncmp(hash, missing[i].c_str(), NUM_HASH_TRYTES)) {
+				_txStore->add(missing[i], tx);
+			}
+			else {
+				DPRINTF("%s: hash mismatch for %s\n", __FUNCTION__,
+						missing[i].c_str());
+			}
+		}
+		trytes[missingIdx[i]] = std::move(tx);
+	}
+	return true;
+}
+
+bool IotaClient::fetchTrytes(std::vector<String> &hashes,
+		std::vector<String> &trytes) {
+	int maxTxs = (IOTACLIENT_JSON_BUDGET - JSON_OBJECT_SIZE(2) - 128) /
+			(JSON_ARRAY_SIZE(1) + NUM_TRANSACTION_TRYTES + 1);
+
+	if (maxTxs <= 0) {
+		maxTxs = 1;
+	}
+	trytes.clear();
+	for (auto it = hashes.cbegin(); it != hashes.cend(); ) {
+		auto last = ((hashes.cend() - it > maxTxs) ? it + maxTxs :
+				hashes.cend());
+
+		if (!getTrytes(it, last, trytes)) {
+			return false;
+		}
+		it = last;
+	}
+	return (trytes.size() == hashes.size());
+}
+
+bool IotaClient::getBundle(String &tailHash, String &bundle,
+		unsigned int *numTxs) {
+	std::vector<String> hashes;
+	std::vector<String> trytes;
+	int64_t lastIndex;
+	String bundleHash;
+	String trunk;
+
+	hashes.push_back(tailHash);
+	if (!getTrytes(hashes, trytes) ||
+			!checkBundleTx(trytes[0], NULL, 0, &lastIndex)) {
+		DPRINTF("%s: invalid tail transaction\n", __FUNCTION__);
+		return false;
+	}
+	if (lastIndex >= IOTACLIENT_MAX_BUNDLE_TXS) {
+		DPRINTF("%s: too many transactions in bundle (%d)\n", __FUNCTION__,
+				(int)(lastIndex + 1));
+		return false;
+	}
+	bundleHash = trytes[0].substring(IOTA_TX_BUNDLE_OFFSET,
+			IOTA_TX_BUNDLE_OFFSET + NUM_HASH_TRYTES);
+	bundle = "";
+	if (!bundle.reserve((unsigned int)(lastIndex + 1) *
+			NUM_TRANSACTION_TRYTES)) {
+		return false;
+	}
+	bundle += trytes[0];
+	trunk = trytes[0].substring(IOTA_TX_TRUNK_OFFSET,
+			IOTA_TX_TRUNK_OFFSET + NUM_HASH_TRYTES);
+
+	/* Follow trunk links through transactions in the local store first. */
+	if (_txStore) {
+		String tx;
+
+		for (int64_t index = 1; (index <= lastIndex) &&
+				_txStore->getTrytes(trunk, tx) &&
+				checkBundleTx(tx, bundleHash.c_str(), index, &lastIndex);
+				index++) {
+			bundle += tx;
+			trunk = tx.substring(IOTA_TX_TRUNK_OFFSET,
+					IOTA_TX_TRUNK_OFFSET + NUM_HASH_TRYTES);
+		}
+	}
+	if (lastIndex > (int64_t) (bundle.length() / NUM_TRANSACTION_TRYTES)) {
+		std::vector<String> bundles;
+
+		/* Look up all transactions of the bundle at once; reattachments of
+		 * the bundle are returned too, so give up if there are too many of
+		 * them. */
+		bundles.push_back(bundleHash);
+		if (findTransactions(hashes, bundles) &&
+				(hashes.size() <= IOTACLIENT_BUNDLE_LOOKUP_MAX *
+				(lastIndex + 1)) && getTrytes(hashes, trytes)) {
+			for (int64_t index = bundle.length() / NUM_TRANSACTION_TRYTES;
+					index <= lastIndex; index++) {
+				unsigned int i;
+
+				for (i = 0; i < hashes.size(); i++) {
+					if (hashes[i] == trunk) {
+						break;
+					}
+				}
+				if ((i == hashes.size()) ||
+						!checkBundleTx(trytes[i], bundleHash.c_str(), index,
+						&lastIndex)) {
+					break;
+				}
+				bundle += trytes[i];
+				trunk = trytes[i].substring(IOTA_TX_TRUNK_OFFSET,
+						IOTA_TX_TRUNK_OFFSET + NUM_HASH_TRYTES);
+			}
+		}
+		else {
+			DPRINTF("%s: bundle lookup failed\n", __FUNCTION__);
+		}
+	}
+
+	/* Walk trunk links for any transactions not retrieved so far. */
+	for (int64_t index = bundle.length() / NUM_TRANSACTION_TRYTES;
+			index <= lastIndex; index++) {
+		hashes.clear();
+		hashes.push_back(trunk);
+		if (!getTrytes(hashes, trytes) ||
+				!checkBundleTx(trytes[0], bundleHash.c_str(), index,
+				&lastIndex)) {
+			DPRINTF("%s: invalid transaction at index %d\n", __FUNCTION__,
+					(int)index);
+			return false;
+		}
+		bundle += trytes[0];
+		trunk = trytes[0].substring(IOTA_TX_TRUNK_OFFSET,
+			IOTA_TX_TRUNK_OFFSET + NUM_HASH_TRYTES);
+	}
+	if (numTxs) {
+		*numTxs = lastIndex + 1;
+	}
+	return true;
+}
+
 bool IotaClient::getTransactionsToApprove(int depth, String &trunk,
 		String &branch) {
+	IOTA_TRACE_SCOPE("getTransactionsToApprove");
 	DynamicJsonDocument jsonDoc(512);
 	JsonObject jsonReq = jsonDoc.to<JsonObject>();
 	int respStatus;
@@ -261,6 +595,7 @@ bool IotaClient::getTransactionsToApprove(int depth, String &trunk,
 
 bool IotaClient::attachToTangle(String &trunk, String &branch, int mwm,
 		std::vector<String> &txs) {
+	IOTA_TRACE_SCOPE("attachToTangle");
 	DynamicJsonDocument jsonDoc(NUM_TRANSACTION_TRYTES * (txs.size() + 1));
 	JsonObject jsonReq = jsonDoc.to<JsonObject>();
 	JsonArray txArray = jsonReq.createNestedArray("trytes");
@@ -294,6 +629,7 @@ bool IotaClient::attachToTangle(String &trunk, String &branch, int mwm,
 }
 
 bool IotaClient::storeTransactions(std::vector<String> &txs) {
+	IOTA_TRACE_SCOPE("storeTransactions");
 	DynamicJsonDocument jsonDoc(NUM_TRANSACTION_TRYTES * (txs.size() + 1));
 	JsonObject jsonReq = jsonDoc.to<JsonObject>();
 	JsonArray txArray = jsonReq.createNestedArray("trytes");
@@ -306,6 +642,7 @@ bool IotaClient::storeTransactions(std::vector<String> &txs) {
 }
 
 bool IotaClient::broadcastTransactions(std::vector<String> &txs) {
+	IOTA_TRACE_SCOPE("broadcastTransactions");
 	DynamicJsonDocument jsonDoc(NUM_TRANSACTION_TRYTES * (txs.size() + 1));
 	JsonObject jsonReq = jsonDoc.to<JsonObject>();
 	JsonArray txArray = jsonReq.createNestedArray("trytes");
@@ -319,7 +656,9 @@ bool IotaClient::broadcastTransactions(std::vector<String> &txs) {
 
 bool IotaClient::wereAddressesSpentFrom(std::vector<String> &addrs,
 		std::vector<bool> &spent) {
-	DynamicJsonDocument jsonDoc(1024);
+	IOTA_TRACE_SCOPE("wereAddressesSpentFrom");
+	DynamicJsonDocument jsonDoc(1024 + addrs.size() *
+			(JSON_ARRAY_SIZE(1) + NUM_HASH_TRYTES + 1));
 	JsonObject jsonReq = jsonDoc.to<JsonObject>();
 	int respStatus;
 
@@ -344,125 +683,352 @@ bool IotaClient::wereAddressesSpentFrom(std::vector<String> &addrs,
 	return false;
 }
 
-int IotaClient::sendRequest(JsonDocument &jsonDoc) {
-	return _client.sendRequest(jsonDoc);
+static bool iotaClientAddState(const char *value, void *arg) {
+	struct iotaClientValues *values = (struct iotaClientValues *) arg;
+
+	if (values->count == values->max) {
+		return false;
+	}
+	((bool *) values->values)[values->count++] = !strcmp(value, "true");
+	return true;
 }
 
-JsonObject IotaClient::getRespObj(JsonDocument &jsonDoc) {
-	DeserializationError error;
+bool IotaClient::wereAddressesSpentFrom(const IotaHashList &addrs,
+		bool *spent) {
+	for (unsigned int first = 0; first < addrs.size();
+			first += IOTACLIENT_STATIC_BATCH) {
+		IOTA_TRACE_SCOPE("wereAddressesSpentFrom");
+		StaticJsonDocument<IOTACLIENT_STATIC_JSON_SIZE> jsonDoc;
+		JsonObject jsonReq = jsonDoc.to<JsonObject>();
+		struct iotaClientValues values;
+		int respStatus;
 
-#ifdef ESP8266
-	error = deserializeJson(jsonDoc, _client.getStream());
-#else
-	error = deserializeJson(jsonDoc, _client.responseBody());
-#endif
-	if (error) {
-		DPRINTF("%s: error %s\n", __FUNCTION__, error.c_str());
+		values.values = spent + first;
+		values.count = 0;
+		values.max = addrs.size() - first;
+		if (values.max > IOTACLIENT_STATIC_BATCH) {
+			values.max = IOTACLIENT_STATIC_BATCH;
+		}
+		jsonReq["command"] = "wereAddressesSpentFrom";
+		iotaClientAddHashes(jsonReq.createNestedArray("addresses"), addrs,
+				first);
+		respStatus = sendRequest(jsonDoc);
+		if (respStatus != 200) {
+			DPRINTF("%s: response status code %d\n", __FUNCTION__,
+					respStatus);
+			return false;
+		}
+		if (!readValues("\"states\"", iotaClientAddState, &values) ||
+				(values.count != values.max)) {
+			return false;
+		}
 	}
-	return jsonDoc.as<JsonObject>();
+	return true;
 }
 
-int IotaClient::JsonHttpClient::sendRequest(JsonDocument &jsonDoc) {
-	int contentLen = measureJson(jsonDoc);
+bool IotaClient::getInclusionStates(std::vector<String> &txs,
+		std::vector<String> &tips, std::vector<bool> &states) {
+	int overhead = JSON_OBJECT_SIZE(3) + JSON_ARRAY_SIZE(tips.size()) +
+			tips.size() * (NUM_HASH_TRYTES + 1) + 128;
+	int maxTxs = (IOTACLIENT_JSON_BUDGET - overhead) /
+			(JSON_ARRAY_SIZE(1) + NUM_HASH_TRYTES + 1);
 
-#ifdef ESP8266
+	if (maxTxs <= 0) {
+		DPRINTF("%s: too many tips\n", __FUNCTION__);
+		return false;
+	}
+	states.clear();
+	for (auto it = txs.cbegin(); it != txs.cend(); ) {
+		auto last = ((txs.cend() - it > maxTxs) ? it + maxTxs : txs.cend());
 
-	disconnect(true);	/* Clean up previous connection, if any. */
-	addHeader("Content-Type", "application/json");
-	addHeader("X-IOTA-API-Version", "1");
-	addHeader("Content-Length", String(contentLen));
-	if (!connect()) {
-		return returnError(HTTPC_ERROR_CONNECTION_REFUSED);
+		if (!getInclusionStates(it, last, tips, states)) {
+			return false;
+		}
+		it = last;
 	}
-	if (!sendHeader("POST")) {
-		return returnError(HTTPC_ERROR_SEND_HEADER_FAILED);
+	return (states.size() == txs.size());
+}
+
+bool IotaClient::getLatestInclusion(std::vector<String> &txs,
+		std::vector<bool> &states) {
+	struct iotaNodeInfo nodeInfo;
+	std::vector<String> tips;
+
+	if (!getNodeInfo(&nodeInfo)) {
+		return false;
 	}
+	tips.push_back(nodeInfo.latestSolidSubtangleMilestone);
+	return getInclusionStates(txs, tips, states);
+}
+
+bool IotaClient::checkConsistency(std::vector<String> &tails,
+		bool &consistent, String *info) {
+	IOTA_TRACE_SCOPE("checkConsistency");
+	/* The response reuses the document and may carry an info message. */
+	DynamicJsonDocument jsonDoc(JSON_OBJECT_SIZE(3) +
+			JSON_ARRAY_SIZE(tails.size()) +
+			tails.size() * (NUM_HASH_TRYTES + 1) + 256);
+	JsonObject jsonReq = jsonDoc.to<JsonObject>();
+	int respStatus;
 
-	class BufferedWiFiPrint : public Print {
-	public:
-		BufferedWiFiPrint(size_t bufSize, WiFiClient &wifi) : _bufSize(bufSize),
-		_wifi(wifi) {
-			_buf = (uint8_t *) malloc(bufSize);
-			_byteCount = 0;
+	jsonReq["command"] = "checkConsistency";
+	JsonArray tailArray = jsonReq.createNestedArray("tails");
+	for (auto it = tails.cbegin(); it != tails.cend(); it++) {
+		tailArray.add(*it);
+	}
+	respStatus = sendRequest(jsonDoc);
+	if (respStatus != 200) {
+		DPRINTF("%s: response status code %d\n", __FUNCTION__, respStatus);
+		return false;
+	}
+	JsonObject jsonResp = getRespObj(jsonDoc);
+	if (!jsonResp["state"].is<bool>()) {
+		return false;
+	}
+	consistent = jsonResp["state"];
+	if (info && jsonResp["info"].is<char *>()) {
+		*info = jsonResp["info"].as<String>();
+	}
+	return true;
+}
+
+bool IotaClient::getInclusionStates(std::vector<String>::const_iterator first,
+		std::vector<String>::const_iterator last, std::vector<String> &tips,
+		std::vector<bool> &states) {
+	IOTA_TRACE_SCOPE("getInclusionStates");
+	DynamicJsonDocument jsonDoc(JSON_OBJECT_SIZE(3) +
+			JSON_ARRAY_SIZE((last - first) + tips.size()) +
+			((last - first) + tips.size()) * (NUM_HASH_TRYTES + 1) + 128);
+	JsonObject jsonReq = jsonDoc.to<JsonObject>();
+	int respStatus;
+
+	jsonReq["command"] = "getInclusionStates";
+	JsonArray txArray = jsonReq.createNestedArray("transactions");
+	for (auto it = first; it != last; it++) {
+		txArray.add(*it);
+	}
+	JsonArray tipArray = jsonReq.createNestedArray("tips");
+	for (auto it = tips.cbegin(); it != tips.cend(); it++) {
+		tipArray.add(*it);
+	}
+	respStatus = sendRequest(jsonDoc);
+	if (respStatus != 200) {
+		DPRINTF("%s: response status code %d\n", __FUNCTION__, respStatus);
+		return false;
+	}
+	JsonObject jsonResp = getRespObj(jsonDoc);
+	if (!jsonResp["states"].is<JsonArray>()) {
+		return false;
+	}
+	JsonArray stateArray = jsonResp["states"].as<JsonArray>();
+	if (stateArray.size() != last - first) {
+		return false;
+	}
+	for (int i = 0; i < stateArray.size(); i++) {
+		states.push_back(stateArray[i]);
+	}
+	return true;
+}
+
+bool IotaClient::getTrytes(std::vector<String>::const_iterator first,
+		std::vector<String>::const_iterator last,
+		std::vector<String> &trytes) {
+	IOTA_TRACE_SCOPE("getTrytes");
+	DynamicJsonDocument jsonDoc(JSON_OBJECT_SIZE(2) +
+			JSON_ARRAY_SIZE(last - first) +
+			(last - first) * (NUM_TRANSACTION_TRYTES + 1) + 128);
+	JsonObject jsonReq = jsonDoc.to<JsonObject>();
+	int respStatus;
+
+	jsonReq["command"] = "getTrytes";
+	JsonArray hashArray = jsonReq.createNestedArray("hashes");
+	for (auto it = first; it != last; it++) {
+		hashArray.add(*it);
+	}
+	respStatus = sendRequest(jsonDoc);
+	if (respStatus != 200) {
+		DPRINTF("%s: response status code %d\n", __FUNCTION__, respStatus);
+		return false;
+	}
+	JsonObject jsonResp = getRespObj(jsonDoc);
+	if (!jsonResp["trytes"].is<JsonArray>()) {
+		return false;
+	}
+	JsonArray txArray = jsonResp["trytes"].as<JsonArray>();
+	if (txArray.size() != last - first) {
+		return false;
+	}
+	for (int i = 0; i < txArray.size(); i++) {
+		trytes.push_back(txArray[i].as<String>());
+	}
+	return true;
+}
+
+bool IotaClient::checkBundleTx(String &tx, const char *bundleHash,
+		int64_t currentIndex, int64_t *lastIndex) {
+	int64_t txCurrentIndex, txLastIndex;
+
+	if ((tx.length() != NUM_TRANSACTION_TRYTES) ||
+			!iotaTrytesValidate(tx.c_str(), NUM_TRANSACTION_TRYTES)) {
+		return false;
+	}
+	if (bundleHash &&
+			strncmp(tx.c_str() + IOTA_TX_BUNDLE_OFFSET, bundleHash,
+			NUM_HASH_TRYTES)) {
+		return false;
+	}
+	txCurrentIndex = iotaTrytesToInt64(tx.c_str() +
+			IOTA_TX_CURRENT_INDEX_OFFSET, 9);
+	txLastIndex = iotaTrytesToInt64(tx.c_str() + IOTA_TX_LAST_INDEX_OFFSET,
+			9);
+	if ((txCurrentIndex != currentIndex) || (txLastIndex < txCurrentIndex)) {
+		return false;
+	}
+	if (currentIndex == 0) {
+		*lastIndex = txLastIndex;
+		return true;
+	}
+	return (txLastIndex == *lastIndex);
+}
+
+bool IotaClient::readHashes(const char *key, iotaHashCallback callback,
+		void *arg) {
+	Stream &stream = getRespStream();
+	char hash[NUM_HASH_TRYTES + 1];
+	int c;
+
+	if (!stream.find((char *) key) || (iotaClientReadToken(stream) != ':') ||
+			(iotaClientReadToken(stream) != '[')) {
+		DPRINTF("%s: %s not found\n", __FUNCTION__, key);
+		return false;
+	}
+	hash[NUM_HASH_TRYTES] = '\0';
+	c = iotaClientReadToken(stream);
+	while (c != ']') {
+		if ((c != '"') ||
+				(stream.readBytes(hash, NUM_HASH_TRYTES) != NUM_HASH_TRYTES) ||
+				(iotaClientRead(stream) != '"')) {
+			DPRINTF("%s: invalid hash\n", __FUNCTION__);
+			return false;
 		}
-		~BufferedWiFiPrint() {
-			free(_buf);
+		if (!callback(hash, arg)) {
+			dropResp();
+			return true;
 		}
-		size_t write(uint8_t b) {
-			_buf[_byteCount++] = b;
-			if (_byteCount == _bufSize) {
-				_wifi.write(_buf, _byteCount);
-				_byteCount = 0;
-			}
-			return 1;
+		c = iotaClientReadToken(stream);
+		if (c == ',') {
+			c = iotaClientReadToken(stream);
 		}
-		void flush() {
-			if (_byteCount != 0) {
-				_wifi.write(_buf, _byteCount);
-				_byteCount = 0;
-			}
+		else if (c != ']') {
+			DPRINTF("%s: unexpected character %d\n", __FUNCTION__, c);
+			return false;
 		}
-	private:
-		size_t _bufSize, _byteCount;
-		uint8_t *_buf;
-		WiFiClient &_wifi;
-	} print(HTTP_TCP_BUFFER_SIZE, getStream());
-	serializeJson(jsonDoc, print);
-	print.flush();
+	}
 
-	return returnError(handleHeaderResponse());
+	/* Consume the rest of the response object, so that the connection can be
+	 * reused. */
+	do {
+		c = iotaClientRead(stream);
+	} while ((c >= 0) && (c != '}'));
+	return true;
+}
 
-#else
+bool IotaClient::readValues(const char *key, iotaHashCallback callback,
+		void *arg) {
+	Stream &stream = getRespStream();
+	char value[NUM_HASH_TRYTES + 1];
+	int c;
 
-	beginRequest();
-	if (post("/") != HTTP_SUCCESS) {
-		DPRINTF("%s: cannot send POST request\n", __FUNCTION__);
-		return -1;
-	}
-	sendHeader("Content-Type", "application/json");
-	sendHeader("X-IOTA-API-Version", "1");
-	sendHeader("Content-Length", contentLen);
-	beginBody();
-
-	class BufferedNetworkPrint : public Print {
-	public:
-		BufferedNetworkPrint(size_t bufSize, Client &networkClient) :
-			_bufSize(bufSize), _networkClient(networkClient) {
-			_buf = (uint8_t *) malloc(bufSize);
-			_byteCount = 0;
-		}
-		~BufferedNetworkPrint() {
-			free(_buf);
-		}
-		size_t write(uint8_t b) {
-			_buf[_byteCount++] = b;
-			if (_byteCount == _bufSize) {
-				if (!_networkClient.write(_buf, _byteCount)) {
-					_byteCount--;
-					return 0;
-				}
-				_byteCount = 0;
+	if (!stream.find((char *) key) || (iotaClientReadToken(stream) != ':') ||
+			(iotaClientReadToken(stream) != '[')) {
+		DPRINTF("%s: %s not found\n", __FUNCTION__, key);
+		return false;
+	}
+	c = iotaClientReadToken(stream);
+	while (c != ']') {
+		unsigned int len = 0;
+
+		/* Values are either strings or literals (numbers, true, false). */
+		if (c == '"') {
+			while (((c = iotaClientRead(stream)) >= 0) && (c != '"') &&
+					(len < NUM_HASH_TRYTES)) {
+				value[len++] = c;
+			}
+			if (c != '"') {
+				DPRINTF("%s: invalid string\n", __FUNCTION__);
+				return false;
 			}
-			return 1;
+			c = iotaClientReadToken(stream);
 		}
-		void flush() {
-			if (_byteCount != 0) {
-				_networkClient.write(_buf, _byteCount);
-				_byteCount = 0;
+		else {
+			while ((c > ' ') && (c != ',') && (c != ']') &&
+					(len < NUM_HASH_TRYTES)) {
+				value[len++] = c;
+				c = iotaClientRead(stream);
+			}
+			if ((c >= 0) && (c <= ' ')) {
+				c = iotaClientReadToken(stream);
 			}
 		}
-	private:
-		size_t _bufSize, _byteCount;
-		uint8_t *_buf;
-		Client &_networkClient;
-	} print(1460, *iClient);
-	int written = serializeJson(jsonDoc, print);
-	if (written != contentLen) {
-		DPRINTF("%s: wrote %d of %d bytes\n", __FUNCTION__, written,
-				contentLen);
-		return -1;
-	}
-	print.flush();
-	return responseStatusCode();
-#endif
+		value[len] = '\0';
+		if ((len == 0) || !callback(value, arg)) {
+			DPRINTF("%s: unexpected value\n", __FUNCTION__);
+			return false;
+		}
+		if (c == ',') {
+			c = iotaClientReadToken(stream);
+		}
+		else if (c != ']') {
+			DPRINTF("%s: unexpected character %d\n", __FUNCTION__, c);
+			return false;
+		}
+	}
+	do {
+		c = iotaClientRead(stream);
+	} while ((c >= 0) && (c != '}'));
+	return true;
+}
+
+int IotaClient::sendRequest(JsonDocument &jsonDoc) {
+	IOTA_TRACE_SCOPE("request");
+	int respStatus;
+
+	if (!_recorder) {
+		return _transport->sendRequest(jsonDoc);
+	}
+	_recorder->begin(jsonDoc);
+	respStatus = _transport->sendRequest(jsonDoc);
+	_recorder->setStatus(respStatus);
+	return respStatus;
+}
+
+/* Returns the stream from which the response body is read, which is the
+ * recorder when recording. */
+Stream &IotaClient::getRespStream() {
+	Stream &stream = _transport->getResponseStream();
+
+	if (_recorder) {
+		_recorder->setSource(stream, _transport->getResponseTimeout());
+		return *_recorder;
+	}
+	return stream;
+}
+
+void IotaClient::dropResp() {
+	_transport->dropResponse();
+}
+
+JsonObject IotaClient::getRespObj(JsonDocument &jsonDoc) {
+	DeserializationError error;
+
+	if (_recorder) {
+		error = deserializeJson(jsonDoc, getRespStream());
+	}
+	else {
+		error = _transport->readResponse(jsonDoc);
+	}
+	if (error) {
+		DPRINTF("%s: error %s\n", __FUNCTION__, error.c_str());
+	}
+	return jsonDoc.as<JsonObject>();
 }
@@ -26,22 +26,36 @@
 #ifndef _IOTA_CLIENT_H_
 #define _IOTA_CLIENT_H_
 
-#include <Arduino.h>
-#ifdef ESP8266
-#include <ESP8266HTTPClient.h>
-#else
-#include <ArduinoHttpClient.h>
+#include "IotaTransport.h"
+#include <vector>
+
+#include "IotaHashList.h"
+
+/* Maximum size of the JSON document used for commands that are split into
+ * multiple requests when operating on long lists of hashes. */
+#ifndef IOTACLIENT_JSON_BUDGET
+#define IOTACLIENT_JSON_BUDGET	8192
 #endif
-#ifdef min
-#undef min
+
+/* Maximum number of transactions per bundle index (i.e. of attachments of a
+ * bundle) retrieved when looking up bundle transactions by bundle hash. */
+#ifndef IOTACLIENT_BUNDLE_LOOKUP_MAX
+#define IOTACLIENT_BUNDLE_LOOKUP_MAX	3
 #endif
-#ifdef max
-#undef max
+
+/* Maximum number of hashes per request for commands that operate on
+ * fixed-capacity hash lists; requests are built in a JSON document of static
+ * size. */
+#ifndef IOTACLIENT_STATIC_BATCH
+#define IOTACLIENT_STATIC_BATCH		16
 #endif
-#include <vector>
 
-#define ARDUINOJSON_USE_LONG_LONG	1
-#include <ArduinoJson.h>
+/* Maximum number of transactions in a bundle retrieved with getBundle(): the
+ * last index of the tail transaction comes from the node, and bounds both
+ * the memory reserved for the bundle and the number of trunk links walked. */
+#ifndef IOTACLIENT_MAX_BUNDLE_TXS
+#define IOTACLIENT_MAX_BUNDLE_TXS	256
+#endif
 
 struct iotaNodeInfo {
 	String appName;
@@ -59,6 +73,35 @@ struct iotaNodeInfo {
 	String coordinatorAddress;
 };
 
+/** Callback function for streamed transaction hashes
+      @param hash  Transaction hash (81 characters, null-terminated)
+      @param arg  Opaque argument supplied by the caller
+      @return true to continue receiving hashes, false to stop
+*/
+typedef bool (*iotaHashCallback)(const char *hash, void *arg);
+
+class IotaTrafficRecorder;
+class IotaTrafficReplayer;
+class IotaTxStore;
+
+/* Offsets of transaction fields in transaction trytes. */
+#define IOTA_TX_SIGNATURE_OFFSET	0
+#define IOTA_TX_SIGNATURE_TRYTES	2187
+#define IOTA_TX_ADDRESS_OFFSET	2187
+#define IOTA_TX_VALUE_OFFSET	2268
+#define IOTA_TX_OBSOLETE_TAG_OFFSET	2295
+#define IOTA_TX_TIMESTAMP_OFFSET	2322
+#define IOTA_TX_CURRENT_INDEX_OFFSET	2331
+#define IOTA_TX_LAST_INDEX_OFFSET	2340
+#define IOTA_TX_BUNDLE_OFFSET	2349
+#define IOTA_TX_TRUNK_OFFSET	2430
+#define IOTA_TX_BRANCH_OFFSET	2511
+#define IOTA_TX_TAG_OFFSET	2592
+#define IOTA_TX_ATTACHMENT_TS_OFFSET	2619
+#define IOTA_TX_ATTACHMENT_TS_LOWER_OFFSET	2628
+#define IOTA_TX_ATTACHMENT_TS_UPPER_OFFSET	2637
+#define IOTA_TX_NONCE_OFFSET	2646
+
 struct IotaTx {
 	String signatureMessage;
 	String address;
@@ -90,6 +133,44 @@ public:
 	*/
 	IotaClient(Client &networkClient, const char *host, int port);
 
+	/** Create a IOTA client that communicates with a IOTA full node through a
+      given transport
+      @param transport  Transport used to send requests to the node, e.g. a
+             transport that shares an event loop with other clients
+      @return none
+	*/
+	IotaClient(IotaTransport &transport);
+
+	~IotaClient();
+
+	/** Configure local transaction store
+      When a transaction store is configured, transactions are looked up in
+      the store before being requested to the IOTA node, and transactions
+      retrieved from the node are added to the store (after checking that
+      their Curl hash matches the requested hash), so that repeated
+      transaction and bundle queries do not need network communication.
+      @param store  Transaction store
+      @return none
+	*/
+	void setTxStore(IotaTxStore &store);
+
+	/** Record traffic with the IOTA node
+      Each request sent to the node is logged together with the response and
+      its timings, so that it can be replayed later with IotaTrafficReplayer.
+      @param recorder  Traffic recorder
+      @return none
+	*/
+	void setRecorder(IotaTrafficRecorder &recorder);
+
+	/** Replay recorded traffic instead of communicating with the IOTA node
+      Responses to requests are taken from a traffic log, and the network
+      client is not used; this is equivalent to using the replayer as the
+      transport of the client.
+      @param replayer  Traffic replayer
+      @return none
+	*/
+	void setReplayer(IotaTrafficReplayer &replayer);
+
 	/** Retrieve node information from the remote IOTA node
       @param info  Pointer to node information structure that is filled with
              data received from the remote node
@@ -106,6 +187,16 @@ public:
 	bool getBalances(std::vector<String> &addrs,
 			std::vector<uint64_t> &balances);
 
+	/** Retrieve balance of a list of addresses without allocating memory
+      The request is split into batches of IOTACLIENT_STATIC_BATCH addresses,
+      and balances are parsed while the response is received.
+      @param addrs  List of addresses for which the balance must be retrieved
+      @param balances  Array to be filled with balance values (one value for
+             each address)
+      @return true if balance request is successful, false otherwise
+	*/
+	bool getBalances(const IotaHashList &addrs, uint64_t *balances);
+
 	/** Find transactions that match a set of criteria
       @param txs  List that is filled with hashes of retrieved transactions
       @param bundles  List of hashes of bundles to which transactions must
@@ -125,6 +216,50 @@ public:
 			std::vector<String> tags = std::vector<String>(),
 			std::vector<String> approvees = std::vector<String>());
 
+	/** Find transactions that match a set of criteria, streaming the results
+      Transaction hashes are parsed one at a time from the response of the
+      remote node and passed to a callback function, so that the memory used
+      does not depend on the number of transactions found.
+      @param callback  Function called for each transaction hash; if it returns
+             false, the remaining hashes are discarded
+      @param arg  Opaque argument passed to the callback function
+      @param bundles  List of hashes of bundles to which transactions must
+             belong; if empty, transactions can belong to any bundle
+      @param addrs  List of addresses that must be contained in transactions; if
+             empty, transactions can contain any address
+      @param tags  List of tags that must be contained in transactions; if
+             empty, transactions can contain any tag
+      @param approvees  List of hashes of transactions that must be approved
+             from the transactions to be retrieved; if empty, transactions can
+             approve any transaction
+      @return true if transaction request is successful (including when hashes
+              are discarded because the callback returned false), false
+              otherwise
+	*/
+	bool findTransactions(iotaHashCallback callback, void *arg,
+			std::vector<String> bundles = std::vector<String>(),
+			std::vector<String> addrs = std::vector<String>(),
+			std::vector<String> tags = std::vector<String>(),
+			std::vector<String> approvees = std::vector<String>());
+
+	/** Find transactions by bundle or address without allocating memory
+      If only one of the two lists is supplied, it is split into batches of
+      IOTACLIENT_STATIC_BATCH entries; if both are supplied (in which case the
+      node returns transactions that match both), each of them must not be
+      longer than IOTACLIENT_STATIC_BATCH.
+      @param callback  Function called for each transaction hash; if it returns
+             false, the remaining hashes are discarded
+      @param arg  Opaque argument passed to the callback function
+      @param bundles  Pointer to list of hashes of bundles to which
+             transactions must belong; if NULL, transactions can belong to any
+             bundle
+      @param addrs  Pointer to list of addresses that must be contained in
+             transactions; if NULL, transactions can contain any address
+      @return true if transaction request is successful, false otherwise
+	*/
+	bool findTransactions(iotaHashCallback callback, void *arg,
+			const IotaHashList *bundles, const IotaHashList *addrs);
+
 	/** Retreive transaction data from a given transaction hash
       @param hash  Transaction hash
       @param tx  Pointer to structure that is filled with transaction data
@@ -133,6 +268,45 @@ public:
 	*/
 	bool getTransaction(String &hash, struct IotaTx *tx);
 
+	/** Retrieve raw transaction trytes from a list of transaction hashes
+      Hash lists of arbitrary length are supported: if needed, the retrieval
+      is split into multiple requests, each sized so that its JSON document
+      does not exceed IOTACLIENT_JSON_BUDGET bytes. If a transaction store is
+      configured, only transactions not found in the store are requested to
+      the IOTA node.
+      @param hashes  List of transaction hashes
+      @param trytes  List that will be filled with transaction trytes (one
+             string of NUM_TRANSACTION_TRYTES characters for each hash supplied
+             in the first argument, in the same order)
+      @return true if request is successful, false otherwise
+	*/
+	bool getTrytes(std::vector<String> &hashes, std::vector<String> &trytes);
+
+	/** Retrieve all transactions of a bundle from its tail transaction
+      For bundles with more than two transactions, the hashes of all
+      transactions of the bundle are looked up via findTransactions(), and
+      retrieved in batched requests; the bundle is then reassembled by
+      following trunk links starting from the tail transaction. Transactions
+      that cannot be found this way (or all transactions, for bundles with
+      two transactions) are retrieved by walking trunk links one transaction
+      at a time. If a transaction store is configured, trunk links are first
+      followed through stored transactions, so that a bundle found entirely in
+      the store is retrieved without network communication. The current and
+      last index of each transaction are checked for consistency with the tail
+      transaction; bundles with more than IOTACLIENT_MAX_BUNDLE_TXS
+      transactions are rejected before any memory is reserved for them.
+      @param tailHash  Hash of tail transaction of the bundle
+      @param bundle  Reference to string that will contain the trytes of all
+             transactions of the bundle, ordered by current index; the string
+             length is a multiple of NUM_TRANSACTION_TRYTES
+      @param numTxs  Pointer to variable where the number of transactions in
+             the bundle will be stored; if NULL (default value), this
+             information is not returned
+      @return true if the bundle has been retrieved, false otherwise
+	*/
+	bool getBundle(String &tailHash, String &bundle,
+			unsigned int *numTxs = NULL);
+
 	/** Retreive two transactions to be approved (tips) in the tangle
       @param depth  Random walk depth for the tip selection process
       @param trunk  Reference to string that will contain the hash of the first
@@ -182,20 +356,86 @@ public:
 	bool wereAddressesSpentFrom(std::vector<String> &addrs,
 			std::vector<bool> &spent);
 
+	/** Check if IOTA addresses have been spent from without allocating memory
+      The request is split into batches of IOTACLIENT_STATIC_BATCH addresses,
+      and states are parsed while the response is received.
+      @param addrs  List of addresses for which the check must be executed
+      @param spent  Array to be filled with boolean values (one for each
+             address) that indicate whether the addresses have been spent from
+      @return true if request is successful, false otherwise
+	*/
+	bool wereAddressesSpentFrom(const IotaHashList &addrs, bool *spent);
+
+	/** Check if transactions have been confirmed
+      Transaction lists of arbitrary length are supported: if needed, the
+      check is split into multiple requests, each sized so that its JSON
+      document does not exceed IOTACLIENT_JSON_BUDGET bytes.
+      @param txs  List of hashes of transactions for which the check must be
+             executed
+      @param tips  List of hashes of transactions (typically milestones)
+             against which the inclusion of transactions must be checked
+      @param states  List that will be filled with boolean values (one for
+             each transaction supplied in the first argument) that indicate
+             whether transactions are referenced by the supplied tips
+      @return true if request is successful, false otherwise
+	*/
+	bool getInclusionStates(std::vector<String> &txs,
+			std::vector<String> &tips, std::vector<bool> &states);
+
+	/** Check if transactions have been confirmed by the latest milestone
+      This method retrieves the latest solid milestone from the remote node (via
+      the getNodeInfo command) and uses it as tip for getInclusionStates().
+      @param txs  List of hashes of transactions for which the check must be
+             executed
+      @param states  List that will be filled with boolean values (one for
+             each transaction supplied in the first argument) that indicate
+             whether transactions have been confirmed
+      @return true if request is successful, false otherwise
+	*/
+	bool getLatestInclusion(std::vector<String> &txs,
+			std::vector<bool> &states);
+
+	/** Check consistency of transactions
+      A set of transactions is consistent if the ledger state resulting from
+      approving all of them is valid; transactions to be approved by a new
+      bundle (or transactions to be promoted) should be checked for
+      consistency before doing Proof of Work.
+      @param tails  List of hashes of (tail) transactions to be checked
+      @param consistent  Reference to variable that will be set to true if the
+             supplied transactions are consistent, false otherwise
+      @param info  Pointer to string that will contain the reason why
+             transactions are not consistent, if available; if NULL (default
+             value), this information is not returned
+      @return true if request is successful, false otherwise
+	*/
+	bool checkConsistency(std::vector<String> &tails, bool &consistent,
+			String *info = NULL);
+
 private:
+	bool fetchTrytes(std::vector<String> &hashes,
+			std::vector<String> &trytes);
+	bool checkBundleTx(String &tx, const char *bundleHash,
+			int64_t currentIndex, int64_t *lastIndex);
+	bool getTrytes(std::vector<String>::const_iterator first,
+			std::vector<String>::const_iterator last,
+			std::vector<String> &trytes);
+	bool getInclusionStates(std::vector<String>::const_iterator first,
+			std::vector<String>::const_iterator last,
+			std::vector<String> &tips, std::vector<bool> &states);
 	int sendRequest(JsonDocument &jsonDoc);
 	JsonObject getRespObj(JsonDocument &jsonDoc);
-#ifdef ESP8266
-	class JsonHttpClient : public HTTPClient {
-#else
-	class JsonHttpClient : public HttpClient {
-	public:
-		JsonHttpClient(Client &networkClient, const char *host, int port) :
-			HttpClient(networkClient, host, port) {}
-#endif
-	public:
-		int sendRequest(JsonDocument &jsonDoc);
-	} _client;
+	Stream &getRespStream();
+	void dropResp();
+	bool readHashes(const char *key, iotaHashCallback callback, void *arg);
+	bool readValues(const char *key, iotaHashCallback callback, void *arg);
+
+	IotaClient(const IotaClient &);
+	IotaClient &operator=(const IotaClient &);
+
+	IotaTransport *_transport;
+	IotaHttpTransport *_httpTransport;
+	IotaTxStore *_txStore;
+	IotaTrafficRecorder *_recorder;
 };
 
 #endif
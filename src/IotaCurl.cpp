@@ -0,0 +1,109 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "IotaCurl.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "iota-c-library/src/iota/common.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+#define CURL_STATE_TRITS	729
+#define CURL_ROUNDS			81
+
+static const int8_t curlTruthTable[11] = {1, 0, -1, 2, 1, -1, 0, 2, -1, 1, 0};
+
+static void curlTransform(int8_t *state) {
+	int8_t copy[CURL_STATE_TRITS];
+
+	for (int round = 0; round < CURL_ROUNDS; round++) {
+		int idx = 0;
+
+		memcpy(copy, state, sizeof(copy));
+		for (int i = 0; i < CURL_STATE_TRITS; i++) {
+			int prev = idx;
+
+			idx += ((idx < 365) ? 364 : -365);
+			state[i] = curlTruthTable[copy[prev] + (copy[idx] << 2) + 5];
+		}
+	}
+}
+
+static void charsToTrits(const char *chars, int8_t *trits, unsigned int len) {
+	for (unsigned int i = 0; i < len; i++) {
+		int value = ((chars[i] == '9') ? 0 : (chars[i] - 'A' + 1));
+
+		if (value > 13) {
+			value -= 27;
+		}
+		for (int j = 0; j < 3; j++) {
+			int trit = value % 3;
+
+			if (trit > 1) {
+				trit -= 3;
+			}
+			else if (trit < -1) {
+				trit += 3;
+			}
+			*trits++ = trit;
+			value = (value - trit) / 3;
+		}
+	}
+}
+
+static void tritsToChars(const int8_t *trits, char *chars, unsigned int len) {
+	for (unsigned int i = 0; i < len; i++) {
+		int value = trits[0] + 3 * trits[1] + 9 * trits[2];
+
+		if (value < 0) {
+			value += 27;
+		}
+		chars[i] = ((value == 0) ? '9' : ('A' + value - 1));
+		trits += 3;
+	}
+}
+
+void iotaCurlHash(const char *trytes, unsigned int len, char *hash) {
+	int8_t state[CURL_STATE_TRITS];
+
+	memset(state, 0, sizeof(state));
+	for (unsigned int i = 0; i < len; i += NUM_HASH_TRYTES) {
+		charsToTrits(trytes + i, state, NUM_HASH_TRYTES);
+		curlTransform(state);
+	}
+	tritsToChars(state, hash, NUM_HASH_TRYTES);
+}
+
+void iotaCurlTxHash(const char *tx, char *hash) {
+	iotaCurlHash(tx, NUM_TRANSACTION_TRYTES, hash);
+}
@@ -0,0 +1,49 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _IOTA_CURL_H_
+#define _IOTA_CURL_H_
+
+#include <stdint.h>
+
+/** Compute the Curl-P-81 hash of a sequence of trytes
+      @param trytes  Tryte characters to be hashed; their number must be a
+             multiple of 81
+      @param len  Number of tryte characters
+      @param hash  Buffer that is filled with the 81-character hash (no string
+             terminator is appended)
+      @return none
+*/
+void iotaCurlHash(const char *trytes, unsigned int len, char *hash);
+
+/** Compute the hash of a transaction
+      @param tx  Transaction trytes (2673 characters)
+      @param hash  Buffer that is filled with the 81-character transaction hash
+             (no string terminator is appended)
+      @return none
+*/
+void iotaCurlTxHash(const char *tx, char *hash);
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _IOTA_HASH_LIST_H_
+#define _IOTA_HASH_LIST_H_
+
+#include <string.h>
+
+/* Room for an 81-tryte hash or address plus string terminator. */
+#define IOTAHASHLIST_ENTRY_SIZE	82
+
+/** List of hashes or addresses with caller-supplied fixed storage
+      Entries are null-terminated 81-character strings; no heap memory is
+      allocated. Use IotaHashArray to declare a list with a given capacity.
+*/
+class IotaHashList {
+public:
+
+	/** Retrieve number of entries in the list
+      @return number of entries
+	*/
+	unsigned int size() const {
+		return _size;
+	}
+
+	/** Retrieve maximum number of entries in the list
+      @return list capacity
+	*/
+	unsigned int capacity() const {
+		return _capacity;
+	}
+
+	/** Remove all entries from the list
+      @return none
+	*/
+	void clear() {
+		_size = 0;
+	}
+
+	/** Append an entry to the list
+      @param hash  Hash or address; at most the first 81 characters are
+             copied
+      @return true if the entry has been appended, false if the list is full
+	*/
+	bool add(const char *hash) {
+		char *entry = append();
+
+		if (!entry) {
+			return false;
+		}
+		strncpy(entry, hash, IOTAHASHLIST_ENTRY_SIZE - 1);
+		return true;
+	}
+
+	/** Append an entry to be filled by the caller
+      @return pointer to a buffer where 81 characters can be written (the
+              string terminator is already there), or NULL if the list is full
+	*/
+	char *append() {
+		if (_size == _capacity) {
+			return 0;
+		}
+		char *entry = _entries[_size++];
+
+		entry[IOTAHASHLIST_ENTRY_SIZE - 1] = '\0';
+		return entry;
+	}
+
+	/** Retrieve an entry of the list
+      @param index  Entry index, from 0 to size() - 1
+      @return null-terminated entry
+	*/
+	const char *operator[](unsigned int index) const {
+		return _entries[index];
+	}
+
+protected:
+	IotaHashList(char (*entries)[IOTAHASHLIST_ENTRY_SIZE],
+			unsigned int capacity) :
+		_entries(entries), _capacity(capacity), _size(0) {}
+
+private:
+	IotaHashList(const IotaHashList &);
+	IotaHashList &operator=(const IotaHashList &);
+
+	char (*_entries)[IOTAHASHLIST_ENTRY_SIZE];
+	unsigned int _capacity;
+	unsigned int _size;
+};
+
+/** List of hashes or addresses with storage for a fixed number of entries */
+template <unsigned int Capacity>
+class IotaHashArray : public IotaHashList {
+public:
+	IotaHashArray() : IotaHashList(_storage, Capacity) {}
+
+private:
+	char _storage[Capacity][IOTAHASHLIST_ENTRY_SIZE];
+};
+
+#endif
@@ -0,0 +1,292 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+#include "IotaHeap.h"
+
+#if defined(IOTA_NO_HEAP_ASSERT) || defined(IOTA_HEAP_STATS)
+
+#if defined(ESP32) || defined(__linux__)
+#define IOTAHEAP_THREAD_LOCAL	__thread
+#else
+#define IOTAHEAP_THREAD_LOCAL
+#endif
+
+static IOTAHEAP_THREAD_LOCAL unsigned long iotaHeapAllocs;
+
+#ifdef IOTA_HEAP_STATS
+
+#ifndef IOTA_HEAP_BLOCK_SIZE
+#if defined(ESP32)
+#include <esp_heap_caps.h>
+#define IOTA_HEAP_BLOCK_SIZE(ptr)	heap_caps_get_allocated_size(ptr)
+#elif defined(__linux__) || (defined(__NEWLIB__) && !defined(ESP8266))
+#include <malloc.h>
+#define IOTA_HEAP_BLOCK_SIZE(ptr)	malloc_usable_size(ptr)
+#else
+#error "IOTA_HEAP_BLOCK_SIZE(ptr) must be defined on this platform"
+#endif
+#endif
+
+static IOTAHEAP_THREAD_LOCAL unsigned long iotaHeapBytes;
+static IOTAHEAP_THREAD_LOCAL long iotaHeapCurBytes;
+static IOTAHEAP_THREAD_LOCAL long iotaHeapPeakBytes;
+static IOTAHEAP_THREAD_LOCAL unsigned int iotaHeapActiveOps;
+static IOTAHEAP_THREAD_LOCAL struct iotaHeapStats
+		iotaHeapOpStats[IOTA_HEAP_OP_COUNT];
+
+static void iotaHeapAccount(void *ptr, size_t size) {
+	iotaHeapAllocs++;
+	iotaHeapBytes += size;
+	iotaHeapCurBytes += IOTA_HEAP_BLOCK_SIZE(ptr);
+	if (iotaHeapCurBytes > iotaHeapPeakBytes) {
+		iotaHeapPeakBytes = iotaHeapCurBytes;
+	}
+}
+
+#define IOTAHEAP_ALLOCATED(ptr, size)	iotaHeapAccount(ptr, size)
+#define IOTAHEAP_BLOCK(ptr)	((ptr) ? IOTA_HEAP_BLOCK_SIZE(ptr) : 0)
+#define IOTAHEAP_RELEASED(bytes)	(iotaHeapCurBytes -= (bytes))
+
+#else
+
+#define IOTAHEAP_ALLOCATED(ptr, size)	iotaHeapAllocs++
+#define IOTAHEAP_BLOCK(ptr)	0
+#define IOTAHEAP_RELEASED(bytes)	(void)(bytes)
+
+#endif
+
+extern "C" {
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t num, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size) {
+	void *ptr = __real_malloc(size);
+
+	if (ptr) {
+		IOTAHEAP_ALLOCATED(ptr, size);
+	}
+	return ptr;
+}
+
+void *__wrap_calloc(size_t num, size_t size) {
+	void *ptr = __real_calloc(num, size);
+
+	if (ptr) {
+		IOTAHEAP_ALLOCATED(ptr, num * size);
+	}
+	return ptr;
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+	size_t oldBytes = IOTAHEAP_BLOCK(ptr);
+	void *newPtr = __real_realloc(ptr, size);
+
+	if (newPtr && (size != 0)) {
+		IOTAHEAP_RELEASED(oldBytes);
+		IOTAHEAP_ALLOCATED(newPtr, size);
+	}
+	else if (size == 0) {
+		IOTAHEAP_RELEASED(oldBytes);
+	}
+	return newPtr;
+}
+
+void __wrap_free(void *ptr) {
+	IOTAHEAP_RELEASED(IOTAHEAP_BLOCK(ptr));
+	__real_free(ptr);
+}
+
+}
+
+/* Replacements of the global allocation functions: calls from code that is
+ * not linked with --wrap (e.g. a shared libstdc++) resolve to these too, and
+ * end up in the wrapped allocator. */
+static void *iotaHeapNew(size_t size) {
+	void *ptr = malloc(size ? size : 1);
+
+	if (!ptr) {
+#ifdef __cpp_exceptions
+		throw std::bad_alloc();
+#else
+		abort();
+#endif
+	}
+	return ptr;
+}
+
+void *operator new(size_t size) {
+	return iotaHeapNew(size);
+}
+
+void *operator new[](size_t size) {
+	return iotaHeapNew(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+	return malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+	return malloc(size ? size : 1);
+}
+
+void operator delete(void *ptr) noexcept {
+	free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+	free(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+	free(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+	free(ptr);
+}
+
+unsigned long iotaHeapAllocCount() {
+	return iotaHeapAllocs;
+}
+
+template<typename T>
+static void iotaHeapSwap(T &a, T &b) {
+	T tmp = a;
+
+	a = b;
+	b = tmp;
+}
+
+void iotaHeapSwapContext(struct iotaHeapContext &context) {
+	iotaHeapSwap(context.allocs, iotaHeapAllocs);
+#ifdef IOTA_HEAP_STATS
+	iotaHeapSwap(context.bytes, iotaHeapBytes);
+	iotaHeapSwap(context.curBytes, iotaHeapCurBytes);
+	iotaHeapSwap(context.peakBytes, iotaHeapPeakBytes);
+	iotaHeapSwap(context.activeOps, iotaHeapActiveOps);
+#endif
+}
+
+#else
+
+unsigned long iotaHeapAllocCount() {
+	return 0;
+}
+
+void iotaHeapSwapContext(struct iotaHeapContext &) {
+}
+
+#endif
+
+#ifdef IOTA_HEAP_STATS
+
+bool iotaHeapGetStats(enum iotaHeapOp op, struct iotaHeapStats &stats) {
+	if ((unsigned int)op >= IOTA_HEAP_OP_COUNT) {
+		return false;
+	}
+	stats = iotaHeapOpStats[op];
+	return true;
+}
+
+void iotaHeapResetStats() {
+	memset(iotaHeapOpStats, 0, sizeof(iotaHeapOpStats));
+}
+
+IotaHeapScope::IotaHeapScope(enum iotaHeapOp op) : _op(op) {
+	_outer = !(iotaHeapActiveOps & (1 << op));
+	if (!_outer) {
+		return;
+	}
+	iotaHeapActiveOps |= (1 << op);
+	_allocs = iotaHeapAllocs;
+	_totalBytes = iotaHeapBytes;
+	_startBytes = iotaHeapCurBytes;
+	_outerPeak = iotaHeapPeakBytes;
+	iotaHeapPeakBytes = iotaHeapCurBytes;
+}
+
+IotaHeapScope::~IotaHeapScope() {
+	struct iotaHeapStats *stats = &iotaHeapOpStats[_op];
+
+	if (!_outer) {
+		return;
+	}
+	iotaHeapActiveOps &= ~(1 << _op);
+	stats->calls++;
+	stats->allocs = iotaHeapAllocs - _allocs;
+	stats->totalBytes = iotaHeapBytes - _totalBytes;
+	stats->peakBytes = iotaHeapPeakBytes - _startBytes;
+	if (stats->peakBytes > stats->maxPeakBytes) {
+		stats->maxPeakBytes = stats->peakBytes;
+	}
+
+	/* Propagate the peak to enclosing scopes. */
+	if (_outerPeak > iotaHeapPeakBytes) {
+		iotaHeapPeakBytes = _outerPeak;
+	}
+}
+
+#else
+
+bool iotaHeapGetStats(enum iotaHeapOp, struct iotaHeapStats &) {
+	return false;
+}
+
+void iotaHeapResetStats() {
+}
+
+IotaHeapScope::IotaHeapScope(enum iotaHeapOp op) : _op(op) {
+	_outer = false;
+}
+
+IotaHeapScope::~IotaHeapScope() {
+}
+
+#endif
+
+IotaNoHeapScope::IotaNoHeapScope(const char *name) : _name(name) {
+	_allocs = iotaHeapAllocCount();
+}
+
+IotaNoHeapScope::~IotaNoHeapScope() {
+	unsigned long allocs = iotaHeapAllocCount() - _allocs;
+
+	/* Check before reporting, since printf() may allocate; the report is
+	 * only reached when assertions are disabled. */
+	assert(allocs == 0);
+	if (allocs != 0) {
+		printf("%s: %lu heap allocations\n", _name, allocs);
+	}
+}
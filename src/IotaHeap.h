@@ -0,0 +1,168 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _IOTA_HEAP_H_
+#define _IOTA_HEAP_H_
+
+#include <stddef.h>
+
+/* Heap allocation checks and accounting
+ *
+ * When the library is built with IOTA_NO_HEAP_ASSERT defined, the
+ * allocation-free entry points of the library assert that no heap memory is
+ * allocated while they run. When the library is built with IOTA_HEAP_STATS
+ * defined, the heap usage of the main wallet and client operations is recorded
+ * and can be retrieved with iotaHeapGetStats(). In both cases, allocations are
+ * intercepted by wrapping the C allocator, so the application must be linked
+ * with:
+ *   -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free
+ * (e.g. in build_flags with PlatformIO). The global operator new and
+ * operator delete are replaced as well, so that allocations done by the C++
+ * runtime (including a shared libstdc++) are counted. Only allocations made by
+ * the calling thread are counted.
+ *
+ * The no-heap assertion covers address scans (getBalance() and
+ * getReceiveAddress() of IotaWallet) only: the transfer path (planTransfer()
+ * and sendTransfer()) still builds bundles and tryte strings on the heap, and
+ * is not checked.
+ *
+ * Heap accounting needs the size of allocated blocks, which is retrieved with
+ * heap_caps_get_allocated_size() on ESP32 and with malloc_usable_size() on
+ * Linux and newlib-based platforms; on other platforms, IOTA_HEAP_BLOCK_SIZE(ptr)
+ * must be defined to an expression returning the size of a heap block.
+ */
+
+enum iotaHeapOp {
+	IOTA_HEAP_OP_SCAN,		/* address scans (balance, receive address) */
+	IOTA_HEAP_OP_TRANSFER,	/* transfer creation, including attachment */
+	IOTA_HEAP_OP_ATTACH,	/* tip selection, Proof of Work and broadcast */
+	IOTA_HEAP_OP_FIND,		/* findTransactions command */
+	IOTA_HEAP_OP_COUNT
+};
+
+struct iotaHeapStats {
+	unsigned long calls;	/* number of completed operations */
+	unsigned long allocs;	/* allocations done by the last operation */
+	size_t totalBytes;		/* bytes allocated by the last operation */
+	size_t peakBytes;		/* peak heap usage of the last operation */
+	size_t maxPeakBytes;	/* highest peak heap usage over all operations */
+};
+
+/* Allocation counters of a cooperative task, see iotaHeapSwapContext(). */
+struct iotaHeapContext {
+	unsigned long allocs;
+	unsigned long bytes;
+	long curBytes;
+	long peakBytes;
+	unsigned int activeOps;
+};
+
+/** Exchange the allocation counters of the calling thread with those of a task
+      Allocations are counted per thread: applications that run multiple
+      cooperative tasks (e.g. fibers) on the same thread keep a zero-initialized
+      context for each task, and call this function with the context of a task
+      right before switching to it and right after switching back from it, so
+      that allocations are accounted to the task that makes them. Heap usage
+      statistics are still kept per thread. This function does nothing if the
+      library is built without IOTA_NO_HEAP_ASSERT and IOTA_HEAP_STATS.
+      @param context  Context of the task
+      @return none
+*/
+void iotaHeapSwapContext(struct iotaHeapContext &context);
+
+/** Retrieve number of heap allocations done by the calling thread
+      Allocations are only counted when the library is built with
+      IOTA_NO_HEAP_ASSERT or IOTA_HEAP_STATS defined; otherwise, this function
+      returns 0.
+      @return number of calls to malloc(), calloc() and realloc() that
+              allocated memory
+*/
+unsigned long iotaHeapAllocCount();
+
+/** Scope in which heap allocations are not allowed
+      When the scope is left, an assertion fails if the calling thread
+      allocated heap memory since the scope was entered.
+*/
+class IotaNoHeapScope {
+public:
+	IotaNoHeapScope(const char *name);
+	~IotaNoHeapScope();
+
+private:
+	const char *_name;
+	unsigned long _allocs;
+};
+
+/** Retrieve heap usage statistics of an operation
+      Peak usage is measured relative to the heap usage at the start of the
+      operation, so it is the amount of free heap memory the operation needs.
+      When operations are nested (e.g. address scans done while creating a
+      transfer), each one is accounted separately, and the outer operation
+      includes the usage of the inner ones. Statistics are kept per thread,
+      like the allocation counters, so this returns the statistics of the
+      operations run by the calling thread.
+      @param op  Operation
+      @param stats  Statistics of the operation
+      @return true if statistics are available, false if the library is built
+              without IOTA_HEAP_STATS or if the operation is invalid
+*/
+bool iotaHeapGetStats(enum iotaHeapOp op, struct iotaHeapStats &stats);
+
+/** Reset heap usage statistics of all operations run by the calling thread
+      @return none
+*/
+void iotaHeapResetStats();
+
+/** Scope in which heap usage is accounted to an operation
+      If a scope for the same operation is already active in the calling
+      thread, the new scope is not accounted separately.
+*/
+class IotaHeapScope {
+public:
+	IotaHeapScope(enum iotaHeapOp op);
+	~IotaHeapScope();
+
+private:
+	enum iotaHeapOp _op;
+	bool _outer;
+	unsigned long _allocs;
+	unsigned long _totalBytes;
+	long _startBytes;
+	long _outerPeak;
+};
+
+#ifdef IOTA_NO_HEAP_ASSERT
+#define IOTA_NO_HEAP_SCOPE()	IotaNoHeapScope iotaNoHeapScope(__FUNCTION__)
+#else
+#define IOTA_NO_HEAP_SCOPE()	do {} while (0)
+#endif
+
+#ifdef IOTA_HEAP_STATS
+#define IOTA_HEAP_SCOPE(op)	IotaHeapScope iotaHeapScope(op)
+#else
+#define IOTA_HEAP_SCOPE(op)	do {} while (0)
+#endif
+
+#endif
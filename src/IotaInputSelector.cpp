@@ -0,0 +1,190 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+
+#include "IotaInputSelector.h"
+
+static bool iotaBalanceDescending(const struct iotaAddrWithBalance &a,
+		const struct iotaAddrWithBalance &b) {
+	return (a.balance > b.balance);
+}
+
+static bool iotaBalanceAscending(const struct iotaAddrWithBalance &a,
+		const struct iotaAddrWithBalance &b) {
+	return (a.balance < b.balance);
+}
+
+static bool iotaAddrIdxAscending(const struct iotaAddrWithBalance &a,
+		const struct iotaAddrWithBalance &b) {
+	return (a.addrIdx < b.addrIdx);
+}
+
+bool IotaFewestInputsSelector::select(
+		const std::vector<struct iotaAddrWithBalance> &available,
+		uint64_t value, unsigned int maxInputs,
+		std::vector<struct iotaAddrWithBalance> &selected) {
+	std::vector<struct iotaAddrWithBalance> sorted(available);
+	uint64_t total = 0;
+	unsigned int count;
+
+	selected.clear();
+	if (value == 0) {
+		return true;
+	}
+	std::sort(sorted.begin(), sorted.end(), iotaBalanceDescending);
+	for (count = 0; (count < sorted.size()) && (total < value); count++) {
+		total += sorted[count].balance;
+	}
+	if ((total < value) || (count > maxInputs)) {
+		return false;
+	}
+
+	/* Replace the smallest selected input with the smallest one that still
+	 * covers the requested amount, in order to minimize the change. */
+	uint64_t partial = total - sorted[count - 1].balance;
+	unsigned int last = count - 1;
+
+	for (unsigned int i = count; i < sorted.size(); i++) {
+		if (partial + sorted[i].balance < value) {
+			break;
+		}
+		last = i;
+	}
+	selected.assign(sorted.begin(), sorted.begin() + count - 1);
+	selected.push_back(sorted[last]);
+	std::sort(selected.begin(), selected.end(), iotaAddrIdxAscending);
+	return true;
+}
+
+IotaExactMatchSelector::IotaExactMatchSelector(unsigned int maxSteps) {
+	_maxSteps = maxSteps;
+}
+
+bool IotaExactMatchSelector::select(
+		const std::vector<struct iotaAddrWithBalance> &available,
+		uint64_t value, unsigned int maxInputs,
+		std::vector<struct iotaAddrWithBalance> &selected) {
+	std::vector<struct iotaAddrWithBalance> sorted(available);
+
+	std::sort(sorted.begin(), sorted.end(), iotaBalanceDescending);
+	_steps = 0;
+
+	/* Look for exact matches with an increasing number of inputs, so that the
+	 * first match found is also the one with the fewest inputs. */
+	for (unsigned int depth = 1; (depth <= maxInputs) && (value != 0);
+			depth++) {
+		selected.clear();
+		if (search(sorted, 0, value, depth, selected)) {
+			std::sort(selected.begin(), selected.end(), iotaAddrIdxAscending);
+			return true;
+		}
+		if (_steps >= _maxSteps) {
+			break;
+		}
+	}
+	return IotaFewestInputsSelector::select(available, value, maxInputs,
+			selected);
+}
+
+bool IotaExactMatchSelector::search(
+		const std::vector<struct iotaAddrWithBalance> &sorted,
+		unsigned int start, uint64_t value, unsigned int depth,
+		std::vector<struct iotaAddrWithBalance> &selected) {
+	for (unsigned int i = start; i < sorted.size(); i++) {
+		uint64_t balance = sorted[i].balance;
+
+		if (++_steps > _maxSteps) {
+			return false;
+		}
+		if (balance > value) {
+			continue;
+		}
+		if (balance * depth < value) {
+			/* Remaining balances are too small to reach the amount. */
+			return false;
+		}
+		if (balance == value) {
+			selected.push_back(sorted[i]);
+			return true;
+		}
+		if (depth == 1) {
+			continue;
+		}
+		selected.push_back(sorted[i]);
+		if (search(sorted, i + 1, value - balance, depth - 1, selected)) {
+			return true;
+		}
+		selected.pop_back();
+	}
+	return false;
+}
+
+IotaDustConsolidator::IotaDustConsolidator(uint64_t dustThreshold) {
+	_dustThreshold = dustThreshold;
+	_idle = false;
+}
+
+void IotaDustConsolidator::setIdle(bool idle) {
+	_idle = idle;
+}
+
+bool IotaDustConsolidator::select(
+		const std::vector<struct iotaAddrWithBalance> &available,
+		uint64_t value, unsigned int maxInputs,
+		std::vector<struct iotaAddrWithBalance> &selected) {
+	std::vector<struct iotaAddrWithBalance> dust;
+
+	if (!IotaFewestInputsSelector::select(available, value, maxInputs,
+			selected)) {
+		return false;
+	}
+	if (!_idle || (value == 0)) {
+		return true;
+	}
+	for (auto it = available.cbegin(); it != available.cend(); it++) {
+		bool isSelected = false;
+
+		if (it->balance >= _dustThreshold) {
+			continue;
+		}
+		for (auto sel = selected.cbegin(); sel != selected.cend(); sel++) {
+			if (sel->addrIdx == it->addrIdx) {
+				isSelected = true;
+				break;
+			}
+		}
+		if (!isSelected) {
+			dust.push_back(*it);
+		}
+	}
+	std::sort(dust.begin(), dust.end(), iotaBalanceAscending);
+	for (auto it = dust.cbegin();
+			(it != dust.cend()) && (selected.size() < maxInputs); it++) {
+		selected.push_back(*it);
+	}
+	std::sort(selected.begin(), selected.end(), iotaAddrIdxAscending);
+	return true;
+}
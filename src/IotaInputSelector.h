@@ -0,0 +1,121 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _IOTA_INPUT_SELECTOR_H_
+#define _IOTA_INPUT_SELECTOR_H_
+
+#include <Arduino.h>
+#ifdef min
+#undef min
+#endif
+#ifdef max
+#undef max
+#endif
+#include <vector>
+
+#include "IotaWallet.h"
+
+class IotaInputSelector {
+public:
+
+	/** Select input addresses for a transfer
+      @param available  List of addresses derived from the seed that have a
+             positive balance, sorted by address index
+      @param value  IOTA amount that must be covered by the selected inputs
+      @param maxInputs  Maximum number of inputs that can be selected
+      @param selected  List to be filled with the selected inputs
+      @return true if a set of inputs covering the requested amount has been
+              selected, false otherwise
+	*/
+	virtual bool select(
+			const std::vector<struct iotaAddrWithBalance> &available,
+			uint64_t value, unsigned int maxInputs,
+			std::vector<struct iotaAddrWithBalance> &selected) = 0;
+};
+
+/* Selects the smallest possible number of inputs; among the sets with the
+ * smallest number of inputs, the one with the smallest change is preferred. */
+class IotaFewestInputsSelector : public IotaInputSelector {
+public:
+	bool select(const std::vector<struct iotaAddrWithBalance> &available,
+			uint64_t value, unsigned int maxInputs,
+			std::vector<struct iotaAddrWithBalance> &selected);
+};
+
+/* Looks for a set of inputs whose balance matches exactly the requested
+ * amount, so that no change transaction is needed; if no such set is found
+ * within a bounded search effort, falls back to the fewest inputs strategy. */
+class IotaExactMatchSelector : public IotaFewestInputsSelector {
+public:
+
+	/** Create an exact match input selector
+      @param maxSteps  Maximum number of search steps to be done when looking
+             for an exact match
+      @return none
+	*/
+	IotaExactMatchSelector(unsigned int maxSteps = 10000);
+
+	bool select(const std::vector<struct iotaAddrWithBalance> &available,
+			uint64_t value, unsigned int maxInputs,
+			std::vector<struct iotaAddrWithBalance> &selected);
+
+private:
+	bool search(const std::vector<struct iotaAddrWithBalance> &sorted,
+			unsigned int start, uint64_t value, unsigned int depth,
+			std::vector<struct iotaAddrWithBalance> &selected);
+	unsigned int _maxSteps, _steps;
+};
+
+/* Behaves as the fewest inputs strategy, but when the wallet is idle adds to
+ * the selected inputs as many addresses with a small balance ("dust") as the
+ * bundle can hold, so that their balance is consolidated in the change
+ * address. */
+class IotaDustConsolidator : public IotaFewestInputsSelector {
+public:
+
+	/** Create a dust consolidating input selector
+      @param dustThreshold  Addresses with a balance below this amount are
+             considered dust
+      @return none
+	*/
+	IotaDustConsolidator(uint64_t dustThreshold);
+
+	/** Configure idle state
+      @param idle  true if dust should be consolidated in subsequent transfers,
+             false otherwise
+      @return none
+	*/
+	void setIdle(bool idle);
+
+	bool select(const std::vector<struct iotaAddrWithBalance> &available,
+			uint64_t value, unsigned int maxInputs,
+			std::vector<struct iotaAddrWithBalance> &selected);
+
+private:
+	uint64_t _dustThreshold;
+	bool _idle;
+};
+
+#endif
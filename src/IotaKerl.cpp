@@ -0,0 +1,374 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "IotaKerl.h"
+
+#define KERL_CHUNK_BYTES	48
+#define KERL_RATE_BYTES		104	/* Keccak-384: 1600 - 2 * 384 bits */
+#define KERL_POW27_6		387420489UL
+
+/* Unbalanced value (i.e. balanced value plus 13) of tryte characters. */
+static const uint8_t kerlTryteDigits[128] = {
+	13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+	13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+	13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+	13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+	13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26,  0,  1,
+	 2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 13, 13, 13, 13,
+	13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+	13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13
+};
+
+static const char kerlDigitTrytes[] = "NOPQRSTUVWXYZ9ABCDEFGHIJKLM";
+
+/* (3^242 - 1) / 2 and 3^242, least significant word first. */
+static const uint32_t kerlHalf3[IOTAKERL_WORDS] = {
+	0xa5ce8964, 0x9f007669, 0x1484504f, 0x3ade00d9, 0x0c24486e, 0x50979d57,
+	0x79a4c702, 0x48bbae36, 0xa9f6808b, 0xaa06a805, 0xa87fabdf, 0x5e69ebef,
+};
+static const uint32_t kerlPow3[IOTAKERL_WORDS] = {
+	0x4b9d12c9, 0x3e00ecd3, 0x2908a09f, 0x75bc01b2, 0x184890dc, 0xa12f3aae,
+	0xf3498e04, 0x91775c6c, 0x53ed0116, 0x540d500b, 0x50ff57bf, 0xbcd3d7df,
+};
+
+static const uint64_t keccakRoundConstants[24] = {
+	0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL,
+	0x8000000080008000ULL, 0x000000000000808bULL, 0x0000000080000001ULL,
+	0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008aULL,
+	0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+	0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL,
+	0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
+	0x000000000000800aULL, 0x800000008000000aULL, 0x8000000080008081ULL,
+	0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL,
+};
+
+static const uint8_t keccakRotations[24] = {
+	1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14,
+	27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44,
+};
+
+static const uint8_t keccakPiLanes[24] = {
+	10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4,
+	15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1,
+};
+
+static inline uint64_t rotl64(uint64_t x, unsigned int n) {
+	return (x << n) | (x >> (64 - n));
+}
+
+static void wordsAdd(uint32_t *a, const uint32_t *b) {
+	uint64_t carry = 0;
+
+	for (int i = 0; i < IOTAKERL_WORDS; i++) {
+		carry += (uint64_t) a[i] + b[i];
+		a[i] = (uint32_t) carry;
+		carry >>= 32;
+	}
+}
+
+static void wordsSub(uint32_t *a, const uint32_t *b) {
+	uint64_t borrow = 0;
+
+	for (int i = 0; i < IOTAKERL_WORDS; i++) {
+		uint64_t diff = (uint64_t) a[i] - b[i] - borrow;
+
+		a[i] = (uint32_t) diff;
+		borrow = (diff >> 32) & 1;
+	}
+}
+
+static int wordsCmp(const uint32_t *a, const uint32_t *b) {
+	for (int i = IOTAKERL_WORDS - 1; i >= 0; i--) {
+		if (a[i] != b[i]) {
+			return ((a[i] > b[i]) ? 1 : -1);
+		}
+	}
+	return 0;
+}
+
+static void wordsNegate(uint32_t *a) {
+	uint64_t carry = 1;
+
+	for (int i = 0; i < IOTAKERL_WORDS; i++) {
+		carry += (uint32_t) ~a[i];
+		a[i] = (uint32_t) carry;
+		carry >>= 32;
+	}
+}
+
+/* a = a * mul + add */
+static void wordsMulAdd(uint32_t *a, uint32_t mul, uint32_t add) {
+	uint64_t carry = add;
+
+	for (int i = 0; i < IOTAKERL_WORDS; i++) {
+		carry += (uint64_t) a[i] * mul;
+		a[i] = (uint32_t) carry;
+		carry >>= 32;
+	}
+}
+
+/* a = a / div, returns remainder */
+static uint32_t wordsDiv(uint32_t *a, uint32_t div) {
+	uint64_t rem = 0;
+
+	for (int i = IOTAKERL_WORDS - 1; i >= 0; i--) {
+		uint64_t cur = (rem << 32) | a[i];
+
+		a[i] = (uint32_t) (cur / div);
+		rem = cur % div;
+	}
+	return (uint32_t) rem;
+}
+
+/* Reduce a value to the range [-(3^242 - 1) / 2, (3^242 - 1) / 2], i.e. the
+ * range representable with 242 balanced trits: since any 384-bit value is
+ * smaller than 3^242 in absolute value, at most one addition or subtraction
+ * of 3^242 is needed. */
+static void wordsReduce(uint32_t *a) {
+	uint32_t abs[IOTAKERL_WORDS];
+	bool negative = ((a[IOTAKERL_WORDS - 1] >> 31) != 0);
+
+	memcpy(abs, a, sizeof(abs));
+	if (negative) {
+		wordsNegate(abs);
+	}
+	if (wordsCmp(abs, kerlHalf3) <= 0) {
+		return;
+	}
+	if (negative) {
+		wordsAdd(a, kerlPow3);
+	}
+	else {
+		wordsSub(a, kerlPow3);
+	}
+}
+
+void iotaKerlTrytesToWords(const char *trytes, uint32_t *words) {
+	const uint8_t *digits = kerlTryteDigits;
+	int i;
+
+	/* The 242 trits are read as an unbalanced base-3 number (Horner's rule,
+	 * most significant tryte first, six trytes at a time), then the offset
+	 * introduced by unbalancing is subtracted. Only the two lower trits of
+	 * the last tryte are used. */
+	memset(words, 0, IOTAKERL_WORDS * sizeof(uint32_t));
+	words[0] = digits[trytes[80] & 0x7F] % 9;
+	for (i = 79; i >= 78; i--) {
+		wordsMulAdd(words, 27, digits[trytes[i] & 0x7F]);
+	}
+	for (i = 77; i >= 0; i -= 6) {
+		uint32_t group = 0;
+
+		for (int j = 0; j < 6; j++) {
+			group = group * 27 + digits[trytes[i - j] & 0x7F];
+		}
+		wordsMulAdd(words, KERL_POW27_6, group);
+	}
+	wordsSub(words, kerlHalf3);
+}
+
+void iotaKerlWordsToTrytes(const uint32_t *words, char *trytes) {
+	uint32_t base[IOTAKERL_WORDS];
+	bool flip = false;
+
+	/* Same algorithm as the IOTA reference implementation, extracting six
+	 * trytes per division. */
+	memcpy(base, words, sizeof(base));
+	if ((base[IOTAKERL_WORDS - 1] >> 31) == 0) {
+		wordsAdd(base, kerlHalf3);
+	}
+	else {
+		for (int i = 0; i < IOTAKERL_WORDS; i++) {
+			base[i] = ~base[i];
+		}
+		if (wordsCmp(base, kerlHalf3) > 0) {
+			wordsSub(base, kerlHalf3);
+			flip = true;
+		}
+		else {
+			uint32_t tmp[IOTAKERL_WORDS];
+			static const uint32_t one[IOTAKERL_WORDS] = {1};
+
+			wordsAdd(base, one);
+			memcpy(tmp, kerlHalf3, sizeof(tmp));
+			wordsSub(tmp, base);
+			memcpy(base, tmp, sizeof(base));
+		}
+	}
+	for (int i = 0; i < 78; i += 6) {
+		uint32_t group = wordsDiv(base, KERL_POW27_6);
+
+		for (int j = 0; j < 6; j++) {
+			trytes[i + j] = group % 27;
+			group /= 27;
+		}
+	}
+	uint32_t rem = wordsDiv(base, 27 * 27 * 9);
+	trytes[78] = rem % 27;
+	trytes[79] = (rem / 27) % 27;
+
+	/* Last tryte: two trits from the remaining base-9 digit, third trit 0. */
+	trytes[80] = (rem / (27 * 27)) + 9;
+	for (int i = 0; i < 81; i++) {
+		int digit = trytes[i];
+
+		trytes[i] = kerlDigitTrytes[flip ? (26 - digit) : digit];
+	}
+}
+
+static void wordsToBytes(const uint32_t *words, uint8_t *bytes) {
+	for (int i = 0; i < IOTAKERL_WORDS; i++) {
+		uint32_t word = words[IOTAKERL_WORDS - 1 - i];
+
+		bytes[4 * i] = word >> 24;
+		bytes[4 * i + 1] = word >> 16;
+		bytes[4 * i + 2] = word >> 8;
+		bytes[4 * i + 3] = word;
+	}
+}
+
+static void bytesToWords(const uint8_t *bytes, uint32_t *words) {
+	for (int i = 0; i < IOTAKERL_WORDS; i++) {
+		words[IOTAKERL_WORDS - 1 - i] = ((uint32_t) bytes[4 * i] << 24) |
+				((uint32_t) bytes[4 * i + 1] << 16) |
+				((uint32_t) bytes[4 * i + 2] << 8) | bytes[4 * i + 3];
+	}
+}
+
+IotaKerl::IotaKerl() {
+	reset();
+}
+
+void IotaKerl::reset() {
+	memset(_state, 0, sizeof(_state));
+	_pos = 0;
+}
+
+void IotaKerl::absorb(const char *trytes, unsigned int len) {
+	uint32_t words[IOTAKERL_WORDS];
+
+	for (unsigned int i = 0; i + 81 <= len; i += 81) {
+		iotaKerlTrytesToWords(trytes + i, words);
+		absorbWords(words);
+	}
+}
+
+void IotaKerl::absorbWords(const uint32_t *words) {
+	uint8_t bytes[KERL_CHUNK_BYTES];
+
+	wordsToBytes(words, bytes);
+	for (int i = 0; i < KERL_CHUNK_BYTES; i++) {
+		_state[_pos / 8] ^= (uint64_t) bytes[i] << (8 * (_pos % 8));
+		if (++_pos == KERL_RATE_BYTES) {
+			permute();
+			_pos = 0;
+		}
+	}
+}
+
+void IotaKerl::squeeze(char *hash) {
+	uint32_t words[IOTAKERL_WORDS];
+
+	squeezeWords(words);
+	iotaKerlWordsToTrytes(words, hash);
+}
+
+void IotaKerl::squeezeWords(uint32_t *words) {
+	uint8_t bytes[KERL_CHUNK_BYTES];
+
+	/* Original Keccak padding (as opposed to SHA-3 padding). */
+	_state[_pos / 8] ^= (uint64_t) 0x01 << (8 * (_pos % 8));
+	_state[(KERL_RATE_BYTES - 1) / 8] ^=
+			(uint64_t) 0x80 << (8 * ((KERL_RATE_BYTES - 1) % 8));
+	permute();
+	for (int i = 0; i < KERL_CHUNK_BYTES; i++) {
+		bytes[i] = _state[i / 8] >> (8 * (i % 8));
+	}
+	bytesToWords(bytes, words);
+
+	/* The hash is converted to 242 trits (last trit set to 0). */
+	wordsReduce(words);
+	reset();
+}
+
+void IotaKerl::hashWords(uint32_t *words, unsigned int count) {
+	IotaKerl kerl;
+
+	for (unsigned int i = 0; i < count; i++) {
+		kerl.absorbWords(words);
+		kerl.squeezeWords(words);
+	}
+}
+
+void IotaKerl::permute() {
+	uint64_t *a = _state;
+	uint64_t c[5];
+
+	for (int round = 0; round < 24; round++) {
+		/* Theta */
+		for (int x = 0; x < 5; x++) {
+			c[x] = a[x] ^ a[x + 5] ^ a[x + 10] ^ a[x + 15] ^ a[x + 20];
+		}
+		for (int x = 0; x < 5; x++) {
+			uint64_t d = c[(x + 4) % 5] ^ rotl64(c[(x + 1) % 5], 1);
+
+			for (int y = 0; y < 25; y += 5) {
+				a[y + x] ^= d;
+			}
+		}
+
+		/* Rho and Pi */
+		uint64_t t = a[1];
+		for (int i = 0; i < 24; i++) {
+			int lane = keccakPiLanes[i];
+			uint64_t tmp = a[lane];
+
+			a[lane] = rotl64(t, keccakRotations[i]);
+			t = tmp;
+		}
+
+		/* Chi */
+		for (int y = 0; y < 25; y += 5) {
+			for (int x = 0; x < 5; x++) {
+				c[x] = a[y + x];
+			}
+			for (int x = 0; x < 5; x++) {
+				a[y + x] = c[x] ^ ((~c[(x + 1) % 5]) & c[(x + 2) % 5]);
+			}
+		}
+
+		/* Iota */
+		a[0] ^= keccakRoundConstants[round];
+	}
+}
+
+void iotaKerlHash(const char *trytes, unsigned int len, char *hash) {
+	IotaKerl kerl;
+
+	kerl.absorb(trytes, len);
+	kerl.squeeze(hash);
+}
@@ -0,0 +1,123 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _IOTA_KERL_H_
+#define _IOTA_KERL_H_
+
+#include <stdint.h>
+
+/* Number of 32-bit words of a 243-trit Kerl chunk in binary form. */
+#define IOTAKERL_WORDS	12
+
+/** Convert 81 trytes into the binary form used by Kerl
+      The last trit of the trytes is ignored.
+      @param trytes  Tryte characters (81)
+      @param words  Buffer that is filled with a 384-bit two's complement
+             integer, least significant word first
+      @return none
+*/
+void iotaKerlTrytesToWords(const char *trytes, uint32_t *words);
+
+/** Convert the binary form used by Kerl into 81 trytes
+      Values outside the range representable with 242 trits are reduced as
+      done by the IOTA reference implementation; the last trit is set to 0.
+      @param words  384-bit two's complement integer, least significant word
+             first
+      @param trytes  Buffer that is filled with 81 tryte characters (no string
+             terminator is appended)
+      @return none
+*/
+void iotaKerlWordsToTrytes(const uint32_t *words, char *trytes);
+
+class IotaKerl {
+public:
+
+	/** Create a Kerl sponge
+      Kerl is the Keccak-384 based hash function used by IOTA for bundle
+      hashes, addresses and signatures.
+      @return none
+	*/
+	IotaKerl();
+
+	/** Reset the sponge to its initial state
+      @return none
+	*/
+	void reset();
+
+	/** Absorb trytes into the sponge
+      @param trytes  Tryte characters; their number must be a multiple of 81
+      @param len  Number of tryte characters
+      @return none
+	*/
+	void absorb(const char *trytes, unsigned int len);
+
+	/** Absorb a chunk in binary form into the sponge
+      @param words  Chunk converted with iotaKerlTrytesToWords() or returned by
+             squeezeWords()
+      @return none
+	*/
+	void absorbWords(const uint32_t *words);
+
+	/** Squeeze a 243-trit hash out of the sponge
+      The sponge is reset after squeezing.
+      @param hash  Buffer that is filled with 81 tryte characters (no string
+             terminator is appended)
+      @return none
+	*/
+	void squeeze(char *hash);
+
+	/** Squeeze a 243-trit hash in binary form out of the sponge
+      The returned value is already reduced to the range representable with
+      242 trits, so it can be absorbed again without conversion to trytes. The
+      sponge is reset after squeezing.
+      @param words  Buffer that is filled with the hash in binary form
+      @return none
+	*/
+	void squeezeWords(uint32_t *words);
+
+	/** Hash a chunk in binary form repeatedly
+      @param words  Chunk in binary form, replaced with its hash
+      @param count  Number of times the chunk is hashed
+      @return none
+	*/
+	static void hashWords(uint32_t *words, unsigned int count);
+
+private:
+	void permute();
+	uint64_t _state[25];
+	unsigned int _pos;
+};
+
+/** Compute the Kerl hash of a sequence of trytes
+      @param trytes  Tryte characters to be hashed; their number must be a
+             multiple of 81
+      @param len  Number of tryte characters
+      @param hash  Buffer that is filled with the 81-character hash (no string
+             terminator is appended)
+      @return none
+*/
+void iotaKerlHash(const char *trytes, unsigned int len, char *hash);
+
+#endif
@@ -0,0 +1,585 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "IotaPackedTx.h"
+#include "IotaTrytes.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "iota-c-library/src/iota/common.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+#define IOTAPACKED_MAX_BYTE	121
+
+/* Trits of each byte value, indexed by value + 121. */
+static const int8_t byteTrits[2 * IOTAPACKED_MAX_BYTE + 1][5] = {
+	{-1, -1, -1, -1, -1},
+	{ 0, -1, -1, -1, -1},
+	{ 1, -1, -1, -1, -1},
+	{-1,  0, -1, -1, -1},
+	{ 0,  0, -1, -1, -1},
+	{ 1,  0, -1, -1, -1},
+	{-1,  1, -1, -1, -1},
+	{ 0,  1, -1, -1, -1},
+	{ 1,  1, -1, -1, -1},
+	{-1, -1,  0, -1, -1},
+	{ 0, -1,  0, -1, -1},
+	{ 1, -1,  0, -1, -1},
+	{-1,  0,  0, -1, -1},
+	{ 0,  0,  0, -1, -1},
+	{ 1,  0,  0, -1, -1},
+	{-1,  1,  0, -1, -1},
+	{ 0,  1,  0, -1, -1},
+	{ 1,  1,  0, -1, -1},
+	{-1, -1,  1, -1, -1},
+	{ 0, -1,  1, -1, -1},
+	{ 1, -1,  1, -1, -1},
+	{-1,  0,  1, -1, -1},
+	{ 0,  0,  1, -1, -1},
+	{ 1,  0,  1, -1, -1},
+	{-1,  1,  1, -1, -1},
+	{ 0,  1,  1, -1, -1},
+	{ 1,  1,  1, -1, -1},
+	{-1, -1, -1,  0, -1},
+	{ 0, -1, -1,  0, -1},
+	{ 1, -1, -1,  0, -1},
+	{-1,  0, -1,  0, -1},
+	{ 0,  0, -1,  0, -1},
+	{ 1,  0, -1,  0, -1},
+	{-1,  1, -1,  0, -1},
+	{ 0,  1, -1,  0, -1},
+	{ 1,  1, -1,  0, -1},
+	{-1, -1,  0,  0, -1},
+	{ 0, -1,  0,  0, -1},
+	{ 1, -1,  0,  0, -1},
+	{-1,  0,  0,  0, -1},
+	{ 0,  0,  0,  0, -1},
+	{ 1,  0,  0,  0, -1},
+	{-1,  1,  0,  0, -1},
+	{ 0,  1,  0,  0, -1},
+	{ 1,  1,  0,  0, -1},
+	{-1, -1,  1,  0, -1},
+	{ 0, -1,  1,  0, -1},
+	{ 1, -1,  1,  0, -1},
+	{-1,  0,  1,  0, -1},
+	{ 0,  0,  1,  0, -1},
+	{ 1,  0,  1,  0, -1},
+	{-1,  1,  1,  0, -1},
+	{ 0,  1,  1,  0, -1},
+	{ 1,  1,  1,  0, -1},
+	{-1, -1, -1,  1, -1},
+	{ 0, -1, -1,  1, -1},
+	{ 1, -1, -1,  1, -1},
+	{-1,  0, -1,  1, -1},
+	{ 0,  0, -1,  1, -1},
+	{ 1,  0, -1,  1, -1},
+	{-1,  1, -1,  1, -1},
+	{ 0,  1, -1,  1, -1},
+	{ 1,  1, -1,  1, -1},
+	{-1, -1,  0,  1, -1},
+	{ 0, -1,  0,  1, -1},
+	{ 1, -1,  0,  1, -1},
+	{-1,  0,  0,  1, -1},
+	{ 0,  0,  0,  1, -1},
+	{ 1,  0,  0,  1, -1},
+	{-1,  1,  0,  1, -1},
+	{ 0,  1,  0,  1, -1},
+	{ 1,  1,  0,  1, -1},
+	{-1, -1,  1,  1, -1},
+	{ 0, -1,  1,  1, -1},
+	{ 1, -1,  1,  1, -1},
+	{-1,  0,  1,  1, -1},
+	{ 0,  0,  1,  1, -1},
+	{ 1,  0,  1,  1, -1},
+	{-1,  1,  1,  1, -1},
+	{ 0,  1,  1,  1, -1},
+	{ 1,  1,  1,  1, -1},
+	{-1, -1, -1, -1,  0},
+	{ 0, -1, -1, -1,  0},
+	{ 1, -1, -1, -1,  0},
+	{-1,  0, -1, -1,  0},
+	{ 0,  0, -1, -1,  0},
+	{ 1,  0, -1, -1,  0},
+	{-1,  1, -1, -1,  0},
+	{ 0,  1, -1, -1,  0},
+	{ 1,  1, -1, -1,  0},
+	{-1, -1,  0, -1,  0},
+	{ 0, -1,  0, -1,  0},
+	{ 1, -1,  0, -1,  0},
+	{-1,  0,  0, -1,  0},
+	{ 0,  0,  0, -1,  0},
+	{ 1,  0,  0, -1,  0},
+	{-1,  1,  0, -1,  0},
+	{ 0,  1,  0, -1,  0},
+	{ 1,  1,  0, -1,  0},
+	{-1, -1,  1, -1,  0},
+	{ 0, -1,  1, -1,  0},
+	{ 1, -1,  1, -1,  0},
+	{-1,  0,  1, -1,  0},
+	{ 0,  0,  1, -1,  0},
+	{ 1,  0,  1, -1,  0},
+	{-1,  1,  1, -1,  0},
+	{ 0,  1,  1, -1,  0},
+	{ 1,  1,  1, -1,  0},
+	{-1, -1, -1,  0,  0},
+	{ 0, -1, -1,  0,  0},
+	{ 1, -1, -1,  0,  0},
+	{-1,  0, -1,  0,  0},
+	{ 0,  0, -1,  0,  0},
+	{ 1,  0, -1,  0,  0},
+	{-1,  1, -1,  0,  0},
+	{ 0,  1, -1,  0,  0},
+	{ 1,  1, -1,  0,  0},
+	{-1, -1,  0,  0,  0},
+	{ 0, -1,  0,  0,  0},
+	{ 1, -1,  0,  0,  0},
+	{-1,  0,  0,  0,  0},
+	{ 0,  0,  0,  0,  0},
+	{ 1,  0,  0,  0,  0},
+	{-1,  1,  0,  0,  0},
+	{ 0,  1,  0,  0,  0},
+	{ 1,  1,  0,  0,  0},
+	{-1, -1,  1,  0,  0},
+	{ 0, -1,  1,  0,  0},
+	{ 1, -1,  1,  0,  0},
+	{-1,  0,  1,  0,  0},
+	{ 0,  0,  1,  0,  0},
+	{ 1,  0,  1,  0,  0},
+	{-1,  1,  1,  0,  0},
+	{ 0,  1,  1,  0,  0},
+	{ 1,  1,  1,  0,  0},
+	{-1, -1, -1,  1,  0},
+	{ 0, -1, -1,  1,  0},
+	{ 1, -1, -1,  1,  0},
+	{-1,  0, -1,  1,  0},
+	{ 0,  0, -1,  1,  0},
+	{ 1,  0, -1,  1,  0},
+	{-1,  1, -1,  1,  0},
+	{ 0,  1, -1,  1,  0},
+	{ 1,  1, -1,  1,  0},
+	{-1, -1,  0,  1,  0},
+	{ 0, -1,  0,  1,  0},
+	{ 1, -1,  0,  1,  0},
+	{-1,  0,  0,  1,  0},
+	{ 0,  0,  0,  1,  0},
+	{ 1,  0,  0,  1,  0},
+	{-1,  1,  0,  1,  0},
+	{ 0,  1,  0,  1,  0},
+	{ 1,  1,  0,  1,  0},
+	{-1, -1,  1,  1,  0},
+	{ 0, -1,  1,  1,  0},
+	{ 1, -1,  1,  1,  0},
+	{-1,  0,  1,  1,  0},
+	{ 0,  0,  1,  1,  0},
+	{ 1,  0,  1,  1,  0},
+	{-1,  1,  1,  1,  0},
+	{ 0,  1,  1,  1,  0},
+	{ 1,  1,  1,  1,  0},
+	{-1, -1, -1, -1,  1},
+	{ 0, -1, -1, -1,  1},
+	{ 1, -1, -1, -1,  1},
+	{-1,  0, -1, -1,  1},
+	{ 0,  0, -1, -1,  1},
+	{ 1,  0, -1, -1,  1},
+	{-1,  1, -1, -1,  1},
+	{ 0,  1, -1, -1,  1},
+	{ 1,  1, -1, -1,  1},
+	{-1, -1,  0, -1,  1},
+	{ 0, -1,  0, -1,  1},
+	{ 1, -1,  0, -1,  1},
+	{-1,  0,  0, -1,  1},
+	{ 0,  0,  0, -1,  1},
+	{ 1,  0,  0, -1,  1},
+	{-1,  1,  0, -1,  1},
+	{ 0,  1,  0, -1,  1},
+	{ 1,  1,  0, -1,  1},
+	{-1, -1,  1, -1,  1},
+	{ 0, -1,  1, -1,  1},
+	{ 1, -1,  1, -1,  1},
+	{-1,  0,  1, -1,  1},
+	{ 0,  0,  1, -1,  1},
+	{ 1,  0,  1, -1,  1},
+	{-1,  1,  1, -1,  1},
+	{ 0,  1,  1, -1,  1},
+	{ 1,  1,  1, -1,  1},
+	{-1, -1, -1,  0,  1},
+	{ 0, -1, -1,  0,  1},
+	{ 1, -1, -1,  0,  1},
+	{-1,  0, -1,  0,  1},
+	{ 0,  0, -1,  0,  1},
+	{ 1,  0, -1,  0,  1},
+	{-1,  1, -1,  0,  1},
+	{ 0,  1, -1,  0,  1},
+	{ 1,  1, -1,  0,  1},
+	{-1, -1,  0,  0,  1},
+	{ 0, -1,  0,  0,  1},
+	{ 1, -1,  0,  0,  1},
+	{-1,  0,  0,  0,  1},
+	{ 0,  0,  0,  0,  1},
+	{ 1,  0,  0,  0,  1},
+	{-1,  1,  0,  0,  1},
+	{ 0,  1,  0,  0,  1},
+	{ 1,  1,  0,  0,  1},
+	{-1, -1,  1,  0,  1},
+	{ 0, -1,  1,  0,  1},
+	{ 1, -1,  1,  0,  1},
+	{-1,  0,  1,  0,  1},
+	{ 0,  0,  1,  0,  1},
+	{ 1,  0,  1,  0,  1},
+	{-1,  1,  1,  0,  1},
+	{ 0,  1,  1,  0,  1},
+	{ 1,  1,  1,  0,  1},
+	{-1, -1, -1,  1,  1},
+	{ 0, -1, -1,  1,  1},
+	{ 1, -1, -1,  1,  1},
+	{-1,  0, -1,  1,  1},
+	{ 0,  0, -1,  1,  1},
+	{ 1,  0, -1,  1,  1},
+	{-1,  1, -1,  1,  1},
+	{ 0,  1, -1,  1,  1},
+	{ 1,  1, -1,  1,  1},
+	{-1, -1,  0,  1,  1},
+	{ 0, -1,  0,  1,  1},
+	{ 1, -1,  0,  1,  1},
+	{-1,  0,  0,  1,  1},
+	{ 0,  0,  0,  1,  1},
+	{ 1,  0,  0,  1,  1},
+	{-1,  1,  0,  1,  1},
+	{ 0,  1,  0,  1,  1},
+	{ 1,  1,  0,  1,  1},
+	{-1, -1,  1,  1,  1},
+	{ 0, -1,  1,  1,  1},
+	{ 1, -1,  1,  1,  1},
+	{-1,  0,  1,  1,  1},
+	{ 0,  0,  1,  1,  1},
+	{ 1,  0,  1,  1,  1},
+	{-1,  1,  1,  1,  1},
+	{ 0,  1,  1,  1,  1},
+	{ 1,  1,  1,  1,  1}
+};
+
+static const int8_t tritWeights[5] = {1, 3, 9, 27, 81};
+
+static inline const int8_t *getByteTrits(int8_t b) {
+	return byteTrits[b + IOTAPACKED_MAX_BYTE];
+}
+
+/* Trits of a tryte value (from -13 to 13): low is the least significant
+ * trit, high the most significant one. */
+static inline int tryteLow(int v) {
+	return ((v + 13) % 3) - 1;
+}
+
+static inline int tryteHigh(int v) {
+	return (v > 4) ? 1 : ((v < -4) ? -1 : 0);
+}
+
+IotaPackedTx::IotaPackedTx() {
+	memset(_data, 0, sizeof(_data));
+}
+
+bool IotaPackedTx::pack(const char *trytes) {
+	int8_t v[5];
+	unsigned int i = 0;
+	int8_t *out = _data;
+
+	if (!iotaTrytesValidate(trytes, NUM_TRANSACTION_TRYTES)) {
+		return false;
+	}
+
+	/* 5 trytes (15 trits) fit exactly in 3 bytes. */
+	for (; i + 5 <= NUM_TRANSACTION_TRYTES; i += 5) {
+		iotaTrytesToValues(trytes + i, v, 5);
+		int mid1 = (v[1] - tryteLow(v[1]) - 9 * tryteHigh(v[1])) / 3;
+		int mid3 = (v[3] - tryteLow(v[3]) - 9 * tryteHigh(v[3])) / 3;
+
+		*out++ = v[0] + 27 * (tryteLow(v[1]) + 3 * mid1);
+		*out++ = tryteHigh(v[1]) + 3 * v[2] + 81 * tryteLow(v[3]);
+		*out++ = mid3 + 3 * tryteHigh(v[3]) + 9 * v[4];
+	}
+
+	/* The remaining 3 trytes take 2 bytes, the last one padded. */
+	iotaTrytesToValues(trytes + i, v, 3);
+	int mid1 = (v[1] - tryteLow(v[1]) - 9 * tryteHigh(v[1])) / 3;
+
+	*out++ = v[0] + 27 * (tryteLow(v[1]) + 3 * mid1);
+	*out = tryteHigh(v[1]) + 3 * v[2];
+	return true;
+}
+
+bool IotaPackedTx::pack(const String &trytes) {
+	if (trytes.length() != NUM_TRANSACTION_TRYTES) {
+		return false;
+	}
+	return pack(trytes.c_str());
+}
+
+bool IotaPackedTx::pack(const struct IotaTx &tx) {
+	char buf[27];
+	const struct {
+		const String *field;
+		unsigned int offset;
+		unsigned int len;
+	} fields[] = {
+		{&tx.signatureMessage, IOTA_TX_SIGNATURE_OFFSET,
+				IOTA_TX_SIGNATURE_TRYTES},
+		{&tx.address, IOTA_TX_ADDRESS_OFFSET, NUM_HASH_TRYTES},
+		{&tx.obsoleteTag, IOTA_TX_OBSOLETE_TAG_OFFSET, NUM_TAG_TRYTES},
+		{&tx.bundle, IOTA_TX_BUNDLE_OFFSET, NUM_HASH_TRYTES},
+		{&tx.trunk, IOTA_TX_TRUNK_OFFSET, NUM_HASH_TRYTES},
+		{&tx.branch, IOTA_TX_BRANCH_OFFSET, NUM_HASH_TRYTES},
+		{&tx.tag, IOTA_TX_TAG_OFFSET, NUM_TAG_TRYTES},
+		{&tx.nonce, IOTA_TX_NONCE_OFFSET, NUM_TAG_TRYTES},
+	};
+	const struct {
+		int64_t value;
+		unsigned int offset;
+		unsigned int len;
+	} ints[] = {
+		{tx.value, IOTA_TX_VALUE_OFFSET, 27},
+		{tx.timestamp, IOTA_TX_TIMESTAMP_OFFSET, 9},
+		{tx.currentIndex, IOTA_TX_CURRENT_INDEX_OFFSET, 9},
+		{tx.lastIndex, IOTA_TX_LAST_INDEX_OFFSET, 9},
+		{tx.attachmentTimestamp, IOTA_TX_ATTACHMENT_TS_OFFSET, 9},
+		{tx.attachmentTimestampLowerBound,
+				IOTA_TX_ATTACHMENT_TS_LOWER_OFFSET, 9},
+		{tx.attachmentTimestampUpperBound,
+				IOTA_TX_ATTACHMENT_TS_UPPER_OFFSET, 9},
+	};
+
+	/* Addresses may include their checksum, which is not stored. */
+	for (unsigned int i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+		const String &field = *fields[i].field;
+
+		if ((field.length() != fields[i].len) &&
+				((fields[i].offset != IOTA_TX_ADDRESS_OFFSET) ||
+				(field.length() != NUM_HASH_TRYTES + NUM_ADDR_CKSUM_TRYTES))) {
+			return false;
+		}
+		if (!iotaTrytesValidate(field.c_str(), fields[i].len)) {
+			return false;
+		}
+	}
+	memset(_data, 0, sizeof(_data));
+	for (unsigned int i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+		setTrytes(fields[i].offset, fields[i].len, fields[i].field->c_str());
+	}
+	for (unsigned int i = 0; i < sizeof(ints) / sizeof(ints[0]); i++) {
+		iotaInt64ToTrytes(ints[i].value, buf, ints[i].len);
+		setTrytes(ints[i].offset, ints[i].len, buf);
+	}
+	return true;
+}
+
+void IotaPackedTx::unpack(char *trytes) const {
+	int8_t trits[15];
+	const int8_t *in = _data;
+	unsigned int i = 0;
+
+	for (; i + 5 <= NUM_TRANSACTION_TRYTES; i += 5) {
+		memcpy(trits, getByteTrits(*in++), 5);
+		memcpy(trits + 5, getByteTrits(*in++), 5);
+		memcpy(trits + 10, getByteTrits(*in++), 5);
+		iotaTritsToTrytes(trits, trytes + i, 5);
+	}
+	memcpy(trits, getByteTrits(*in++), 5);
+	memcpy(trits + 5, getByteTrits(*in), 5);
+	iotaTritsToTrytes(trits, trytes + i, 3);
+}
+
+bool IotaPackedTx::unpack(String &trytes) const {
+	trytes = "";
+	if (!trytes.reserve(NUM_TRANSACTION_TRYTES)) {
+		return false;
+	}
+	for (unsigned int i = 0; i < NUM_TRANSACTION_TRYTES; i++) {
+		trytes += '9';
+	}
+	unpack((char *) trytes.c_str());
+	return true;
+}
+
+bool IotaPackedTx::unpack(struct IotaTx &tx) const {
+	tx.signatureMessage = getString(IOTA_TX_SIGNATURE_OFFSET,
+			IOTA_TX_SIGNATURE_TRYTES);
+	tx.address = getString(IOTA_TX_ADDRESS_OFFSET, NUM_HASH_TRYTES);
+	tx.value = getValue();
+	tx.obsoleteTag = getString(IOTA_TX_OBSOLETE_TAG_OFFSET, NUM_TAG_TRYTES);
+	tx.timestamp = getTimestamp();
+	tx.currentIndex = getCurrentIndex();
+	tx.lastIndex = getLastIndex();
+	tx.bundle = getString(IOTA_TX_BUNDLE_OFFSET, NUM_HASH_TRYTES);
+	tx.trunk = getString(IOTA_TX_TRUNK_OFFSET, NUM_HASH_TRYTES);
+	tx.branch = getString(IOTA_TX_BRANCH_OFFSET, NUM_HASH_TRYTES);
+	tx.tag = getString(IOTA_TX_TAG_OFFSET, NUM_TAG_TRYTES);
+	tx.attachmentTimestamp = getAttachmentTimestamp();
+	tx.attachmentTimestampLowerBound =
+			getInt(IOTA_TX_ATTACHMENT_TS_LOWER_OFFSET, 9);
+	tx.attachmentTimestampUpperBound =
+			getInt(IOTA_TX_ATTACHMENT_TS_UPPER_OFFSET, 9);
+	tx.nonce = getString(IOTA_TX_NONCE_OFFSET, NUM_TAG_TRYTES);
+	return ((tx.signatureMessage.length() == IOTA_TX_SIGNATURE_TRYTES) &&
+			(tx.nonce.length() == NUM_TAG_TRYTES));
+}
+
+const uint8_t *IotaPackedTx::getData() const {
+	return (const uint8_t *) _data;
+}
+
+bool IotaPackedTx::setData(const uint8_t *data) {
+	for (unsigned int i = 0; i < IOTAPACKED_TX_BYTES; i++) {
+		int8_t b = (int8_t) data[i];
+
+		if ((b > IOTAPACKED_MAX_BYTE) || (b < -IOTAPACKED_MAX_BYTE)) {
+			return false;
+		}
+	}
+
+	/* The padding trit must be zero. */
+	if (getByteTrits((int8_t) data[IOTAPACKED_TX_BYTES - 1])[4] != 0) {
+		return false;
+	}
+	memcpy(_data, data, sizeof(_data));
+	return true;
+}
+
+void IotaPackedTx::getAddress(char *addr) const {
+	getTrytes(IOTA_TX_ADDRESS_OFFSET, NUM_HASH_TRYTES, addr);
+}
+
+void IotaPackedTx::getBundle(char *bundle) const {
+	getTrytes(IOTA_TX_BUNDLE_OFFSET, NUM_HASH_TRYTES, bundle);
+}
+
+void IotaPackedTx::getTrunk(char *trunk) const {
+	getTrytes(IOTA_TX_TRUNK_OFFSET, NUM_HASH_TRYTES, trunk);
+}
+
+void IotaPackedTx::getBranch(char *branch) const {
+	getTrytes(IOTA_TX_BRANCH_OFFSET, NUM_HASH_TRYTES, branch);
+}
+
+void IotaPackedTx::getTag(char *tag) const {
+	getTrytes(IOTA_TX_TAG_OFFSET, NUM_TAG_TRYTES, tag);
+}
+
+int64_t IotaPackedTx::getValue() const {
+	return getInt(IOTA_TX_VALUE_OFFSET, 27);
+}
+
+int64_t IotaPackedTx::getTimestamp() const {
+	return getInt(IOTA_TX_TIMESTAMP_OFFSET, 9);
+}
+
+int64_t IotaPackedTx::getCurrentIndex() const {
+	return getInt(IOTA_TX_CURRENT_INDEX_OFFSET, 9);
+}
+
+int64_t IotaPackedTx::getLastIndex() const {
+	return getInt(IOTA_TX_LAST_INDEX_OFFSET, 9);
+}
+
+int64_t IotaPackedTx::getAttachmentTimestamp() const {
+	return getInt(IOTA_TX_ATTACHMENT_TS_OFFSET, 9);
+}
+
+void IotaPackedTx::getTrytes(unsigned int offset, unsigned int len,
+		char *trytes) const {
+	int8_t trits[3];
+	unsigned int trit = 3 * offset;
+
+	for (unsigned int i = 0; i < len; i++) {
+		for (unsigned int j = 0; j < 3; j++, trit++) {
+			trits[j] = getByteTrits(_data[trit / 5])[trit % 5];
+		}
+		iotaTritsToTrytes(trits, trytes + i, 1);
+	}
+}
+
+void IotaPackedTx::setTrytes(unsigned int offset, unsigned int len,
+		const char *trytes) {
+	int8_t trits[3];
+	unsigned int trit = 3 * offset;
+
+	for (unsigned int i = 0; i < len; i++) {
+		iotaTrytesToTrits(trytes + i, trits, 1);
+		for (unsigned int j = 0; j < 3; j++, trit++) {
+			int8_t &b = _data[trit / 5];
+			unsigned int pos = trit % 5;
+
+			b += (trits[j] - getByteTrits(b)[pos]) * tritWeights[pos];
+		}
+	}
+}
+
+int64_t IotaPackedTx::getInt(unsigned int offset, unsigned int len) const {
+	char trytes[27];
+
+	getTrytes(offset, len, trytes);
+	return iotaTrytesToInt64(trytes, len);
+}
+
+String IotaPackedTx::getString(unsigned int offset, unsigned int len) const {
+	String str;
+
+	if (!str.reserve(len)) {
+		return str;
+	}
+	for (unsigned int i = 0; i < len; i++) {
+		str += '9';
+	}
+	getTrytes(offset, len, (char *) str.c_str());
+	return str;
+}
+
+bool iotaPackTransactions(const std::vector<String> &txs,
+		std::vector<IotaPackedTx> &packed) {
+	packed.resize(txs.size());
+	for (unsigned int i = 0; i < txs.size(); i++) {
+		if (!packed[i].pack(txs[i])) {
+			packed.clear();
+			return false;
+		}
+	}
+	return true;
+}
+
+bool iotaUnpackTransactions(const std::vector<IotaPackedTx> &packed,
+		std::vector<String> &txs) {
+	txs.resize(packed.size());
+	for (unsigned int i = 0; i < packed.size(); i++) {
+		if (!packed[i].unpack(txs[i])) {
+			txs.clear();
+			return false;
+		}
+	}
+	return true;
+}
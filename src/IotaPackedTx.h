@@ -0,0 +1,210 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _IOTA_PACKED_TX_H_
+#define _IOTA_PACKED_TX_H_
+
+#include <Arduino.h>
+#ifdef min
+#undef min
+#endif
+#ifdef max
+#undef max
+#endif
+#include <vector>
+
+#include "IotaClient.h"
+
+/* A transaction is 8019 trits; each byte holds 5 trits, and the last byte is
+ * padded with a zero trit. */
+#define IOTAPACKED_TX_TRITS	8019
+#define IOTAPACKED_TX_BYTES	((IOTAPACKED_TX_TRITS + 4) / 5)
+
+/** Transaction in packed binary format
+      Each byte stores 5 trits as a signed value from -121 to 121, so that a
+      transaction takes 1604 bytes instead of 2673 tryte characters. Fields can
+      be read directly from the packed form without unpacking the whole
+      transaction.
+*/
+class IotaPackedTx {
+public:
+
+	/** Create a packed transaction with all trits set to zero
+      @return none
+	*/
+	IotaPackedTx();
+
+	/** Pack a transaction from tryte characters
+      @param trytes  Transaction trytes (2673 characters)
+      @return true if the transaction has been packed, false if the supplied
+              characters are not valid trytes
+	*/
+	bool pack(const char *trytes);
+
+	/** Pack a transaction from a tryte string
+      @param trytes  Transaction trytes
+      @return true if the transaction has been packed, false if the supplied
+              string is not a valid transaction
+	*/
+	bool pack(const String &trytes);
+
+	/** Pack a transaction from its fields
+      @param tx  Transaction
+      @return true if the transaction has been packed, false if any of the
+              transaction fields is not valid
+	*/
+	bool pack(const struct IotaTx &tx);
+
+	/** Unpack a transaction to tryte characters
+      @param trytes  Buffer that is filled with 2673 tryte characters (no
+             string terminator is appended)
+      @return none
+	*/
+	void unpack(char *trytes) const;
+
+	/** Unpack a transaction to a tryte string
+      @param trytes  String to be filled with transaction trytes
+      @return true if the transaction has been unpacked, false if memory could
+              not be allocated
+	*/
+	bool unpack(String &trytes) const;
+
+	/** Unpack a transaction to its fields
+      @param tx  Transaction to be filled
+      @return true if the transaction has been unpacked, false if memory could
+              not be allocated
+	*/
+	bool unpack(struct IotaTx &tx) const;
+
+	/** Retrieve packed data
+      @return pointer to IOTAPACKED_TX_BYTES bytes of packed data
+	*/
+	const uint8_t *getData() const;
+
+	/** Load packed data
+      @param data  IOTAPACKED_TX_BYTES bytes of packed data, as returned by
+             getData()
+      @return true if data has been loaded, false if data is not valid
+	*/
+	bool setData(const uint8_t *data);
+
+	/** Read the address field
+      @param addr  Buffer that is filled with 81 tryte characters (no string
+             terminator is appended)
+      @return none
+	*/
+	void getAddress(char *addr) const;
+
+	/** Read the bundle hash field
+      @param bundle  Buffer that is filled with 81 tryte characters (no string
+             terminator is appended)
+      @return none
+	*/
+	void getBundle(char *bundle) const;
+
+	/** Read the trunk transaction field
+      @param trunk  Buffer that is filled with 81 tryte characters (no string
+             terminator is appended)
+      @return none
+	*/
+	void getTrunk(char *trunk) const;
+
+	/** Read the branch transaction field
+      @param branch  Buffer that is filled with 81 tryte characters (no string
+             terminator is appended)
+      @return none
+	*/
+	void getBranch(char *branch) const;
+
+	/** Read the tag field
+      @param tag  Buffer that is filled with 27 tryte characters (no string
+             terminator is appended)
+      @return none
+	*/
+	void getTag(char *tag) const;
+
+	/** Read the value field
+      @return transaction value
+	*/
+	int64_t getValue() const;
+
+	/** Read the timestamp field
+      @return transaction timestamp
+	*/
+	int64_t getTimestamp() const;
+
+	/** Read the current index field
+      @return index of the transaction in its bundle
+	*/
+	int64_t getCurrentIndex() const;
+
+	/** Read the last index field
+      @return index of the last transaction in the bundle
+	*/
+	int64_t getLastIndex() const;
+
+	/** Read the attachment timestamp field
+      @return attachment timestamp
+	*/
+	int64_t getAttachmentTimestamp() const;
+
+	/** Read tryte characters at an arbitrary position
+      @param offset  Position of the first tryte in the transaction
+      @param len  Number of trytes
+      @param trytes  Buffer that is filled with tryte characters (no string
+             terminator is appended)
+      @return none
+	*/
+	void getTrytes(unsigned int offset, unsigned int len, char *trytes) const;
+
+private:
+	void setTrytes(unsigned int offset, unsigned int len, const char *trytes);
+	int64_t getInt(unsigned int offset, unsigned int len) const;
+	String getString(unsigned int offset, unsigned int len) const;
+
+	int8_t _data[IOTAPACKED_TX_BYTES];
+};
+
+/** Pack transactions
+      This can be used on the transactions passed to the storeTransactions()
+      and broadcastTransactions() methods of the IOTA client.
+      @param txs  Transaction tryte strings
+      @param packed  List to be filled with packed transactions, in the same
+             order
+      @return true if all transactions have been packed, false otherwise
+*/
+bool iotaPackTransactions(const std::vector<String> &txs,
+		std::vector<IotaPackedTx> &packed);
+
+/** Unpack transactions
+      @param packed  Packed transactions
+      @param txs  List to be filled with transaction tryte strings, in the same
+             order
+      @return true if all transactions have been unpacked, false otherwise
+*/
+bool iotaUnpackTransactions(const std::vector<IotaPackedTx> &packed,
+		std::vector<String> &txs);
+
+#endif
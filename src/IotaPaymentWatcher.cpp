@@ -0,0 +1,325 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <iterator>
+
+#include "IotaPaymentWatcher.h"
+#include "IotaTrytes.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "iota-c-library/src/iota/common.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef IOTAWATCHER_DEBUG
+#define DPRINTF	printf
+#else
+#define DPRINTF(fmt, ...)	do {} while(0)
+#endif
+
+IotaPaymentWatcher::IotaPaymentWatcher(IotaClient &iotaClient) :
+		_iotaClient(iotaClient) {
+	_paymentCallback = _confirmedCallback = NULL;
+	_paymentArg = _confirmedArg = NULL;
+	_minInterval = _interval = IOTAWATCHER_MIN_INTERVAL;
+	_maxInterval = IOTAWATCHER_MAX_INTERVAL;
+	_lastPoll = 0;
+	_polled = false;
+}
+
+void IotaPaymentWatcher::addAddress(String addr, bool reportHistory) {
+	addr.remove(NUM_HASH_TRYTES);
+	for (auto it = _addrs.cbegin(); it != _addrs.cend(); it++) {
+		if (*it == addr) {
+			return;
+		}
+	}
+	_addrs.push_back(addr);
+	if (!reportHistory) {
+		_historyAddrs.push_back(addr);
+	}
+	_interval = _minInterval;
+}
+
+void IotaPaymentWatcher::removeAddress(String addr) {
+	addr.remove(NUM_HASH_TRYTES);
+	for (auto it = _historyAddrs.begin(); it != _historyAddrs.end(); it++) {
+		if (*it == addr) {
+			_historyAddrs.erase(it);
+			break;
+		}
+	}
+	for (auto it = _addrs.begin(); it != _addrs.end(); it++) {
+		if (*it == addr) {
+			_addrs.erase(it);
+			return;
+		}
+	}
+}
+
+void IotaPaymentWatcher::onPayment(iotaPaymentCallback callback, void *arg) {
+	_paymentCallback = callback;
+	_paymentArg = arg;
+}
+
+void IotaPaymentWatcher::onConfirmed(iotaPaymentCallback callback,
+		void *arg) {
+	_confirmedCallback = callback;
+	_confirmedArg = arg;
+}
+
+void IotaPaymentWatcher::setPollInterval(unsigned long minInterval,
+		unsigned long maxInterval) {
+	_minInterval = minInterval;
+	_maxInterval = ((maxInterval > minInterval) ? maxInterval : minInterval);
+	_interval = _minInterval;
+}
+
+unsigned long IotaPaymentWatcher::getPollInterval() {
+	return _interval;
+}
+
+bool IotaPaymentWatcher::update() {
+	if (_polled && (millis() - _lastPoll < _interval)) {
+		return true;
+	}
+	return poll();
+}
+
+bool IotaPaymentWatcher::poll() {
+	std::vector<String> hashes;
+	std::vector<String> newHashes;
+	std::vector<String> chunk, trytes;
+	bool activity = false;
+
+	_polled = true;
+	_lastPoll = millis();
+	if (_addrs.empty()) {
+		return true;
+	}
+	if (!_iotaClient.findTransactions(hashes, std::vector<String>(),
+			_addrs)) {
+		DPRINTF("%s: couldn't find transactions\n", __FUNCTION__);
+		return false;
+	}
+	std::sort(hashes.begin(), hashes.end());
+	hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+	if (!skipHistory(hashes)) {
+		return false;
+	}
+
+	/* Only hashes still returned by the node are kept in the seen set, so
+	 * that its size is bounded by the size of the node response. */
+	for (auto it = hashes.cbegin(); it != hashes.cend(); it++) {
+		if (!std::binary_search(_seenTxs.cbegin(), _seenTxs.cend(), *it)) {
+			newHashes.push_back(*it);
+		}
+	}
+	for (auto it = newHashes.cbegin(); it != newHashes.cend(); ) {
+		auto last = ((newHashes.cend() - it > IOTACLIENT_STATIC_BATCH) ?
+				it + IOTACLIENT_STATIC_BATCH : newHashes.cend());
+
+		chunk.assign(it, last);
+		if (!_iotaClient.getTrytes(chunk, trytes)) {
+			DPRINTF("%s: couldn't get transaction trytes\n", __FUNCTION__);
+
+			/* Transactions processed so far are not reported again. */
+			_seenTxs.clear();
+			std::set_difference(hashes.cbegin(), hashes.cend(), it,
+					newHashes.cend(), std::back_inserter(_seenTxs));
+			return false;
+		}
+		for (unsigned int i = 0; i < chunk.size(); i++) {
+			processTx(chunk[i], trytes[i]);
+		}
+		it = last;
+		activity = true;
+	}
+	_seenTxs.swap(hashes);
+	if (!checkConfirmed(activity)) {
+		return false;
+	}
+	if (activity) {
+		_interval = _minInterval;
+	}
+	else if (_interval < _maxInterval) {
+		_interval = ((_interval * 2 < _maxInterval) ? _interval * 2 :
+				_maxInterval);
+	}
+	DPRINTF("%s: next poll in %lu ms\n", __FUNCTION__, _interval);
+	return true;
+}
+
+bool IotaPaymentWatcher::skipHistory(std::vector<String> &hashes) {
+	std::vector<String> history;
+
+	if (_historyAddrs.empty()) {
+		return true;
+	}
+
+	/* Transactions already on the tangle when an address is added are marked
+	 * as seen without being reported. If no other address is monitored, this
+	 * is the whole node response. */
+	if (_historyAddrs.size() == _addrs.size()) {
+		history = hashes;
+	}
+	else if (_iotaClient.findTransactions(history, std::vector<String>(),
+			_historyAddrs)) {
+		std::sort(history.begin(), history.end());
+		history.erase(std::unique(history.begin(), history.end()),
+				history.end());
+	}
+	else {
+		DPRINTF("%s: couldn't find transactions\n", __FUNCTION__);
+		return false;
+	}
+	std::vector<String> seen;
+	std::set_union(_seenTxs.cbegin(), _seenTxs.cend(), history.cbegin(),
+			history.cend(), std::back_inserter(seen));
+	_seenTxs.swap(seen);
+	_historyAddrs.clear();
+	return true;
+}
+
+void IotaPaymentWatcher::processTx(const String &hash, const String &trytes) {
+	String addr = trytes.substring(IOTA_TX_ADDRESS_OFFSET,
+			IOTA_TX_ADDRESS_OFFSET + NUM_HASH_TRYTES);
+	String bundle = trytes.substring(IOTA_TX_BUNDLE_OFFSET,
+			IOTA_TX_BUNDLE_OFFSET + NUM_HASH_TRYTES);
+	int64_t value, currentIndex;
+	bool watched = false;
+
+	value = iotaTrytesToInt64(trytes.c_str() + IOTA_TX_VALUE_OFFSET, 27);
+	if (value <= 0) {
+		return;
+	}
+	for (auto it = _addrs.cbegin(); it != _addrs.cend(); it++) {
+		if (*it == addr) {
+			watched = true;
+			break;
+		}
+	}
+	if (!watched) {
+		return;
+	}
+	for (auto it = _confirmedBundles.cbegin(); it != _confirmedBundles.cend();
+			it++) {
+		if (*it == bundle) {
+			return;
+		}
+	}
+	currentIndex = iotaTrytesToInt64(trytes.c_str() +
+			IOTA_TX_CURRENT_INDEX_OFFSET, 9);
+	for (auto it = _payments.begin(); it != _payments.end(); it++) {
+		if (it->info.bundle != bundle) {
+			continue;
+		}
+
+		/* Another attachment of a known bundle, or another output of the
+		 * same bundle to a monitored address. */
+		it->txs.push_back(hash);
+		for (auto idx = it->indexes.cbegin(); idx != it->indexes.cend();
+				idx++) {
+			if (*idx == currentIndex) {
+				return;
+			}
+		}
+		it->indexes.push_back(currentIndex);
+		it->info.value += value;
+		return;
+	}
+
+	struct iotaWatchedPayment payment;
+	payment.info.bundle = bundle;
+	payment.info.addr = addr;
+	payment.info.value = value;
+	payment.info.tag = trytes.substring(IOTA_TX_TAG_OFFSET,
+			IOTA_TX_TAG_OFFSET + NUM_TAG_TRYTES);
+	payment.info.timestamp = iotaTrytesToInt64(trytes.c_str() +
+			IOTA_TX_TIMESTAMP_OFFSET, 9);
+	payment.info.confirmed = false;
+	payment.txs.push_back(hash);
+	payment.indexes.push_back(currentIndex);
+	if (_payments.size() >= IOTAWATCHER_MAX_PENDING) {
+		DPRINTF("%s: dropping pending payment %s\n", __FUNCTION__,
+				_payments.front().info.bundle.c_str());
+		_payments.erase(_payments.begin());
+	}
+	_payments.push_back(payment);
+	DPRINTF("%s: new payment of %lld to %s\n", __FUNCTION__, value,
+			addr.c_str());
+	if (_paymentCallback) {
+		_paymentCallback(_payments.back().info, _paymentArg);
+	}
+}
+
+bool IotaPaymentWatcher::checkConfirmed(bool &activity) {
+	std::vector<String> txs;
+	std::vector<bool> states;
+
+	for (auto it = _payments.cbegin(); it != _payments.cend(); it++) {
+		txs.insert(txs.end(), it->txs.cbegin(), it->txs.cend());
+	}
+	if (txs.empty()) {
+		return true;
+	}
+
+	if (!_iotaClient.getLatestInclusion(txs, states)) {
+		DPRINTF("%s: couldn't get inclusion states\n", __FUNCTION__);
+		return false;
+	}
+	unsigned int i = 0;
+	for (auto it = _payments.begin(); it != _payments.end();) {
+		bool confirmed = false;
+		for (unsigned int j = 0; j < it->txs.size(); j++) {
+			confirmed |= states[i++];
+		}
+		if (!confirmed) {
+			it++;
+			continue;
+		}
+		it->info.confirmed = true;
+		activity = true;
+		if (_confirmedCallback) {
+			_confirmedCallback(it->info, _confirmedArg);
+		}
+
+		/* Confirmed payments are not tracked any longer: only the bundle
+		 * hash is remembered, so that further attachments are ignored. */
+		if (_confirmedBundles.size() >= IOTAWATCHER_MAX_CONFIRMED) {
+			_confirmedBundles.erase(_confirmedBundles.begin());
+		}
+		_confirmedBundles.push_back(it->info.bundle);
+		it = _payments.erase(it);
+	}
+	return true;
+}
@@ -0,0 +1,174 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _IOTA_PAYMENT_WATCHER_H_
+#define _IOTA_PAYMENT_WATCHER_H_
+
+#include <Arduino.h>
+#ifdef min
+#undef min
+#endif
+#ifdef max
+#undef max
+#endif
+#include <vector>
+
+#include "IotaClient.h"
+
+#define IOTAWATCHER_MIN_INTERVAL	2000
+#define IOTAWATCHER_MAX_INTERVAL	60000
+
+/* Maximum number of unconfirmed payments being tracked: when exceeded, the
+ * oldest pending payment is dropped. */
+#ifndef IOTAWATCHER_MAX_PENDING
+#define IOTAWATCHER_MAX_PENDING	32
+#endif
+
+/* Number of most recently confirmed bundles remembered to recognize late
+ * reattachments of an already reported payment. */
+#ifndef IOTAWATCHER_MAX_CONFIRMED
+#define IOTAWATCHER_MAX_CONFIRMED	16
+#endif
+
+struct iotaPayment {
+	String bundle;
+	String addr;
+	uint64_t value;
+	String tag;
+	int64_t timestamp;
+	bool confirmed;
+};
+
+typedef void (*iotaPaymentCallback)(const struct iotaPayment &payment,
+		void *arg);
+
+class IotaPaymentWatcher {
+public:
+
+	/** Create a watcher of incoming payments
+      The watcher monitors a set of receive addresses and reports incoming
+      payments via callbacks: a payment is identified by its bundle hash, so
+      multiple attachments of the same bundle (reattachments) are reported as
+      a single payment.
+      @param iotaClient  IOTA client used to communicate with full IOTA node
+      @return none
+	*/
+	IotaPaymentWatcher(IotaClient &iotaClient);
+
+	/** Add an address to the set of monitored addresses
+      By default, payments already on the tangle when the address is added
+      (e.g. received before a reboot) are not reported: the first poll after
+      the address is added only marks its transactions as seen.
+      @param addr  Address (with or without checksum)
+      @param reportHistory  If true, payments already on the tangle are
+             reported as if they were new
+      @return none
+	*/
+	void addAddress(String addr, bool reportHistory = false);
+
+	/** Remove an address from the set of monitored addresses
+      @param addr  Address (with or without checksum)
+      @return none
+	*/
+	void removeAddress(String addr);
+
+	/** Configure callback for new payments
+      The callback is called when a payment to a monitored address is
+      detected for the first time, whether or not it has been confirmed.
+      @param callback  Function to be called
+      @param arg  Opaque argument passed to the callback function
+      @return none
+	*/
+	void onPayment(iotaPaymentCallback callback, void *arg = NULL);
+
+	/** Configure callback for confirmed payments
+      The callback is called once for each payment, when any of its
+      attachments is confirmed.
+      @param callback  Function to be called
+      @param arg  Opaque argument passed to the callback function
+      @return none
+	*/
+	void onConfirmed(iotaPaymentCallback callback, void *arg = NULL);
+
+	/** Configure polling interval
+      The polling interval is set to the minimum value whenever new
+      transactions or payment confirmations are detected, and is doubled at
+      each poll with no activity up to the maximum value.
+      @param minInterval  Minimum polling interval, in milliseconds
+      @param maxInterval  Maximum polling interval, in milliseconds
+      @return none
+	*/
+	void setPollInterval(unsigned long minInterval,
+			unsigned long maxInterval);
+
+	/** Retrieve current polling interval
+      @return time (in milliseconds) between the last poll and the next one
+	*/
+	unsigned long getPollInterval();
+
+	/** Poll the IOTA full node if the polling interval has elapsed
+      It should be called periodically, e.g. from the Arduino loop() function.
+      @return false if polling failed because of a communication error with
+              the IOTA full node, true otherwise
+	*/
+	bool update();
+
+	/** Poll the IOTA full node for new and confirmed payments
+      This method queries the node for transactions on all monitored addresses
+      in a single batched request, retrieves in batched requests the trytes of
+      transactions that have not been seen before, and checks in a single
+      batched request the inclusion state of pending payments.
+      Payments are forgotten as soon as they are confirmed (only their bundle
+      hash is remembered, for the last IOTAWATCHER_MAX_CONFIRMED payments),
+      and at most IOTAWATCHER_MAX_PENDING unconfirmed payments are tracked;
+      transactions no longer returned by the node are forgotten as well.
+      @return true if communication with the IOTA full node is successful, false
+              otherwise
+	*/
+	bool poll();
+
+private:
+	struct iotaWatchedPayment {
+		struct iotaPayment info;
+		std::vector<String> txs;
+		std::vector<unsigned int> indexes;
+	};
+	void processTx(const String &hash, const String &trytes);
+	bool skipHistory(std::vector<String> &hashes);
+	bool checkConfirmed(bool &activity);
+	IotaClient &_iotaClient;
+	std::vector<String> _addrs;
+	std::vector<String> _historyAddrs; /* history not yet marked as seen */
+	std::vector<String> _seenTxs; /* sorted */
+	std::vector<struct iotaWatchedPayment> _payments;
+	std::vector<String> _confirmedBundles;
+	iotaPaymentCallback _paymentCallback, _confirmedCallback;
+	void *_paymentArg, *_confirmedArg;
+	unsigned long _minInterval, _maxInterval, _interval;
+	unsigned long _lastPoll;
+	bool _polled;
+};
+
+#endif
@@ -0,0 +1,212 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "IotaSpentLedger.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "iota-c-library/src/iota/common.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+/* Persistent data header: magic, bitmap size, Bloom filter size and wallet
+ * fingerprint. */
+#define IOTALEDGER_MAGIC		0x49534c32
+#define IOTALEDGER_FP_POS		12
+#define IOTALEDGER_HDR_SIZE		(IOTALEDGER_FP_POS + \
+		IOTALEDGER_FINGERPRINT_TRYTES)
+
+static void putUint32(unsigned char *buf, uint32_t val) {
+	for (int i = 0; i < 4; i++) {
+		buf[i] = (val >> (8 * i)) & 0xFF;
+	}
+}
+
+IotaSpentLedger::IotaSpentLedger(unsigned int maxIndex,
+		unsigned int bloomBits) {
+	_maxIndex = (maxIndex + 7) & ~7;
+	_bloomBits = (bloomBits + 7) & ~7;
+	_dataLen = IOTALEDGER_HDR_SIZE + _maxIndex / 8 + _bloomBits / 8;
+	_data = (unsigned char *) malloc(_dataLen);
+	if (_data) {
+		_bitmap = _data + IOTALEDGER_HDR_SIZE;
+		_bloom = _bitmap + _maxIndex / 8;
+	}
+	else {
+		_maxIndex = _bloomBits = 0;
+		_dataLen = 0;
+		_bitmap = _bloom = NULL;
+	}
+	_storage = NULL;
+	memset(_fingerprint, '9', sizeof(_fingerprint));
+	_bound = false;
+	clear();
+}
+
+IotaSpentLedger::~IotaSpentLedger() {
+	free(_data);
+}
+
+void IotaSpentLedger::setStorage(IotaLedgerStorage &storage) {
+	_storage = &storage;
+}
+
+bool IotaSpentLedger::load() {
+	unsigned char hdr[IOTALEDGER_HDR_SIZE];
+
+	if (!_storage || !_data) {
+		return false;
+	}
+	if (!_storage->load(_data, _dataLen)) {
+		clear();
+		return false;
+	}
+	memcpy(hdr, _data, sizeof(hdr));
+	putHeader(_data);
+	if (!_bound) {
+		/* Keep the stored fingerprint, to be checked by setFingerprint(). */
+		memcpy(_data + IOTALEDGER_FP_POS, hdr + IOTALEDGER_FP_POS,
+				IOTALEDGER_FINGERPRINT_TRYTES);
+	}
+	if (memcmp(hdr, _data, sizeof(hdr))) {
+		clear();
+		return false;
+	}
+	_dirty = false;
+	return true;
+}
+
+bool IotaSpentLedger::save() {
+	if (!_storage || !_data) {
+		return false;
+	}
+	if (!_dirty) {
+		return true;
+	}
+	if (!_storage->store(_data, _dataLen)) {
+		return false;
+	}
+	_dirty = false;
+	return true;
+}
+
+void IotaSpentLedger::clear() {
+	if (_data) {
+		memset(_data, 0, _dataLen);
+		putHeader(_data);
+	}
+	_dirty = true;
+}
+
+void IotaSpentLedger::setFingerprint(const char *addr) {
+	memcpy(_fingerprint, addr, IOTALEDGER_FINGERPRINT_TRYTES);
+	_bound = true;
+	if (_data && memcmp(_data + IOTALEDGER_FP_POS, _fingerprint,
+			IOTALEDGER_FINGERPRINT_TRYTES)) {
+		clear();
+	}
+}
+
+unsigned int IotaSpentLedger::getMaxIndex() {
+	return _maxIndex;
+}
+
+void IotaSpentLedger::markSpent(unsigned int addrIdx, const char *addr) {
+	if (addrIdx < _maxIndex) {
+		if (!(_bitmap[addrIdx / 8] & (1 << (addrIdx % 8)))) {
+			_bitmap[addrIdx / 8] |= 1 << (addrIdx % 8);
+			_dirty = true;
+		}
+	}
+	else if (addr && *addr) {
+		markSpent(addr);
+	}
+}
+
+void IotaSpentLedger::markSpent(const char *addr) {
+	unsigned int pos[IOTALEDGER_BLOOM_HASHES];
+
+	if (_bloomBits == 0) {
+		return;
+	}
+	bloomPositions(addr, pos);
+	for (int i = 0; i < IOTALEDGER_BLOOM_HASHES; i++) {
+		if (!(_bloom[pos[i] / 8] & (1 << (pos[i] % 8)))) {
+			_bloom[pos[i] / 8] |= 1 << (pos[i] % 8);
+			_dirty = true;
+		}
+	}
+}
+
+bool IotaSpentLedger::isSpent(unsigned int addrIdx, const char *addr) {
+	if (addrIdx < _maxIndex) {
+		return ((_bitmap[addrIdx / 8] & (1 << (addrIdx % 8))) != 0);
+	}
+	return (addr ? isSpent(addr) : false);
+}
+
+bool IotaSpentLedger::isSpent(const char *addr) {
+	unsigned int pos[IOTALEDGER_BLOOM_HASHES];
+
+	if (_bloomBits == 0) {
+		return false;
+	}
+	bloomPositions(addr, pos);
+	for (int i = 0; i < IOTALEDGER_BLOOM_HASHES; i++) {
+		if (!(_bloom[pos[i] / 8] & (1 << (pos[i] % 8)))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void IotaSpentLedger::putHeader(unsigned char *hdr) {
+	putUint32(hdr, IOTALEDGER_MAGIC);
+	putUint32(hdr + 4, _maxIndex);
+	putUint32(hdr + 8, _bloomBits);
+	memcpy(hdr + IOTALEDGER_FP_POS, _fingerprint,
+			IOTALEDGER_FINGERPRINT_TRYTES);
+}
+
+void IotaSpentLedger::bloomPositions(const char *addr, unsigned int *pos) {
+	uint32_t h1 = 2166136261u;
+	uint32_t h2 = 0x811c9dc5u ^ 0x5bd1e995u;
+
+	/* FNV-1a over the address trytes, with two different offset bases; the
+	 * positions are then obtained via double hashing. */
+	for (unsigned int i = 0; i < NUM_HASH_TRYTES; i++) {
+		h1 = (h1 ^ (unsigned char) addr[i]) * 16777619u;
+		h2 = (h2 ^ (unsigned char) addr[NUM_HASH_TRYTES - 1 - i]) * 16777619u;
+	}
+	h2 |= 1;
+	for (int i = 0; i < IOTALEDGER_BLOOM_HASHES; i++) {
+		pos[i] = (h1 + i * h2) % _bloomBits;
+	}
+}
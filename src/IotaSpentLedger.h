@@ -0,0 +1,174 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _IOTA_SPENT_LEDGER_H_
+#define _IOTA_SPENT_LEDGER_H_
+
+#include <Arduino.h>
+
+/* Number of address indexes tracked by the spent bitmap. */
+#ifndef IOTALEDGER_MAX_INDEX
+#define IOTALEDGER_MAX_INDEX	1024
+#endif
+
+/* Size in bits of the Bloom filter for addresses outside the bitmap. */
+#ifndef IOTALEDGER_BLOOM_BITS
+#define IOTALEDGER_BLOOM_BITS	2048
+#endif
+
+#define IOTALEDGER_BLOOM_HASHES	4
+
+/* Number of trytes of wallet address 0 kept in the ledger to identify the seed
+ * and security level it belongs to. */
+#define IOTALEDGER_FINGERPRINT_TRYTES	16
+
+class IotaLedgerStorage {
+public:
+
+	/** Load ledger data from persistent storage
+      @param data  Buffer to be filled with ledger data
+      @param len  Number of bytes to be loaded
+      @return true if the requested number of bytes has been loaded, false
+              otherwise (e.g. if no ledger data has been stored yet)
+	*/
+	virtual bool load(unsigned char *data, unsigned int len) = 0;
+
+	/** Store ledger data to persistent storage
+      Any previously stored data is replaced.
+      @param data  Ledger data
+      @param len  Number of bytes to be stored
+      @return true if data has been stored successfully, false otherwise
+	*/
+	virtual bool store(const unsigned char *data, unsigned int len) = 0;
+};
+
+class IotaSpentLedger {
+public:
+
+	/** Create a spent address ledger
+      The ledger keeps track of addresses known to have been spent from, so
+      that they do not need to be checked with the IOTA full node: since an
+      address cannot go back to being unspent, a spent state recorded in the
+      ledger never becomes stale. Addresses derived from the wallet seed are
+      tracked by index in a bitmap; addresses with an index beyond the bitmap
+      size and imported addresses are tracked in a Bloom filter, which can
+      give false positives (i.e. an unspent address may be reported as spent,
+      which is safe when choosing addresses to receive funds) but never false
+      negatives.
+      @param maxIndex  Number of address indexes tracked by the bitmap
+      @param bloomBits  Size in bits of the Bloom filter; if 0, the Bloom
+             filter is not used
+      @return none
+	*/
+	IotaSpentLedger(unsigned int maxIndex = IOTALEDGER_MAX_INDEX,
+			unsigned int bloomBits = IOTALEDGER_BLOOM_BITS);
+
+	~IotaSpentLedger();
+
+	/** Configure persistent storage for the ledger
+      @param storage  Reference to storage backend
+      @return none
+	*/
+	void setStorage(IotaLedgerStorage &storage);
+
+	/** Bind the ledger to a wallet seed and security level
+      The first trytes of wallet address 0, which depends on both the seed and
+      the security level, are kept in the ledger as a fingerprint. If current
+      contents have a different fingerprint, the ledger is cleared.
+      @param addr  Wallet address with index 0 (81 trytes, checksum not
+             required)
+      @return none
+	*/
+	void setFingerprint(const char *addr);
+
+	/** Load ledger contents from persistent storage
+      If stored data does not match the ledger configuration or the fingerprint
+      set with setFingerprint(), the ledger is left empty.
+      @return true if ledger contents have been loaded, false otherwise
+	*/
+	bool load();
+
+	/** Save ledger contents to persistent storage
+      Contents are written only if they have changed since the last load or
+      save.
+      @return true if ledger contents are saved, false otherwise
+	*/
+	bool save();
+
+	/** Clear ledger contents
+      @return none
+	*/
+	void clear();
+
+	/** Retrieve number of address indexes tracked by the bitmap
+      @return number of address indexes tracked by the bitmap
+	*/
+	unsigned int getMaxIndex();
+
+	/** Record that a wallet address has been spent from
+      @param addrIdx  Address index
+      @param addr  Address (81 trytes, checksum not required); used when the
+             index is beyond the bitmap size, may be NULL
+      @return none
+	*/
+	void markSpent(unsigned int addrIdx, const char *addr = NULL);
+
+	/** Record that an imported address has been spent from
+      @param addr  Address (81 trytes, checksum not required)
+      @return none
+	*/
+	void markSpent(const char *addr);
+
+	/** Check whether a wallet address is known to have been spent from
+      @param addrIdx  Address index
+      @param addr  Address (81 trytes, checksum not required); used when the
+             index is beyond the bitmap size, may be NULL
+      @return true if the address is known to have been spent from, false if
+              its state is unknown
+	*/
+	bool isSpent(unsigned int addrIdx, const char *addr = NULL);
+
+	/** Check whether an imported address is known to have been spent from
+      @param addr  Address (81 trytes, checksum not required)
+      @return true if the address is known (or, with a small probability,
+              wrongly believed) to have been spent from, false if its state is
+              unknown
+	*/
+	bool isSpent(const char *addr);
+
+private:
+	void putHeader(unsigned char *hdr);
+	void bloomPositions(const char *addr, unsigned int *pos);
+	unsigned int _maxIndex, _bloomBits;
+	unsigned char *_data;
+	unsigned int _dataLen;
+	unsigned char *_bitmap, *_bloom;
+	IotaLedgerStorage *_storage;
+	char _fingerprint[IOTALEDGER_FINGERPRINT_TRYTES];
+	bool _bound;
+	bool _dirty;
+};
+
+#endif
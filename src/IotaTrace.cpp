@@ -0,0 +1,225 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <Arduino.h>
+
+#include "IotaTrace.h"
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+/* Maximum number of execution contexts (tasks, threads or application-defined
+ * contexts) with distinct ids; events of further contexts are recorded with
+ * id 0. */
+#ifndef IOTATRACE_MAX_CONTEXTS
+#define IOTATRACE_MAX_CONTEXTS	16
+#endif
+
+/* Maximum number of thread ids tracked when exporting events. */
+#define IOTATRACE_MAX_THREADS	(IOTATRACE_MAX_CONTEXTS + 1)
+
+#if defined(ESP32) || defined(__linux__)
+#define IOTATRACE_THREAD_LOCAL	__thread
+#else
+#define IOTATRACE_THREAD_LOCAL
+#endif
+
+static struct iotaTraceEvent *iotaTraceEvents;
+static unsigned int iotaTraceCapacity;
+static volatile bool iotaTraceActive;
+static uint32_t iotaTraceNext;
+static const void *iotaTraceContexts[IOTATRACE_MAX_CONTEXTS];
+static uint32_t iotaTraceGeneration;
+
+static IOTATRACE_THREAD_LOCAL const void *iotaTraceContext;
+static IOTATRACE_THREAD_LOCAL const void *iotaTraceCachedKey;
+static IOTATRACE_THREAD_LOCAL uint32_t iotaTraceCachedGeneration;
+static IOTATRACE_THREAD_LOCAL uint16_t iotaTraceCachedId;
+
+#if defined(ESP32) || defined(__linux__)
+#define IOTATRACE_NEXT_INDEX()	\
+	__atomic_fetch_add(&iotaTraceNext, 1, __ATOMIC_RELAXED)
+#else
+#define IOTATRACE_NEXT_INDEX()	(iotaTraceNext++)
+#endif
+
+/* Assigns a context table slot to a key, unless the slot is assigned to
+ * another key. */
+static bool iotaTraceClaim(const void **slot, const void *key) {
+#if defined(ESP32) || defined(__linux__)
+	const void *expected = NULL;
+
+	return (__atomic_compare_exchange_n(slot, &expected, key, false,
+			__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) || (expected == key));
+#else
+	if (!*slot) {
+		*slot = key;
+	}
+	return (*slot == key);
+#endif
+}
+
+/* Returns a key identifying the calling execution context: the context set
+ * with iotaTraceSetContext(), or else the FreeRTOS task on ESP32 and the
+ * thread (through the address of a thread-local variable) on Linux. */
+static const void *iotaTraceKey() {
+	if (iotaTraceContext) {
+		return iotaTraceContext;
+	}
+#if defined(ESP32)
+	return xTaskGetCurrentTaskHandle();
+#else
+	return &iotaTraceContext;
+#endif
+}
+
+/* Maps the calling execution context to a small id, starting from 1; ids are
+ * assigned in order of first use after iotaTraceStart(). */
+static uint16_t iotaTraceThread() {
+	const void *key = iotaTraceKey();
+
+	if ((key == iotaTraceCachedKey) &&
+			(iotaTraceCachedGeneration == iotaTraceGeneration)) {
+		return iotaTraceCachedId;
+	}
+	iotaTraceCachedKey = key;
+	iotaTraceCachedGeneration = iotaTraceGeneration;
+	iotaTraceCachedId = 0;
+	for (unsigned int i = 0; i < IOTATRACE_MAX_CONTEXTS; i++) {
+		if (iotaTraceClaim(&iotaTraceContexts[i], key)) {
+			iotaTraceCachedId = i + 1;
+			break;
+		}
+	}
+	return iotaTraceCachedId;
+}
+
+void iotaTraceSetContext(const void *context) {
+	iotaTraceContext = context;
+}
+
+void iotaTraceStart(struct iotaTraceEvent *events, unsigned int capacity) {
+	iotaTraceActive = false;
+	iotaTraceEvents = events;
+	iotaTraceCapacity = capacity;
+	iotaTraceNext = 0;
+	memset(iotaTraceContexts, 0, sizeof(iotaTraceContexts));
+	iotaTraceGeneration++;
+	iotaTraceActive = (events && (capacity > 0));
+}
+
+void iotaTraceStop() {
+	iotaTraceActive = false;
+}
+
+unsigned long iotaTraceCount() {
+	return iotaTraceNext;
+}
+
+void iotaTraceRecord(const char *name, char phase) {
+	struct iotaTraceEvent *event;
+
+	if (!iotaTraceActive) {
+		return;
+	}
+	event = &iotaTraceEvents[IOTATRACE_NEXT_INDEX() % iotaTraceCapacity];
+	event->name = name;
+	event->time = micros();
+	event->thread = iotaTraceThread();
+	event->phase = phase;
+}
+
+/* Returns the nesting depth counter of a thread, or NULL if too many threads
+ * have been seen. */
+static unsigned int *iotaTraceDepth(uint16_t *threads, unsigned int *depths,
+		unsigned int &numThreads, uint16_t thread) {
+	for (unsigned int i = 0; i < numThreads; i++) {
+		if (threads[i] == thread) {
+			return &depths[i];
+		}
+	}
+	if (numThreads == IOTATRACE_MAX_THREADS) {
+		return NULL;
+	}
+	threads[numThreads] = thread;
+	depths[numThreads] = 0;
+	return &depths[numThreads++];
+}
+
+unsigned int iotaTraceExport(Print &out) {
+	uint16_t threads[IOTATRACE_MAX_THREADS];
+	unsigned int depths[IOTATRACE_MAX_THREADS];
+	unsigned int numThreads = 0;
+	unsigned int exported = 0;
+	uint32_t total = iotaTraceNext;
+	uint32_t first = 0;
+	uint32_t start = 0;
+	char buf[64];
+
+	if (iotaTraceEvents && (total > iotaTraceCapacity)) {
+		start = total - iotaTraceCapacity;
+	}
+
+	/* Events of different threads can be slightly out of order. */
+	for (uint32_t i = start; iotaTraceEvents && (i < total); i++) {
+		uint32_t time = iotaTraceEvents[i % iotaTraceCapacity].time;
+
+		if ((i == start) || ((int32_t) (time - first) < 0)) {
+			first = time;
+		}
+	}
+	out.print("{\"traceEvents\":[");
+	for (uint32_t i = start; iotaTraceEvents && (i < total); i++) {
+		const struct iotaTraceEvent *event =
+				&iotaTraceEvents[i % iotaTraceCapacity];
+		unsigned int *depth = iotaTraceDepth(threads, depths, numThreads,
+				event->thread);
+
+		if (!depth) {
+			continue;
+		}
+		if (event->phase == 'B') {
+			(*depth)++;
+		}
+		else if (*depth == 0) {
+			continue;
+		}
+		else {
+			(*depth)--;
+		}
+		out.print((exported++ > 0) ? ",\n" : "\n");
+		out.print("{\"name\":\"");
+		out.print(event->name);
+		snprintf(buf, sizeof(buf), "\",\"cat\":\"iota\",\"ph\":\"%c\","
+				"\"ts\":%lu,\"pid\":1,\"tid\":%u}", event->phase,
+				(unsigned long) (event->time - first),
+				(unsigned int) event->thread);
+		out.print(buf);
+	}
+	out.print("\n],\"displayTimeUnit\":\"ms\"}\n");
+	return exported;
+}
@@ -0,0 +1,127 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _IOTA_TRACE_H_
+#define _IOTA_TRACE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Timeline tracing of wallet and client operations
+ *
+ * While tracing is active, the library records begin and end events of the
+ * phases of wallet operations (address derivation, IOTA node commands,
+ * signing, Proof of Work, etc.) in a fixed-size ring buffer supplied by the
+ * application; when the buffer is full, the oldest events are overwritten.
+ * Recording an event costs a few memory writes, and when tracing is not
+ * active only a flag is checked. Recorded events can be exported in the
+ * Chrome trace event format, and viewed e.g. with chrome://tracing or
+ * Perfetto. Tracing is compiled out if the library is built with
+ * IOTA_NO_TRACE defined.
+ */
+
+class Print;
+
+struct iotaTraceEvent {
+	const char *name;	/* static string */
+	uint32_t time;		/* microseconds */
+	uint16_t thread;	/* execution context, see iotaTraceSetContext() */
+	char phase;			/* 'B' (begin) or 'E' (end) */
+};
+
+/** Start recording trace events
+      Events recorded previously are discarded.
+      @param events  Ring buffer where events are recorded
+      @param capacity  Number of events that fit in the buffer
+      @return none
+*/
+void iotaTraceStart(struct iotaTraceEvent *events, unsigned int capacity);
+
+/** Stop recording trace events
+      Recorded events are kept in the buffer and can be exported.
+      @return none
+*/
+void iotaTraceStop();
+
+/** Retrieve number of events recorded since tracing was started
+      @return number of events, including those that have been overwritten
+*/
+unsigned long iotaTraceCount();
+
+/** Export recorded events in Chrome trace event JSON format
+      This function must not be called while traced operations are running.
+      End events whose begin event has been overwritten are omitted.
+      @param out  Output to which the JSON document is written
+      @return number of events exported
+*/
+unsigned int iotaTraceExport(Print &out);
+
+/** Set the execution context of the calling thread
+      Events are recorded with a small id of the execution context in which
+      they occur, which is shown as the thread of the event when exported; by
+      default, the execution context is the FreeRTOS task on ESP32 and the
+      thread on Linux. Applications that run multiple cooperative tasks (e.g.
+      fibers) on the same thread should call this function each time they
+      switch tasks, so that events of different tasks are told apart.
+      @param context  Value that identifies the task being run, e.g. a pointer
+             to its descriptor; NULL reverts to the default execution context
+      @return none
+*/
+void iotaTraceSetContext(const void *context);
+
+/** Record a trace event
+      @param name  Event name; the string must not be freed or modified while
+             the event is in the buffer
+      @param phase  'B' at the beginning of a phase, 'E' at the end
+      @return none
+*/
+void iotaTraceRecord(const char *name, char phase);
+
+/** Scope traced as a phase with a given name
+*/
+class IotaTraceScope {
+public:
+	IotaTraceScope(const char *name) : _name(name) {
+		iotaTraceRecord(_name, 'B');
+	}
+	~IotaTraceScope() {
+		iotaTraceRecord(_name, 'E');
+	}
+
+private:
+	const char *_name;
+};
+
+#ifndef IOTA_NO_TRACE
+#define IOTA_TRACE_SCOPE(name)	IotaTraceScope iotaTraceScope(name)
+#define IOTA_TRACE_BEGIN(name)	iotaTraceRecord(name, 'B')
+#define IOTA_TRACE_END(name)	iotaTraceRecord(name, 'E')
+#else
+#define IOTA_TRACE_SCOPE(name)	do {} while (0)
+#define IOTA_TRACE_BEGIN(name)	do {} while (0)
+#define IOTA_TRACE_END(name)	do {} while (0)
+#endif
+
+#endif
@@ -0,0 +1,239 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "IotaTrafficLog.h"
+
+#define FNV_OFFSET_BASIS	2166136261UL
+#define FNV_PRIME			16777619UL
+
+/* Computes the hash of a JSON document as it is serialized. */
+class IotaTrafficHash : public Print {
+public:
+	IotaTrafficHash() : _hash(FNV_OFFSET_BASIS) {}
+	size_t write(uint8_t b) {
+		_hash = (_hash ^ b) * FNV_PRIME;
+		return 1;
+	}
+	uint32_t get() {
+		return _hash;
+	}
+private:
+	uint32_t _hash;
+};
+
+static uint32_t iotaTrafficHash(JsonDocument &jsonDoc) {
+	IotaTrafficHash hash;
+
+	serializeJson(jsonDoc, hash);
+	return hash.get();
+}
+
+IotaTrafficRecorder::IotaTrafficRecorder(Print &log) : _log(log) {
+	_source = NULL;
+	_pending = false;
+	_count = 0;
+	setTimeout(0);
+}
+
+void IotaTrafficRecorder::flush() {
+	char hdr[IOTATRAFFIC_HDR_MAX_LEN];
+
+	if (!_pending) {
+		return;
+	}
+	snprintf(hdr, sizeof(hdr), "> %s %08lx %lu %lu %lu %d %u\n",
+			_command.c_str(), (unsigned long) _reqHash,
+			_startMillis - _firstMillis, _latency,
+			(_duration > _latency) ? _duration : _latency, _status,
+			(unsigned) _resp.length());
+	_log.print(hdr);
+	_log.write((const uint8_t *) _resp.c_str(), _resp.length());
+	_log.print('\n');
+	_log.flush();
+	_resp = "";
+	_source = NULL;
+	_pending = false;
+	_count++;
+}
+
+unsigned int IotaTrafficRecorder::getCount() {
+	return _count;
+}
+
+int IotaTrafficRecorder::available() {
+	return (_source ? _source->available() : 0);
+}
+
+int IotaTrafficRecorder::read() {
+	int c = (_source ? _source->read() : -1);
+
+	if (c >= 0) {
+		_resp += (char) c;
+		_duration = micros() - _startMicros;
+	}
+	return c;
+}
+
+int IotaTrafficRecorder::peek() {
+	return (_source ? _source->peek() : -1);
+}
+
+size_t IotaTrafficRecorder::write(uint8_t) {
+	return 0;
+}
+
+void IotaTrafficRecorder::begin(JsonDocument &req) {
+	flush();
+	_command = req["command"].as<const char *>();
+	_reqHash = iotaTrafficHash(req);
+	_startMillis = millis();
+	if (_count == 0) {
+		_firstMillis = _startMillis;
+	}
+	_startMicros = micros();
+	_latency = _duration = 0;
+	_status = -1;
+	_pending = true;
+}
+
+void IotaTrafficRecorder::setStatus(int status) {
+	_status = status;
+	_latency = _duration = micros() - _startMicros;
+}
+
+/* Responses are read through the recorder, which copies them to the log
+ * record; the source is the response body of the current request, and reads
+ * time out as they would from the source. */
+void IotaTrafficRecorder::setSource(Stream &source, unsigned long timeout) {
+	_source = &source;
+	setTimeout(timeout);
+}
+
+IotaTrafficReplayer::IotaTrafficReplayer(Stream &log, bool realTime) :
+	_log(log), _realTime(realTime) {
+	_respPos = 0;
+	_transferTime = 0;
+	_count = _mismatches = _divergences = 0;
+	setTimeout(0);
+}
+
+unsigned int IotaTrafficReplayer::getCount() {
+	return _count;
+}
+
+unsigned int IotaTrafficReplayer::getMismatches() {
+	return _mismatches;
+}
+
+unsigned int IotaTrafficReplayer::getDivergences() {
+	return _divergences;
+}
+
+int IotaTrafficReplayer::available() {
+	return _resp.length() - _respPos;
+}
+
+int IotaTrafficReplayer::read() {
+	if (_respPos >= _resp.length()) {
+		return -1;
+	}
+	if (_respPos == _resp.length() - 1) {
+		/* The response body is complete when its last byte is read. */
+		wait(_transferTime);
+		_transferTime = 0;
+	}
+	return (unsigned char) _resp[_respPos++];
+}
+
+int IotaTrafficReplayer::peek() {
+	return ((_respPos < _resp.length()) ?
+			(unsigned char) _resp[_respPos] : -1);
+}
+
+size_t IotaTrafficReplayer::write(uint8_t) {
+	return 0;
+}
+
+/* Serves the next recorded response; a request that does not match the
+ * command of the next record fails as a network error would. */
+int IotaTrafficReplayer::sendRequest(JsonDocument &req) {
+	char hdr[IOTATRAFFIC_HDR_MAX_LEN];
+	char command[IOTATRAFFIC_HDR_MAX_LEN];
+	unsigned long reqHash, start, latency, duration;
+	int status;
+	unsigned int len;
+	size_t hdrLen;
+
+	_resp = "";
+	_respPos = 0;
+	_transferTime = 0;
+	hdrLen = _log.readBytesUntil('\n', hdr, sizeof(hdr) - 1);
+	hdr[hdrLen] = '\0';
+	if (sscanf(hdr, "> %127s %lx %lu %lu %lu %d %u", command, &reqHash,
+			&start, &latency, &duration, &status, &len) != 7) {
+		return -1;
+	}
+	if (strcmp(command, req["command"].as<const char *>())) {
+		_mismatches++;
+		return -1;
+	}
+	if (reqHash != iotaTrafficHash(req)) {
+		_divergences++;
+	}
+	if (!_resp.reserve(len)) {
+		return -1;
+	}
+	for (unsigned int i = 0; i < len; i++) {
+		char c;
+
+		if (_log.readBytes(&c, 1) != 1) {
+			return -1;
+		}
+		_resp += c;
+	}
+	_log.find((char *) "\n");	/* end of response body */
+	_count++;
+	if (_resp.length() == 0) {
+		latency = duration;
+	}
+	wait(latency);
+	_transferTime = duration - latency;
+	return status;
+}
+
+Stream &IotaTrafficReplayer::getResponseStream() {
+	return *this;
+}
+
+void IotaTrafficReplayer::dropResponse() {
+}
+
+void IotaTrafficReplayer::wait(unsigned long us) {
+	if (!_realTime || (us == 0)) {
+		return;
+	}
+	delay(us / 1000);
+	delayMicroseconds(us % 1000);
+}
@@ -0,0 +1,147 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _IOTA_TRAFFIC_LOG_H_
+#define _IOTA_TRAFFIC_LOG_H_
+
+#include <Arduino.h>
+
+#include "IotaTransport.h"
+
+/* Maximum length of a record header in a traffic log. */
+#define IOTATRAFFIC_HDR_MAX_LEN	128
+
+/* A traffic log is a sequence of records, one per request sent to the IOTA
+ * node, each made of a header line followed by the response body and a
+ * newline:
+ *   > <command> <request hash> <start> <latency> <duration> <status> <length>
+ * The request hash is the 32-bit FNV-1a hash (hexadecimal) of the JSON
+ * request; start is the time in milliseconds from the first record, latency
+ * the time in microseconds until the response status has been received and
+ * duration the time in microseconds until the last byte of the response body
+ * has been read; status is -1 for requests that failed at the network level.
+ * Only the part of the response body that is read by the client is logged.
+ */
+
+class IotaTrafficRecorder : public Stream {
+public:
+
+	/** Create a recorder of IOTA node traffic
+      @param log  Output to which log records are written, e.g. a file
+      @return none
+	*/
+	IotaTrafficRecorder(Print &log);
+
+	/** Write the record of the last request to the log
+      Records are written when the next request is sent; this method must be
+      called after the last request, before the log is closed.
+      @return none
+	*/
+	void flush();
+
+	/** Retrieve number of records written to the log
+      @return number of records
+	*/
+	unsigned int getCount();
+
+	int available();
+	int read();
+	int peek();
+	size_t write(uint8_t b);
+
+private:
+	friend class IotaClient;
+	void begin(JsonDocument &req);
+	void setStatus(int status);
+	void setSource(Stream &source, unsigned long timeout);
+
+	Print &_log;
+	Stream *_source;
+	bool _pending;
+	String _command;
+	uint32_t _reqHash;
+	unsigned long _firstMillis;
+	unsigned long _startMillis, _startMicros;
+	unsigned long _latency, _duration;
+	int _status;
+	String _resp;
+	unsigned int _count;
+};
+
+class IotaTrafficReplayer : public Stream, public IotaTransport {
+public:
+
+	/** Create a replayer of IOTA node traffic
+      Responses are served from a traffic log written by IotaTrafficRecorder,
+      in the order in which they have been recorded, without sending requests
+      to the node. A request that does not match the command of the next
+      record fails as a network error would.
+      @param log  Input from which log records are read, e.g. a file
+      @param realTime  If true, each response is served with the latency and
+             duration it had when recorded; if false, responses are served as
+             fast as possible
+      @return none
+	*/
+	IotaTrafficReplayer(Stream &log, bool realTime = true);
+
+	/** Retrieve number of records replayed
+      @return number of records
+	*/
+	unsigned int getCount();
+
+	/** Retrieve number of requests whose command did not match the next
+      record
+      @return number of mismatched requests
+	*/
+	unsigned int getMismatches();
+
+	/** Retrieve number of requests whose contents differ from the recorded
+      ones (e.g. because bundles contain timestamps and signatures that
+      change at each run), while the command matched
+      @return number of requests that differ from the recorded ones
+	*/
+	unsigned int getDivergences();
+
+	int available();
+	int read();
+	int peek();
+	size_t write(uint8_t b);
+
+	int sendRequest(JsonDocument &jsonDoc);
+	Stream &getResponseStream();
+	void dropResponse();
+
+private:
+	void wait(unsigned long us);
+
+	Stream &_log;
+	bool _realTime;
+	String _resp;
+	unsigned int _respPos;
+	unsigned long _transferTime;
+	unsigned int _count, _mismatches, _divergences;
+};
+
+#endif
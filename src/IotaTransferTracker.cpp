@@ -0,0 +1,177 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "IotaTransferTracker.h"
+#include "IotaCurl.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "iota-c-library/src/iota/common.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef IOTATRACKER_DEBUG
+#define DPRINTF	printf
+#else
+#define DPRINTF(fmt, ...)	do {} while(0)
+#endif
+
+static String iotaTrackerTxHash(String &tx) {
+	char hash[NUM_HASH_TRYTES + 1];
+
+	iotaCurlTxHash(tx.c_str(), hash);
+	hash[NUM_HASH_TRYTES] = '\0';
+	return String(hash);
+}
+
+IotaTransferTracker::IotaTransferTracker(IotaWallet &wallet,
+		IotaClient &iotaClient) : _wallet(wallet), _iotaClient(iotaClient) {
+	_promoteInterval = IOTATRACKER_PROMOTE_INTERVAL;
+	_maxPromotions = IOTATRACKER_MAX_PROMOTIONS;
+}
+
+void IotaTransferTracker::setPromoteInterval(unsigned long interval) {
+	_promoteInterval = interval;
+}
+
+void IotaTransferTracker::setMaxPromotions(unsigned int maxPromotions) {
+	_maxPromotions = maxPromotions;
+}
+
+bool IotaTransferTracker::addTransfer(std::vector<String> &txs) {
+	struct iotaPendingTransfer transfer;
+
+	if (txs.size() == 0) {
+		return false;
+	}
+	/* The tail transaction is the last one in the list. */
+	String &tail = txs[txs.size() - 1];
+
+	transfer.bundle = tail.substring(IOTA_TX_BUNDLE_OFFSET,
+			IOTA_TX_BUNDLE_OFFSET + NUM_HASH_TRYTES);
+	if (!iotaPackTransactions(txs, transfer.txs)) {
+		return false;
+	}
+	transfer.tails.push_back(iotaTrackerTxHash(tail));
+	transfer.lastActionTime = millis();
+	transfer.promotions = 0;
+	_transfers.push_back(transfer);
+	DPRINTF("%s: tracking bundle %s\n", __FUNCTION__,
+			transfer.bundle.c_str());
+	return true;
+}
+
+unsigned int IotaTransferTracker::getPendingCount() {
+	return _transfers.size();
+}
+
+const std::vector<struct iotaPendingTransfer> &
+		IotaTransferTracker::getPendingTransfers() {
+	return _transfers;
+}
+
+bool IotaTransferTracker::update(unsigned int *confirmed) {
+	std::vector<String> tails;
+	std::vector<bool> states;
+	unsigned int numConfirmed = 0;
+
+	if (confirmed) {
+		*confirmed = 0;
+	}
+	if (_transfers.size() == 0) {
+		return true;
+	}
+
+	/* Check the inclusion state of all attachments of all pending transfers
+	 * against the latest milestone in one go. */
+	for (auto it = _transfers.cbegin(); it != _transfers.cend(); it++) {
+		tails.insert(tails.end(), it->tails.cbegin(), it->tails.cend());
+	}
+	if (!_iotaClient.getLatestInclusion(tails, states)) {
+		DPRINTF("%s: couldn't get inclusion states\n", __FUNCTION__);
+		return false;
+	}
+	unsigned int stateIdx = 0;
+	for (auto it = _transfers.begin(); it != _transfers.end(); ) {
+		bool included = false;
+
+		for (unsigned int i = 0; i < it->tails.size(); i++) {
+			included |= states[stateIdx++];
+		}
+		if (included) {
+			DPRINTF("%s: bundle %s confirmed\n", __FUNCTION__,
+					it->bundle.c_str());
+			it = _transfers.erase(it);
+			numConfirmed++;
+		}
+		else {
+			it++;
+		}
+	}
+	if (confirmed) {
+		*confirmed = numConfirmed;
+	}
+
+	for (auto it = _transfers.begin(); it != _transfers.end(); it++) {
+		if (millis() - it->lastActionTime < _promoteInterval) {
+			continue;
+		}
+		String &tail = it->tails[it->tails.size() - 1];
+		bool promotable = false;
+
+		if ((it->promotions < _maxPromotions) &&
+				!_wallet.isPromotable(tail, promotable)) {
+			return false;
+		}
+		if (promotable) {
+			DPRINTF("%s: promoting bundle %s\n", __FUNCTION__,
+					it->bundle.c_str());
+			if (!_wallet.promoteTransaction(tail)) {
+				return false;
+			}
+			it->promotions++;
+		}
+		else {
+			DPRINTF("%s: reattaching bundle %s\n", __FUNCTION__,
+					it->bundle.c_str());
+			std::vector<String> txs;
+
+			if (!iotaUnpackTransactions(it->txs, txs) ||
+					!_wallet.reattachBundle(txs) ||
+					!iotaPackTransactions(txs, it->txs)) {
+				return false;
+			}
+			it->tails.push_back(iotaTrackerTxHash(txs[txs.size() - 1]));
+			it->promotions = 0;
+		}
+		it->lastActionTime = millis();
+	}
+	return true;
+}
@@ -0,0 +1,123 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _IOTA_TRANSFER_TRACKER_H_
+#define _IOTA_TRANSFER_TRACKER_H_
+
+#include <Arduino.h>
+#ifdef min
+#undef min
+#endif
+#ifdef max
+#undef max
+#endif
+#include <vector>
+
+#include "IotaClient.h"
+#include "IotaPackedTx.h"
+#include "IotaWallet.h"
+
+#define IOTATRACKER_PROMOTE_INTERVAL	60000
+#define IOTATRACKER_MAX_PROMOTIONS		3
+
+/* Bundle transactions are kept in packed format to save memory while the
+ * transfer is pending. */
+struct iotaPendingTransfer {
+	String bundle;
+	std::vector<IotaPackedTx> txs;
+	std::vector<String> tails;
+	unsigned long lastActionTime;
+	unsigned int promotions;
+};
+
+class IotaTransferTracker {
+public:
+
+	/** Create a tracker of pending transfers
+      @param wallet  IOTA wallet used to promote and reattach pending transfers
+      @param iotaClient  IOTA client used to communicate with full IOTA node
+      @return none
+	*/
+	IotaTransferTracker(IotaWallet &wallet, IotaClient &iotaClient);
+
+	/** Configure promotion interval
+      @param interval  Time (in milliseconds) after which a pending transfer
+             that has not been confirmed is promoted or reattached
+      @return none
+	*/
+	void setPromoteInterval(unsigned long interval);
+
+	/** Configure maximum number of promotions
+      @param maxPromotions  Number of times a pending transfer is promoted
+             before being reattached to the tangle; if zero, pending transfers
+             are always reattached instead of being promoted
+      @return none
+	*/
+	void setMaxPromotions(unsigned int maxPromotions);
+
+	/** Add a transfer to the list of pending transfers
+      @param txs  Transactions (with Proof of Work) constituting the bundle of
+             the transfer, in the same order as returned by the attachToTangle()
+             method of the IOTA client
+      @return true if the transfer has been added, false if the supplied
+              transactions are not valid
+	*/
+	bool addTransfer(std::vector<String> &txs);
+
+	/** Retrieve number of pending transfers
+      @return number of transfers that have not been confirmed yet
+	*/
+	unsigned int getPendingCount();
+
+	/** Retrieve pending transfers
+      @return list of transfers that have not been confirmed yet
+	*/
+	const std::vector<struct iotaPendingTransfer> &getPendingTransfers();
+
+	/** Update status of pending transfers
+      This method queries the connected IOTA full node for the inclusion state
+      of all pending transfers in batched requests, removes confirmed
+      transfers from the list of pending transfers, and promotes or reattaches
+      transfers that have been pending for longer than the promotion interval;
+      a transfer whose tail transaction is no longer consistent is reattached
+      without trying to promote it.
+      It should be called periodically.
+      @param confirmed  Pointer to variable where the number of transfers found
+             to be confirmed will be stored; if NULL (default value), this
+             information is not returned
+      @return true if communication with the IOTA full node is successful, false
+              otherwise
+	*/
+	bool update(unsigned int *confirmed = NULL);
+
+private:
+	IotaWallet &_wallet;
+	IotaClient &_iotaClient;
+	unsigned long _promoteInterval;
+	unsigned int _maxPromotions;
+	std::vector<struct iotaPendingTransfer> _transfers;
+};
+
+#endif
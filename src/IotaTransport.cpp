@@ -0,0 +1,193 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "IotaTransport.h"
+
+/* Size of the buffer used to send request bodies (one TCP segment). */
+#define IOTATRANSPORT_SEND_BUF_SIZE	1460
+
+#ifdef IOTATRANSPORT_DEBUG
+#define DPRINTF	printf
+#else
+#define DPRINTF(fmt, ...)	do {} while(0)
+#endif
+
+DeserializationError IotaTransport::readResponse(JsonDocument &jsonDoc) {
+	return deserializeJson(jsonDoc, getResponseStream());
+}
+
+unsigned long IotaTransport::getResponseTimeout() {
+	return 0;
+}
+
+#ifdef ESP8266
+IotaHttpTransport::IotaHttpTransport(Client &networkClient, const char *host,
+		int port) {
+	_client.begin(static_cast<WiFiClient&>(networkClient), host, port);
+	_client.setTimeout(IOTATRANSPORT_STREAM_TIMEOUT);
+}
+#else
+IotaHttpTransport::IotaHttpTransport(Client &networkClient, const char *host,
+		int port) : _client(networkClient, host, port) {
+}
+#endif
+
+int IotaHttpTransport::sendRequest(JsonDocument &jsonDoc) {
+	return _client.sendRequest(jsonDoc);
+}
+
+Stream &IotaHttpTransport::getResponseStream() {
+#ifdef ESP8266
+	return _client.getStream();
+#else
+	_client.skipResponseHeaders();
+	return _client;
+#endif
+}
+
+DeserializationError IotaHttpTransport::readResponse(JsonDocument &jsonDoc) {
+#ifdef ESP8266
+	return deserializeJson(jsonDoc, _client.getStream());
+#else
+	return deserializeJson(jsonDoc, _client.responseBody());
+#endif
+}
+
+void IotaHttpTransport::dropResponse() {
+#ifdef ESP8266
+	_client.end();
+#else
+	_client.stop();
+#endif
+}
+
+unsigned long IotaHttpTransport::getResponseTimeout() {
+	return IOTATRANSPORT_STREAM_TIMEOUT;
+}
+
+int IotaHttpTransport::JsonHttpClient::sendRequest(JsonDocument &jsonDoc) {
+	int contentLen = measureJson(jsonDoc);
+
+#ifdef ESP8266
+
+	disconnect(true);	/* Clean up previous connection, if any. */
+	addHeader("Content-Type", "application/json");
+	addHeader("X-IOTA-API-Version", "1");
+	addHeader("Content-Length", String(contentLen));
+	if (!connect()) {
+		return returnError(HTTPC_ERROR_CONNECTION_REFUSED);
+	}
+	if (!sendHeader("POST")) {
+		return returnError(HTTPC_ERROR_SEND_HEADER_FAILED);
+	}
+
+	class BufferedWiFiPrint : public Print {
+	public:
+		BufferedWiFiPrint(WiFiClient &wifi) : _wifi(wifi) {
+			_byteCount = 0;
+		}
+		size_t write(uint8_t b) {
+			_buf[_byteCount++] = b;
+			if (_byteCount == sizeof(_buf)) {
+				_wifi.write(_buf, _byteCount);
+				_byteCount = 0;
+			}
+			return 1;
+		}
+		void flush() {
+			if (_byteCount != 0) {
+				_wifi.write(_buf, _byteCount);
+				_byteCount = 0;
+			}
+		}
+	private:
+		size_t _byteCount;
+		uint8_t _buf[IOTATRANSPORT_SEND_BUF_SIZE];
+		WiFiClient &_wifi;
+	} print(getStream());
+	serializeJson(jsonDoc, print);
+	print.flush();
+
+	return returnError(handleHeaderResponse());
+
+#else
+
+	beginRequest();
+	if (post("/") != HTTP_SUCCESS) {
+		DPRINTF("%s: cannot send POST request\n", __FUNCTION__);
+		return -1;
+	}
+	sendHeader("Content-Type", "application/json");
+	sendHeader("X-IOTA-API-Version", "1");
+	sendHeader("Content-Length", contentLen);
+	beginBody();
+
+	class BufferedNetworkPrint : public Print {
+	public:
+		BufferedNetworkPrint(Client &networkClient) :
+			_networkClient(networkClient) {
+			_byteCount = 0;
+		}
+		size_t write(uint8_t b) {
+			_buf[_byteCount++] = b;
+			if (_byteCount == sizeof(_buf)) {
+				if (!_networkClient.write(_buf, _byteCount)) {
+					_byteCount--;
+					return 0;
+				}
+				_byteCount = 0;
+			}
+			return 1;
+		}
+		void flush() {
+			if (_byteCount != 0) {
+				_networkClient.write(_buf, _byteCount);
+				_byteCount = 0;
+			}
+		}
+	private:
+		size_t _byteCount;
+		uint8_t _buf[IOTATRANSPORT_SEND_BUF_SIZE];
+		Client &_networkClient;
+	} print(*iClient);
+	int written = serializeJson(jsonDoc, print);
+	if (written != contentLen) {
+		DPRINTF("%s: wrote %d of %d bytes\n", __FUNCTION__, written,
+				contentLen);
+		return -1;
+	}
+	print.flush();
+
+	/* Wait for the response in short steps: the HTTP client sleeps for a
+	 * fixed delay whenever no data is available, which would add up to that
+	 * delay to the latency of each request. */
+	unsigned long start = millis();
+	while (!iClient->available() && iClient->connected() &&
+			(millis() - start < iHttpResponseTimeout)) {
+		delay(1);
+	}
+	return responseStatusCode();
+#endif
+}
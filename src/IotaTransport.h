@@ -0,0 +1,130 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _IOTA_TRANSPORT_H_
+#define _IOTA_TRANSPORT_H_
+
+#include <Arduino.h>
+#ifdef ESP8266
+#include <ESP8266HTTPClient.h>
+#else
+#include <ArduinoHttpClient.h>
+#endif
+#ifdef min
+#undef min
+#endif
+#ifdef max
+#undef max
+#endif
+
+#define ARDUINOJSON_USE_LONG_LONG	1
+#include <ArduinoJson.h>
+
+/* Timeout in milliseconds for reading response data from the network. */
+#ifndef IOTATRANSPORT_STREAM_TIMEOUT
+#ifdef ESP8266
+#define IOTATRANSPORT_STREAM_TIMEOUT	(16 * 1024)
+#else
+#define IOTATRANSPORT_STREAM_TIMEOUT	1000
+#endif
+#endif
+
+/* A transport carries the JSON requests of an IotaClient to a IOTA node and
+ * the responses back. Requests are sent one at a time: the response to a
+ * request is read (or dropped) before the next request is sent. */
+class IotaTransport {
+public:
+	virtual ~IotaTransport() {}
+
+	/** Send a request to the IOTA node and wait for the response status
+      @param jsonDoc  JSON request
+      @return HTTP status code of the response, or a negative value if the
+              request could not be sent or no response has been received
+	*/
+	virtual int sendRequest(JsonDocument &jsonDoc) = 0;
+
+	/** Retrieve the stream from which the body of the response to the last
+      request is read
+      @return response body stream
+	*/
+	virtual Stream &getResponseStream() = 0;
+
+	/** Parse the body of the response to the last request
+      The default implementation parses the response stream; transports can
+      override it to parse the body from a buffer.
+      @param jsonDoc  JSON document that is filled with the response
+      @return deserialization result
+	*/
+	virtual DeserializationError readResponse(JsonDocument &jsonDoc);
+
+	/** Discard the rest of the response to the last request
+      @return none
+	*/
+	virtual void dropResponse() = 0;
+
+	/** Retrieve timeout for reading response data from the response stream
+      @return timeout in milliseconds, 0 if responses are read from memory
+	*/
+	virtual unsigned long getResponseTimeout();
+};
+
+/* Transport over HTTP, with ESP8266HTTPClient on ESP8266 and with
+ * ArduinoHttpClient on the other platforms; each request is sent with a
+ * blocking network client. This is the transport of IotaClient objects
+ * created with a network client. */
+class IotaHttpTransport : public IotaTransport {
+public:
+
+	/** Create a HTTP transport
+      @param networkClient  Network client used to perform the underlying
+             network communication
+      @param host  IOTA node host, expressed as either host name or IP address
+             with dotted notation
+      @param port  IOTA node port
+      @return none
+	*/
+	IotaHttpTransport(Client &networkClient, const char *host, int port);
+
+	int sendRequest(JsonDocument &jsonDoc);
+	Stream &getResponseStream();
+	DeserializationError readResponse(JsonDocument &jsonDoc);
+	void dropResponse();
+	unsigned long getResponseTimeout();
+
+private:
+#ifdef ESP8266
+	class JsonHttpClient : public HTTPClient {
+#else
+	class JsonHttpClient : public HttpClient {
+	public:
+		JsonHttpClient(Client &networkClient, const char *host, int port) :
+			HttpClient(networkClient, host, port) {}
+#endif
+	public:
+		int sendRequest(JsonDocument &jsonDoc);
+	} _client;
+};
+
+#endif
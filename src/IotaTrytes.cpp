@@ -0,0 +1,217 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "IotaTrytes.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define IOTATRYTES_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define IOTATRYTES_NEON
+#endif
+
+/* Tryte value of each ASCII character; characters that are not valid trytes
+ * map to 0 (callers are expected to validate input first). */
+static const int8_t tryteValues[128] = {
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   1,   2,   3,   4,   5,   6,   7,   8,   9,  10,  11,  12,  13, -13, -12,
+	-11, -10,  -9,  -8,  -7,  -6,  -5,  -4,  -3,  -2,  -1,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0
+};
+
+/* Trits of each tryte value, indexed by value + 13. */
+static const int8_t tryteTrits[27][3] = {
+	{-1, -1, -1},
+	{ 0, -1, -1},
+	{ 1, -1, -1},
+	{-1,  0, -1},
+	{ 0,  0, -1},
+	{ 1,  0, -1},
+	{-1,  1, -1},
+	{ 0,  1, -1},
+	{ 1,  1, -1},
+	{-1, -1,  0},
+	{ 0, -1,  0},
+	{ 1, -1,  0},
+	{-1,  0,  0},
+	{ 0,  0,  0},
+	{ 1,  0,  0},
+	{-1,  1,  0},
+	{ 0,  1,  0},
+	{ 1,  1,  0},
+	{-1, -1,  1},
+	{ 0, -1,  1},
+	{ 1, -1,  1},
+	{-1,  0,  1},
+	{ 0,  0,  1},
+	{ 1,  0,  1},
+	{-1,  1,  1},
+	{ 0,  1,  1},
+	{ 1,  1,  1}
+};
+
+static const char tryteChars[27] = {
+	'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
+	'9', 'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M',
+};
+
+static inline bool isTryte(char c) {
+	return ((c == '9') || ((c >= 'A') && (c <= 'Z')));
+}
+
+static inline int8_t charToValue(char c) {
+	return tryteValues[(unsigned char) c & 0x7F];
+}
+
+bool iotaTrytesValidate(const char *trytes, unsigned int len) {
+	unsigned int i = 0;
+
+#if defined(IOTATRYTES_SSE2)
+	const __m128i belowA = _mm_set1_epi8('A' - 1);
+	const __m128i aboveZ = _mm_set1_epi8('Z' + 1);
+	const __m128i nine = _mm_set1_epi8('9');
+
+	for (; i + 16 <= len; i += 16) {
+		__m128i c = _mm_loadu_si128((const __m128i *) (trytes + i));
+
+		/* Signed comparisons also reject bytes >= 0x80. */
+		__m128i ok = _mm_or_si128(_mm_cmpeq_epi8(c, nine),
+				_mm_and_si128(_mm_cmpgt_epi8(c, belowA),
+						_mm_cmplt_epi8(c, aboveZ)));
+		if (_mm_movemask_epi8(ok) != 0xFFFF) {
+			return false;
+		}
+	}
+#elif defined(IOTATRYTES_NEON)
+	const uint8x16_t letterA = vdupq_n_u8('A');
+	const uint8x16_t letterCount = vdupq_n_u8(26);
+	const uint8x16_t nine = vdupq_n_u8('9');
+
+	for (; i + 16 <= len; i += 16) {
+		uint8x16_t c = vld1q_u8((const uint8_t *) (trytes + i));
+		uint8x16_t ok = vorrq_u8(vceqq_u8(c, nine),
+				vcltq_u8(vsubq_u8(c, letterA), letterCount));
+
+		if (vminvq_u8(ok) == 0) {
+			return false;
+		}
+	}
+#endif
+	for (; i < len; i++) {
+		if (!isTryte(trytes[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void iotaTrytesToValues(const char *trytes, int8_t *values, unsigned int len) {
+	unsigned int i = 0;
+
+#if defined(IOTATRYTES_SSE2)
+	const __m128i offset = _mm_set1_epi8('A' - 1);
+	const __m128i nine = _mm_set1_epi8('9');
+	const __m128i thirteen = _mm_set1_epi8(13);
+	const __m128i wrap = _mm_set1_epi8(27);
+
+	for (; i + 16 <= len; i += 16) {
+		__m128i c = _mm_loadu_si128((const __m128i *) (trytes + i));
+		__m128i v = _mm_andnot_si128(_mm_cmpeq_epi8(c, nine),
+				_mm_sub_epi8(c, offset));
+
+		v = _mm_sub_epi8(v, _mm_and_si128(_mm_cmpgt_epi8(v, thirteen), wrap));
+		_mm_storeu_si128((__m128i *) (values + i), v);
+	}
+#elif defined(IOTATRYTES_NEON)
+	const int8x16_t offset = vdupq_n_s8('A' - 1);
+	const int8x16_t nine = vdupq_n_s8('9');
+	const int8x16_t thirteen = vdupq_n_s8(13);
+	const int8x16_t wrap = vdupq_n_s8(27);
+
+	for (; i + 16 <= len; i += 16) {
+		int8x16_t c = vld1q_s8((const int8_t *) (trytes + i));
+		int8x16_t v = vbicq_s8(vsubq_s8(c, offset),
+				vreinterpretq_s8_u8(vceqq_s8(c, nine)));
+
+		v = vsubq_s8(v, vandq_s8(vreinterpretq_s8_u8(vcgtq_s8(v, thirteen)),
+				wrap));
+		vst1q_s8(values + i, v);
+	}
+#endif
+	for (; i < len; i++) {
+		values[i] = charToValue(trytes[i]);
+	}
+}
+
+void iotaTrytesToTrits(const char *trytes, int8_t *trits, unsigned int len) {
+	for (unsigned int i = 0; i < len; i++) {
+		const int8_t *t = tryteTrits[charToValue(trytes[i]) + 13];
+
+		trits[0] = t[0];
+		trits[1] = t[1];
+		trits[2] = t[2];
+		trits += 3;
+	}
+}
+
+void iotaTritsToTrytes(const int8_t *trits, char *trytes, unsigned int len) {
+	for (unsigned int i = 0; i < len; i++) {
+		trytes[i] = tryteChars[trits[0] + 3 * trits[1] + 9 * trits[2] + 13];
+		trits += 3;
+	}
+}
+
+int64_t iotaTrytesToInt64(const char *trytes, unsigned int len) {
+	int64_t value = 0;
+
+	/* Horner's scheme from the most significant tryte; the unsigned
+	 * accumulator makes wrap-around on out-of-range fields well defined. */
+	while (len > 0) {
+		value = (int64_t) ((uint64_t) value * 27 + charToValue(trytes[--len]));
+	}
+	return value;
+}
+
+void iotaInt64ToTrytes(int64_t value, char *trytes, unsigned int len) {
+	for (unsigned int i = 0; i < len; i++) {
+		int tryte = value % 27;
+
+		if (tryte > 13) {
+			tryte -= 27;
+		}
+		else if (tryte < -13) {
+			tryte += 27;
+		}
+		trytes[i] = tryteChars[tryte + 13];
+		value = (value - tryte) / 27;
+	}
+}
@@ -0,0 +1,83 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _IOTA_TRYTES_H_
+#define _IOTA_TRYTES_H_
+
+#include <stdint.h>
+
+/** Check that a sequence of characters contains only valid trytes
+      Valid tryte characters are '9' and uppercase letters. Whole transactions
+      and hashes are checked 16 characters at a time on platforms with SSE2 or
+      NEON support.
+      @param trytes  Characters to be checked
+      @param len  Number of characters
+      @return true if all characters are valid trytes, false otherwise
+*/
+bool iotaTrytesValidate(const char *trytes, unsigned int len);
+
+/** Convert tryte characters to tryte values
+      @param trytes  Tryte characters
+      @param values  Buffer that is filled with tryte values (from -13 to 13)
+      @param len  Number of trytes
+      @return none
+*/
+void iotaTrytesToValues(const char *trytes, int8_t *values, unsigned int len);
+
+/** Convert tryte characters to trits
+      @param trytes  Tryte characters
+      @param trits  Buffer that is filled with trits (3 for each tryte)
+      @param len  Number of trytes
+      @return none
+*/
+void iotaTrytesToTrits(const char *trytes, int8_t *trits, unsigned int len);
+
+/** Convert trits to tryte characters
+      @param trits  Trits (3 for each tryte)
+      @param trytes  Buffer that is filled with tryte characters (no string
+             terminator is appended)
+      @param len  Number of trytes
+      @return none
+*/
+void iotaTritsToTrytes(const int8_t *trits, char *trytes, unsigned int len);
+
+/** Convert tryte characters to an integer value
+      @param trytes  Tryte characters, least significant first (as in
+             transaction fields)
+      @param len  Number of trytes
+      @return integer value
+*/
+int64_t iotaTrytesToInt64(const char *trytes, unsigned int len);
+
+/** Convert an integer value to tryte characters
+      @param value  Integer value
+      @param trytes  Buffer that is filled with tryte characters, least
+             significant first (no string terminator is appended)
+      @param len  Number of trytes
+      @return none
+*/
+void iotaInt64ToTrytes(int64_t value, char *trytes, unsigned int len);
+
+#endif
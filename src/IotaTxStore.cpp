@@ -0,0 +1,445 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "IotaTxStore.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "iota-c-library/src/iota/common.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef IOTATXSTORE_DEBUG
+#define DPRINTF	printf
+#else
+#define DPRINTF(fmt, ...)	do {} while(0)
+#endif
+
+#define IOTATXSTORE_NONE		0xFFFFFFFF
+#define IOTATXSTORE_MIN_BUCKETS	16
+
+/* Log file header: magic, record size, number of records, slot of the oldest
+ * record once the log has wrapped. */
+#define IOTATXSTORE_MAGIC		0x49545831
+#define IOTATXSTORE_HDR_SIZE	16
+
+/* Number of records by which the log file is grown initially. */
+#define IOTATXSTORE_FILE_CHUNK	1024
+
+static uint32_t iotaTxStoreKey(const char *trytes) {
+	uint32_t hash = 2166136261U;
+
+	for (unsigned int i = 0; i < NUM_HASH_TRYTES; i++) {
+		hash = (hash ^ (uint8_t) trytes[i]) * 16777619U;
+	}
+	return hash;
+}
+
+IotaTxStore::IotaTxStore(unsigned int capacity)
+: _capacity(0), _count(0), _head(0), _ownRecords(true) {
+	_records = (struct iotaStoredTx *) malloc(capacity * sizeof(*_records));
+	if (_records) {
+		_capacity = capacity;
+	}
+	initIndexes();
+}
+
+IotaTxStore::IotaTxStore(struct iotaStoredTx *records, unsigned int capacity)
+: _records(records), _capacity(capacity), _count(0), _head(0),
+		_ownRecords(false) {
+	initIndexes();
+}
+
+IotaTxStore::~IotaTxStore() {
+	if (_ownRecords) {
+		free(_records);
+	}
+}
+
+unsigned int IotaTxStore::getCount() {
+	return _count;
+}
+
+unsigned int IotaTxStore::getCapacity() {
+	return _capacity;
+}
+
+bool IotaTxStore::add(const String &hash, const String &trytes) {
+	IotaPackedTx tx;
+
+	if ((hash.length() < NUM_HASH_TRYTES) || !tx.pack(trytes)) {
+		return false;
+	}
+	return add(hash.c_str(), tx);
+}
+
+bool IotaTxStore::add(const char *hash, const IotaPackedTx &tx) {
+	unsigned int slot;
+
+	if (lookup(hash) >= 0) {
+		return true;
+	}
+	if ((_count == _capacity) && !grow()) {
+		if (_capacity == 0) {
+			return false;
+		}
+
+		/* Replace the oldest transaction. */
+		slot = _head;
+		for (unsigned int i = 0; i < IOTATXSTORE_INDEXES; i++) {
+			unlink(i, slot);
+		}
+	}
+	else if (_count < _capacity) {
+		slot = _count++;
+	}
+	else {
+		return false;
+	}
+	memcpy(_records[slot].hash, hash, NUM_HASH_TRYTES);
+	memcpy(_records[slot].tx, tx.getData(), IOTAPACKED_TX_BYTES);
+	_head = (slot + 1) % _capacity;
+	indexRecord(slot);
+	commit();
+	return true;
+}
+
+bool IotaTxStore::get(const char *hash, IotaPackedTx &tx) {
+	int slot = lookup(hash);
+
+	return ((slot >= 0) && tx.setData(_records[slot].tx));
+}
+
+bool IotaTxStore::getTrytes(const String &hash, String &trytes) {
+	IotaPackedTx tx;
+
+	if ((hash.length() < NUM_HASH_TRYTES) || !get(hash.c_str(), tx)) {
+		return false;
+	}
+	return tx.unpack(trytes);
+}
+
+unsigned int IotaTxStore::findByAddress(const char *addr,
+		iotaHashCallback callback, void *arg) {
+	return find(IOTATXSTORE_BY_ADDR, addr, callback, arg);
+}
+
+unsigned int IotaTxStore::findByBundle(const char *bundle,
+		iotaHashCallback callback, void *arg) {
+	return find(IOTATXSTORE_BY_BUNDLE, bundle, callback, arg);
+}
+
+void IotaTxStore::clear() {
+	_count = 0;
+	_head = 0;
+	initIndexes();
+}
+
+bool IotaTxStore::grow() {
+	return false;
+}
+
+void IotaTxStore::commit() {
+}
+
+bool IotaTxStore::setRecords(struct iotaStoredTx *records,
+		unsigned int capacity, unsigned int count, unsigned int head) {
+	_records = records;
+	_capacity = capacity;
+	_count = count;
+	if (count < capacity) {
+		_head = count;
+	}
+	else {
+		_head = (capacity > 0) ? (head % capacity) : 0;
+	}
+	if (!initIndexes()) {
+		return false;
+	}
+	for (unsigned int slot = 0; slot < count; slot++) {
+		indexRecord(slot);
+	}
+	return true;
+}
+
+bool IotaTxStore::initIndexes() {
+	unsigned int numBuckets = IOTATXSTORE_MIN_BUCKETS;
+
+	while (numBuckets < _capacity) {
+		numBuckets *= 2;
+	}
+	for (unsigned int i = 0; i < IOTATXSTORE_INDEXES; i++) {
+		struct iotaTxIndex &index = _indexes[i];
+
+		index.buckets.assign(numBuckets, IOTATXSTORE_NONE);
+		index.next.assign(_capacity, IOTATXSTORE_NONE);
+		index.keys.assign(_capacity, 0);
+		if ((index.buckets.size() != numBuckets) ||
+				(index.next.size() != _capacity)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void IotaTxStore::link(unsigned int index, uint32_t key, unsigned int slot) {
+	struct iotaTxIndex &idx = _indexes[index];
+	uint32_t &bucket = idx.buckets[key & (idx.buckets.size() - 1)];
+
+	idx.keys[slot] = key;
+	idx.next[slot] = bucket;
+	bucket = slot;
+}
+
+void IotaTxStore::unlink(unsigned int index, unsigned int slot) {
+	struct iotaTxIndex &idx = _indexes[index];
+	uint32_t *entry =
+			&idx.buckets[idx.keys[slot] & (idx.buckets.size() - 1)];
+
+	while (*entry != IOTATXSTORE_NONE) {
+		if (*entry == slot) {
+			*entry = idx.next[slot];
+			break;
+		}
+		entry = &idx.next[*entry];
+	}
+}
+
+void IotaTxStore::indexRecord(unsigned int slot) {
+	char addr[NUM_HASH_TRYTES];
+	char bundle[NUM_HASH_TRYTES];
+	IotaPackedTx tx;
+
+	tx.setData(_records[slot].tx);
+	tx.getAddress(addr);
+	tx.getBundle(bundle);
+	link(IOTATXSTORE_BY_HASH, iotaTxStoreKey(_records[slot].hash), slot);
+	link(IOTATXSTORE_BY_ADDR, iotaTxStoreKey(addr), slot);
+	link(IOTATXSTORE_BY_BUNDLE, iotaTxStoreKey(bundle), slot);
+}
+
+bool IotaTxStore::matches(unsigned int index, unsigned int slot,
+		const char *key) {
+	char field[NUM_HASH_TRYTES];
+	IotaPackedTx tx;
+
+	if (index == IOTATXSTORE_BY_HASH) {
+		return !memcmp(_records[slot].hash, key, NUM_HASH_TRYTES);
+	}
+	tx.setData(_records[slot].tx);
+	if (index == IOTATXSTORE_BY_ADDR) {
+		tx.getAddress(field);
+	}
+	else {
+		tx.getBundle(field);
+	}
+	return !memcmp(field, key, NUM_HASH_TRYTES);
+}
+
+int IotaTxStore::lookup(const char *hash) {
+	struct iotaTxIndex &idx = _indexes[IOTATXSTORE_BY_HASH];
+	uint32_t key = iotaTxStoreKey(hash);
+
+	if (_count == 0) {
+		return -1;
+	}
+	for (uint32_t slot = idx.buckets[key & (idx.buckets.size() - 1)];
+			slot != IOTATXSTORE_NONE; slot = idx.next[slot]) {
+		if ((idx.keys[slot] == key) &&
+				matches(IOTATXSTORE_BY_HASH, slot, hash)) {
+			return slot;
+		}
+	}
+	return -1;
+}
+
+unsigned int IotaTxStore::find(unsigned int index, const char *key,
+		iotaHashCallback callback, void *arg) {
+	struct iotaTxIndex &idx = _indexes[index];
+	uint32_t hashKey = iotaTxStoreKey(key);
+	char hash[NUM_HASH_TRYTES + 1];
+	unsigned int found = 0;
+
+	if (_count == 0) {
+		return 0;
+	}
+	hash[NUM_HASH_TRYTES] = '\0';
+	for (uint32_t slot = idx.buckets[hashKey & (idx.buckets.size() - 1)];
+			slot != IOTATXSTORE_NONE; slot = idx.next[slot]) {
+		if ((idx.keys[slot] != hashKey) || !matches(index, slot, key)) {
+			continue;
+		}
+		memcpy(hash, _records[slot].hash, NUM_HASH_TRYTES);
+		found++;
+		if (!callback(hash, arg)) {
+			break;
+		}
+	}
+	return found;
+}
+
+#ifdef __linux__
+
+IotaFileTxStore::IotaFileTxStore(const char *path, unsigned int maxCapacity)
+: IotaTxStore(NULL, 0), _path(path), _maxCapacity(maxCapacity), _fd(-1),
+		_map(NULL), _mapLen(0) {
+}
+
+IotaFileTxStore::~IotaFileTxStore() {
+	unmap();
+	if (_fd >= 0) {
+		close(_fd);
+	}
+}
+
+bool IotaFileTxStore::begin() {
+	uint32_t hdr[IOTATXSTORE_HDR_SIZE / 4];
+	struct stat st;
+	unsigned int capacity = IOTATXSTORE_FILE_CHUNK;
+
+	_fd = open(_path.c_str(), O_RDWR | O_CREAT, 0644);
+	if ((_fd < 0) || (fstat(_fd, &st) < 0)) {
+		DPRINTF("%s: cannot open %s\n", __FUNCTION__, _path.c_str());
+		return false;
+	}
+	if (st.st_size == 0) {
+		hdr[0] = IOTATXSTORE_MAGIC;
+		hdr[1] = sizeof(struct iotaStoredTx);
+		hdr[2] = 0;
+		hdr[3] = 0;
+		if (pwrite(_fd, hdr, sizeof(hdr), 0) != sizeof(hdr)) {
+			return false;
+		}
+		if (_maxCapacity && (capacity > _maxCapacity)) {
+			capacity = _maxCapacity;
+		}
+		return map(capacity) && setRecords(_records, capacity, 0);
+	}
+	if ((st.st_size < IOTATXSTORE_HDR_SIZE) ||
+			(pread(_fd, hdr, sizeof(hdr), 0) != sizeof(hdr)) ||
+			(hdr[0] != IOTATXSTORE_MAGIC) ||
+			(hdr[1] != sizeof(struct iotaStoredTx))) {
+		DPRINTF("%s: invalid log file\n", __FUNCTION__);
+		return false;
+	}
+	capacity = (st.st_size - IOTATXSTORE_HDR_SIZE) /
+			sizeof(struct iotaStoredTx);
+	if (hdr[2] > capacity) {
+		hdr[2] = capacity;
+	}
+	DPRINTF("%s: %u transactions in %s\n", __FUNCTION__, hdr[2],
+			_path.c_str());
+	return map(capacity) && setRecords(_records, capacity, hdr[2], hdr[3]);
+}
+
+bool IotaFileTxStore::sync() {
+	return (_map && (msync(_map, _mapLen, MS_SYNC) == 0));
+}
+
+void IotaFileTxStore::clear() {
+	IotaTxStore::clear();
+	commit();
+}
+
+bool IotaFileTxStore::grow() {
+	if (!_map) {
+		return false;
+	}
+
+	unsigned int capacity = 2 * _capacity;
+
+	/* Grow by at least the initial log size, also for a header-only log. */
+	if (capacity < IOTATXSTORE_FILE_CHUNK) {
+		capacity = IOTATXSTORE_FILE_CHUNK;
+	}
+	if (_maxCapacity && (capacity > _maxCapacity)) {
+		capacity = _maxCapacity;
+	}
+	if (capacity <= _capacity) {
+		/* Replace the oldest transactions from now on. */
+		return false;
+	}
+	unmap();
+	if (!map(capacity)) {
+		/* Keep using the current log size. */
+		if (!map(_capacity)) {
+			setRecords(NULL, 0, 0);
+		}
+		return false;
+	}
+	return setRecords(_records, capacity, _count, _head);
+}
+
+void IotaFileTxStore::commit() {
+	uint32_t count = _count;
+	uint32_t head = _head;
+
+	if (_map) {
+		memcpy(_map + 8, &count, sizeof(count));
+		memcpy(_map + 12, &head, sizeof(head));
+	}
+}
+
+bool IotaFileTxStore::map(unsigned int capacity) {
+	size_t len = IOTATXSTORE_HDR_SIZE +
+			(size_t) capacity * sizeof(struct iotaStoredTx);
+	void *addr;
+
+	if (ftruncate(_fd, len) < 0) {
+		return false;
+	}
+	addr = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+	if (addr == MAP_FAILED) {
+		DPRINTF("%s: cannot map %u bytes\n", __FUNCTION__, (unsigned) len);
+		return false;
+	}
+	_map = (uint8_t *) addr;
+	_mapLen = len;
+	_records = (struct iotaStoredTx *) (_map + IOTATXSTORE_HDR_SIZE);
+	return true;
+}
+
+void IotaFileTxStore::unmap() {
+	if (_map) {
+		munmap(_map, _mapLen);
+		_map = NULL;
+		_mapLen = 0;
+		_records = NULL;
+	}
+}
+
+#endif
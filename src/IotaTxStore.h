@@ -0,0 +1,244 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _IOTA_TX_STORE_H_
+#define _IOTA_TX_STORE_H_
+
+#include <Arduino.h>
+#ifdef min
+#undef min
+#endif
+#ifdef max
+#undef max
+#endif
+#include <vector>
+
+#include "IotaClient.h"
+#include "IotaPackedTx.h"
+
+/* Default number of transactions kept by an in-memory store. */
+#ifndef IOTATXSTORE_CAPACITY
+#define IOTATXSTORE_CAPACITY	16
+#endif
+
+struct iotaStoredTx {
+	char hash[81];
+	uint8_t tx[IOTAPACKED_TX_BYTES];
+};
+
+class IotaTxStore {
+public:
+
+	/** Create an in-memory transaction store
+      Transactions are kept in packed format in a fixed-size ring: when the
+      store is full, the oldest transaction is replaced. Transactions are
+      indexed by hash, address and bundle hash.
+      @param capacity  Maximum number of transactions kept in the store
+      @return none
+	*/
+	IotaTxStore(unsigned int capacity = IOTATXSTORE_CAPACITY);
+
+	virtual ~IotaTxStore();
+
+	/** Retrieve number of transactions in the store
+      @return number of stored transactions
+	*/
+	unsigned int getCount();
+
+	/** Retrieve number of transactions that fit in the store without
+      replacing older transactions or (for stores that can grow) without
+      allocating more space
+      @return store capacity
+	*/
+	unsigned int getCapacity();
+
+	/** Add a transaction to the store
+      Transactions that are already in the store are not added again.
+      @param hash  Transaction hash (81 trytes)
+      @param trytes  Transaction trytes
+      @return true if the transaction is in the store, false if it is not a
+              valid transaction or could not be stored
+	*/
+	bool add(const String &hash, const String &trytes);
+
+	/** Add a packed transaction to the store
+      Transactions that are already in the store are not added again.
+      @param hash  Transaction hash (81 trytes)
+      @param tx  Packed transaction
+      @return true if the transaction is in the store, false if it could not be
+              stored
+	*/
+	bool add(const char *hash, const IotaPackedTx &tx);
+
+	/** Retrieve a transaction from the store
+      @param hash  Transaction hash (81 trytes)
+      @param tx  Packed transaction to be filled with transaction data
+      @return true if the transaction has been found, false otherwise
+	*/
+	bool get(const char *hash, IotaPackedTx &tx);
+
+	/** Retrieve transaction trytes from the store
+      @param hash  Transaction hash
+      @param trytes  String to be filled with transaction trytes
+      @return true if the transaction has been found, false otherwise
+	*/
+	bool getTrytes(const String &hash, String &trytes);
+
+	/** Find stored transactions with a given address
+      Transactions are reported starting from the most recently stored one.
+      @param addr  Address (81 trytes, checksum not required)
+      @param callback  Function called with the hash of each transaction
+             found
+      @param arg  Opaque argument passed to the callback function
+      @return number of transactions reported
+	*/
+	unsigned int findByAddress(const char *addr, iotaHashCallback callback,
+			void *arg);
+
+	/** Find stored transactions belonging to a bundle
+      Transactions are reported starting from the most recently stored one.
+      @param bundle  Bundle hash (81 trytes)
+      @param callback  Function called with the hash of each transaction
+             found
+      @param arg  Opaque argument passed to the callback function
+      @return number of transactions reported
+	*/
+	unsigned int findByBundle(const char *bundle, iotaHashCallback callback,
+			void *arg);
+
+	/** Remove all transactions from the store
+      @return none
+	*/
+	virtual void clear();
+
+protected:
+
+	/** Create a transaction store with external storage for records */
+	IotaTxStore(struct iotaStoredTx *records, unsigned int capacity);
+
+	/** Make room for more transactions
+      Stores that cannot grow return false, in which case the oldest
+      transaction is replaced.
+	*/
+	virtual bool grow();
+
+	/** Called after a transaction has been appended to the records */
+	virtual void commit();
+
+	/** Use external storage for transaction records, and rebuild the indexes
+      from the records already there; head is the slot of the oldest record,
+      which is only relevant when the records are full
+	*/
+	bool setRecords(struct iotaStoredTx *records, unsigned int capacity,
+			unsigned int count, unsigned int head = 0);
+
+	struct iotaStoredTx *_records;
+	unsigned int _capacity;
+	unsigned int _count;
+	unsigned int _head;
+
+private:
+	struct iotaTxIndex {
+		std::vector<uint32_t> buckets;
+		std::vector<uint32_t> next;
+		std::vector<uint32_t> keys;
+	};
+
+	enum {
+		IOTATXSTORE_BY_HASH,
+		IOTATXSTORE_BY_ADDR,
+		IOTATXSTORE_BY_BUNDLE,
+		IOTATXSTORE_INDEXES,
+	};
+
+	bool initIndexes();
+	void link(unsigned int index, uint32_t key, unsigned int slot);
+	void unlink(unsigned int index, unsigned int slot);
+	void indexRecord(unsigned int slot);
+	bool matches(unsigned int index, unsigned int slot, const char *key);
+	int lookup(const char *hash);
+	unsigned int find(unsigned int index, const char *key,
+			iotaHashCallback callback, void *arg);
+
+	bool _ownRecords;
+	struct iotaTxIndex _indexes[IOTATXSTORE_INDEXES];
+};
+
+#ifdef __linux__
+
+/** Transaction store backed by a memory-mapped file
+      The file is an append-only log of packed transactions, which grows as
+      needed up to an optional maximum capacity, beyond which the oldest
+      transaction is replaced; indexes are kept in memory and rebuilt when the
+      file is opened.
+*/
+class IotaFileTxStore : public IotaTxStore {
+public:
+
+	/** Create a file-backed transaction store
+      @param path  Path of the log file; it is created if it does not exist
+      @param maxCapacity  Number of transactions after which the log file stops
+             growing and the oldest transactions are replaced; if 0, the file
+             grows without limit. An existing file that is already larger is
+             not shrunk.
+      @return none
+	*/
+	IotaFileTxStore(const char *path, unsigned int maxCapacity = 0);
+
+	~IotaFileTxStore();
+
+	/** Open the log file and index its contents
+      @return true if the store is ready to be used, false otherwise
+	*/
+	bool begin();
+
+	/** Flush stored transactions to disk
+      @return true if data has been written, false otherwise
+	*/
+	bool sync();
+
+	/** Remove all transactions from the store and from the log file
+      @return none
+	*/
+	void clear();
+
+protected:
+	bool grow();
+	void commit();
+
+private:
+	bool map(unsigned int capacity);
+	void unmap();
+
+	String _path;
+	unsigned int _maxCapacity;
+	int _fd;
+	uint8_t *_map;
+	size_t _mapLen;
+};
+
+#endif
+
+#endif
@@ -26,6 +26,18 @@
 #include <time.h>
 
 #include "IotaWallet.h"
+#include "BasicIotaWallet.h"
+#include "IotaBalanceTracker.h"
+#include "IotaBundle.h"
+#include "IotaBundleBuilder.h"
+#include "IotaHeap.h"
+#include "IotaInputSelector.h"
+#include "IotaKerl.h"
+#include "IotaSpentLedger.h"
+#include "IotaTrace.h"
+#include "IotaTransferTracker.h"
+#include "IotaTrytes.h"
+#include "IotaWorkers.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -38,7 +50,7 @@ extern "C"
 #include "iota-c-library/src/iota/conversion.h"
 #include "iota-c-library/src/iota/transfers.h"
 
-#if !defined(ESP32) && !defined(ESP8266)
+#if !defined(ESP32) && !defined(ESP8266) && !defined(__linux__)
 
 /* Needed for the time(time_t *) function to work. */
 int _gettimeofday(struct timeval *__p, void *__tz)
@@ -58,7 +70,12 @@ int _gettimeofday(struct timeval *__p, void *__tz)
 }
 #endif
 
-#define IOTAWALLET_RANDOMWALK_DEPTH	10
+#define IOTAWALLET_TIPS_ATTEMPTS	3
+#define IOTAWALLET_SCAN_TRYTES		4
+
+/* Approximate size of the JSON fields of a request other than transaction
+ * trytes. */
+#define IOTAWALLET_REQ_OVERHEAD		256
 
 #ifdef IOTAWALLET_DEBUG
 #define DPRINTF	printf
@@ -66,15 +83,57 @@ int _gettimeofday(struct timeval *__p, void *__tz)
 #define DPRINTF(fmt, ...)	do {} while(0)
 #endif
 
-struct iotaWalletBundle {
-	iota_wallet_bundle_description_t descr;
-	char bundleHash[NUM_HASH_TRYTES];
-	iota_wallet_tx_output_t outTx;
-	BUNDLE_CTX bundle_ctx;
+struct iotaWalletDeriveCtx {
+	const unsigned char *seedBytes;
+	unsigned int security;
+	unsigned int startIdx;
+	char *addrChars;
+};
+
+static void iotaWalletDeriveWorker(void *arg, unsigned int idx) {
+	struct iotaWalletDeriveCtx *ctx = (struct iotaWalletDeriveCtx *) arg;
+	unsigned char addrBytes[NUM_HASH_BYTES];
+	char *addrChars = ctx->addrChars + idx * (NUM_HASH_TRYTES + 1);
+	IOTA_TRACE_SCOPE("address");
+
+	get_public_addr(ctx->seedBytes, ctx->startIdx + idx, ctx->security,
+			addrBytes);
+	bytes_to_chars(addrBytes, addrChars, NUM_HASH_BYTES);
+	addrChars[NUM_HASH_TRYTES] = '\0';
+}
+
+struct iotaWalletHistoryPage {
+	std::vector<String> *hashes;
+	unsigned int pageSize;
+	unsigned int skip;
+	unsigned int count;
+	bool more;
 };
 
-static std::vector<String> *iotaWalletTxPtr;
-static char *iotaWalletBundleHashPtr;
+static bool iotaWalletPageHash(const char *hash, void *arg) {
+	struct iotaWalletHistoryPage *page = (struct iotaWalletHistoryPage *) arg;
+
+	if (page->count++ < page->skip) {
+		return true;
+	}
+	if (page->hashes->size() == page->pageSize) {
+		page->more = true;
+		return false;
+	}
+	page->hashes->push_back(hash);
+	return true;
+}
+
+/* Bundle being built by iota_wallet_create_tx_bundle_mem(); per thread
+ * where wallets can be used from multiple threads. */
+#if defined(ESP32) || defined(__linux__)
+#define IOTAWALLET_THREAD_LOCAL	__thread
+#else
+#define IOTAWALLET_THREAD_LOCAL
+#endif
+
+static IOTAWALLET_THREAD_LOCAL std::vector<String> *iotaWalletTxPtr;
+static IOTAWALLET_THREAD_LOCAL char *iotaWalletBundleHashPtr;
 
 static int iotaWalletBundleHashReceiver(char *hash)
 {
@@ -112,17 +171,44 @@ static int iotaWalletTxReceiver(iota_wallet_tx_object_t *tx_object)
 
 IotaWallet::IotaWallet(IotaClient &iotaClient) : _iotaClient(iotaClient) {
 	_security = 2;
+	_depth = IOTAWALLET_RANDOMWALK_DEPTH;
 	_mwm = 14;
+	_storage = NULL;
+	_memoryLimit = 0;
 	_PoWClient = NULL;
+	_tracker = NULL;
+	_balanceTracker = NULL;
+	_inputSelector = NULL;
+	_ledger = NULL;
+	_seeded = false;
+	_signingWorkers = iotaWorkersDefault();
+	_checkConsistency = false;
+	_powTimePerTx = _powTimeSaved = 0;
+	_signTimePerFragment = _workerSignTimePerFragment = 0;
 	_firstUnspentAddr = _lastSpentAddr = -1;
 }
 
+IotaWallet::IotaWallet(IotaClient &iotaClient, unsigned int security,
+		unsigned int depth, struct iotaWalletStorage &storage) :
+		IotaWallet(iotaClient) {
+	_security = security;
+	_depth = depth;
+	_storage = &storage;
+}
+
 bool IotaWallet::begin(String seed) {
-	if (seed.length() != NUM_HASH_TRYTES) {
+	return begin(seed.c_str());
+}
+
+bool IotaWallet::begin(const char *seed) {
+	if ((strlen(seed) != NUM_HASH_TRYTES) ||
+			!iotaTrytesValidate(seed, NUM_HASH_TRYTES)) {
 		return false;
 	}
 	iota_wallet_init();
-	chars_to_bytes(seed.c_str(), _seedBytes, NUM_HASH_TRYTES);
+	chars_to_bytes(seed, _seedBytes, NUM_HASH_TRYTES);
+	_seeded = true;
+	bindLedger();
 	return true;
 }
 
@@ -134,7 +220,13 @@ bool IotaWallet::setSecurityLevel(unsigned int security) {
 	if (!in_range(security, MIN_SECURITY_LEVEL, MAX_SECURITY_LEVEL)) {
 		return false;
 	}
-	_security = security;
+	if (_storage) {
+		return (security == _security);
+	}
+	if (security != _security) {
+		_security = security;
+		bindLedger();
+	}
 	return true;
 }
 
@@ -150,18 +242,120 @@ void IotaWallet::setPoWClient(PoWClient &client) {
 	_PoWClient = &client;
 }
 
+void IotaWallet::setTransferTracker(IotaTransferTracker &tracker) {
+	_tracker = &tracker;
+}
+
+void IotaWallet::setBalanceTracker(IotaBalanceTracker &tracker) {
+	_balanceTracker = &tracker;
+}
+
+void IotaWallet::setInputSelector(IotaInputSelector &selector) {
+	_inputSelector = &selector;
+}
+
+void IotaWallet::setSpentLedger(IotaSpentLedger &ledger) {
+	_ledger = &ledger;
+	bindLedger();
+}
+
+void IotaWallet::bindLedger() {
+	char addr[NUM_HASH_TRYTES + 1];
+
+	/* Ledger contents recorded for a different seed or security level are
+	 * discarded. */
+	if (_ledger && _seeded) {
+		getAddressInto(0, addr, false);
+		_ledger->setFingerprint(addr);
+	}
+}
+
+void IotaWallet::setSigningWorkers(unsigned int workers) {
+	_signingWorkers = (workers ? workers : 1);
+}
+
+void IotaWallet::setConsistencyCheck(bool enable) {
+	_checkConsistency = enable;
+}
+
+unsigned long IotaWallet::getPoWTimeSaved() {
+	return _powTimeSaved;
+}
+
+void IotaWallet::setMemoryLimit(size_t bytes) {
+	_memoryLimit = bytes;
+}
+
+size_t IotaWallet::estimateTransferMemory(unsigned int numInputs,
+		bool withChange) {
+	unsigned int numTxs = 1 + numInputs * _security + (withChange ? 1 : 0);
+	size_t txBytes = numTxs * (sizeof(String) + NUM_TRANSACTION_TRYTES + 1);
+	size_t bundleBytes = 0;
+	size_t attachBytes;
+
+	/* Bundle creation: bundle descriptor (unless statically allocated) or
+	 * multi-worker signing context, plus the transaction trytes. */
+	if ((_signingWorkers > 1) && (numInputs > 1)) {
+		bundleBytes = sizeof(BUNDLE_CTX) +
+				numInputs * sizeof(iota_wallet_tx_input_t);
+	}
+	else if (!_storage) {
+		bundleBytes = sizeof(struct iotaWalletBundle) +
+				numInputs * sizeof(iota_wallet_tx_input_t) +
+				(withChange ? sizeof(iota_wallet_tx_output_t) : 0);
+	}
+	bundleBytes += txBytes;
+
+	/* Attachment: the transaction trytes, the JSON document holding them and,
+	 * while the response is parsed, the transactions with Proof of Work. */
+	attachBytes = 2 * txBytes + NUM_TRANSACTION_TRYTES * (numTxs + 1);
+	return ((bundleBytes > attachBytes) ? bundleBytes : attachBytes);
+}
+
 bool IotaWallet::getBalance(uint64_t *balance, unsigned int startAddrIdx,
 		unsigned int *nextAddrIdx) {
+	IOTA_NO_HEAP_SCOPE();
+	IOTA_HEAP_SCOPE(IOTA_HEAP_OP_SCAN);
+
 	return getAddrsWithBalance(NULL, 0, balance, 0, startAddrIdx, nextAddrIdx);
 }
 
 bool IotaWallet::getReceiveAddress(String &addr, bool withChecksum,
 		unsigned int startIdx, unsigned int *addrIdx) {
-	std::vector<String> addrs;
+	char buf[NUM_HASH_TRYTES + NUM_ADDR_CKSUM_TRYTES + 1];
+
+	if (!getReceiveAddress(buf, withChecksum, startIdx, addrIdx)) {
+		return false;
+	}
+	addr = buf;
+	return true;
+}
+
+bool IotaWallet::getReceiveAddress(char *addr, bool withChecksum,
+		unsigned int startIdx, unsigned int *addrIdx) {
+	IOTA_NO_HEAP_SCOPE();
+	IOTA_HEAP_SCOPE(IOTA_HEAP_OP_SCAN);
+
+	if (_storage) {
+		return scanReceiveAddress(*_storage->scanAddrs, _storage->scanSpent,
+				addr, withChecksum, startIdx, addrIdx);
+	}
+	else {
+		IotaHashArray<IOTAWALLET_ADDR_BATCH> addrs;
+		bool spent[IOTAWALLET_ADDR_BATCH];
+
+		return scanReceiveAddress(addrs, spent, addr, withChecksum, startIdx,
+				addrIdx);
+	}
+}
+
+bool IotaWallet::scanReceiveAddress(IotaHashList &addrs, bool *spent,
+		char *addr, bool withChecksum, unsigned int startIdx,
+		unsigned int *addrIdx) {
 	int idx;
 
 	if ((startIdx == (unsigned int)-1) && (_firstUnspentAddr >= 0)) {
-		addr = getAddress(_firstUnspentAddr, withChecksum);
+		getAddressInto(_firstUnspentAddr, addr, withChecksum);
 		if (addrIdx) {
 			*addrIdx = _firstUnspentAddr;
 		}
@@ -170,29 +364,29 @@ bool IotaWallet::getReceiveAddress(String &addr, bool withChecksum,
 	idx = ((startIdx != (unsigned int)-1) ? startIdx : (_lastSpentAddr + 1));
 	while (true) {
 		addrs.clear();
-		for (int i = 0; i < 8; i++) {
-			addrs.push_back(getAddress(idx, false));
+		while (addrs.size() < addrs.capacity()) {
+			getAddressInto(idx, addrs.append(), false);
 			idx++;
 		}
-		std::vector<bool> spent;
-		if (!_iotaClient.wereAddressesSpentFrom(addrs, spent)) {
-			DPRINTF("%s: couldn't get spent addresses\n", __FUNCTION__);
+		if (!getSpentStates(addrs, idx - addrs.size(), spent)) {
 			return false;
 		}
-		for (int i = 0; i < spent.size(); i++) {
+		for (unsigned int i = 0; i < addrs.size(); i++) {
 			if (!spent[i]) {
+				memcpy(addr, addrs[i], NUM_HASH_TRYTES);
 				if (withChecksum) {
-					unsigned char addrBytes[NUM_HASH_BYTES];
-					char fullAddr[NUM_HASH_TRYTES + NUM_ADDR_CKSUM_TRYTES + 1];
-
-					chars_to_bytes(addrs[i].c_str(), addrBytes,
-							NUM_HASH_TRYTES);
-					get_address_with_checksum(addrBytes, fullAddr);
-					fullAddr[NUM_HASH_TRYTES + NUM_ADDR_CKSUM_TRYTES] = '\0';
-					addr = String(fullAddr);
+					char hash[NUM_HASH_TRYTES];
+
+					/* The checksum is the tail of the Kerl hash of the
+					 * address. */
+					iotaKerlHash(addr, NUM_HASH_TRYTES, hash);
+					memcpy(addr + NUM_HASH_TRYTES,
+							hash + NUM_HASH_TRYTES - NUM_ADDR_CKSUM_TRYTES,
+							NUM_ADDR_CKSUM_TRYTES);
+					addr[NUM_HASH_TRYTES + NUM_ADDR_CKSUM_TRYTES] = '\0';
 				}
 				else {
-					addr = addrs[i];
+					addr[NUM_HASH_TRYTES] = '\0';
 				}
 				if (addrIdx) {
 					*addrIdx = idx - addrs.size() + i;
@@ -210,211 +404,490 @@ bool IotaWallet::getReceiveAddress(String &addr, bool withChecksum,
 }
 
 bool IotaWallet::attachAddress(String addr) {
+	return attachAddress(addr.c_str());
+}
+
+bool IotaWallet::attachAddress(const char *addr) {
+	IOTA_HEAP_SCOPE(IOTA_HEAP_OP_ATTACH);
+	IOTA_TRACE_SCOPE("attachAddress");
 	String trunk, branch;
-	struct iotaWalletBundle *bundle;
 	std::vector<String> txs;
 
-	if (!_iotaClient.getTransactionsToApprove(IOTAWALLET_RANDOMWALK_DEPTH,
-			trunk, branch)) {
+	if (getTips(trunk, branch, 1) != IOTA_OK) {
 		return false;
 	}
-	bundle = (struct iotaWalletBundle *) allocBundle(0, false);
-	if (!bundle) {
-		DPRINTF("%s: couldn't allocate memory for bundle\n", __FUNCTION__);
+	if (!createZeroValueTx(addr, txs) || !doPoW(trunk, branch, txs)) {
 		return false;
 	}
-	memcpy(bundle->outTx.address, addr.c_str(), sizeof(bundle->outTx.address));
-	bundle->outTx.value = 0;
-	bundle->descr.timestamp = time(NULL);
-	iotaWalletBundleHashPtr = bundle->bundleHash;
-	iotaWalletTxPtr = &txs;
-	iota_wallet_create_tx_bundle_mem(iotaWalletBundleHashReceiver,
-			iotaWalletTxReceiver, &bundle->descr, &bundle->bundle_ctx, yield);
-	freeBundle(bundle);
-	if (_PoWClient) {
-		DPRINTF("%s: using external PoW client\n", __FUNCTION__);
-		if (!_PoWClient->pow(trunk, branch, _mwm, txs)) {
-			return false;
-		}
+	return (_iotaClient.storeTransactions(txs) &&
+			_iotaClient.broadcastTransactions(txs));
+}
+
+bool IotaWallet::promoteTransaction(String &tailHash) {
+	char addr[NUM_HASH_TRYTES];
+	String trunk, branch;
+	std::vector<String> txs;
+
+	/* The promoting transaction approves the promoted transaction and the
+	 * trunk tip; the branch tip is not used. */
+	if (getTips(trunk, branch, 1, &tailHash) != IOTA_OK) {
+		return false;
 	}
-	else {
-		if (!_iotaClient.attachToTangle(trunk, branch, _mwm, txs)) {
-			return false;
-		}
+	memset(addr, '9', sizeof(addr));
+	if (!createZeroValueTx(addr, txs) || !doPoW(tailHash, trunk, txs)) {
+		DPRINTF("%s: couldn't attach promoting transaction\n", __FUNCTION__);
+		return false;
+	}
+	return (_iotaClient.storeTransactions(txs) &&
+			_iotaClient.broadcastTransactions(txs));
+}
+
+bool IotaWallet::isPromotable(String &tailHash, bool &promotable) {
+	std::vector<String> tails;
+
+	tails.push_back(tailHash);
+	if (!_iotaClient.checkConsistency(tails, promotable)) {
+		return false;
+	}
+	if (!promotable) {
+		DPRINTF("%s: transaction %s is not consistent\n", __FUNCTION__,
+				tailHash.c_str());
+		_powTimeSaved += _powTimePerTx;
+	}
+	return true;
+}
+
+bool IotaWallet::reattachBundle(std::vector<String> &txs) {
+	String trunk, branch;
+
+	if (getTips(trunk, branch, txs.size()) != IOTA_OK) {
+		return false;
+	}
+	if (!doPoW(trunk, branch, txs)) {
+		DPRINTF("%s: couldn't reattach bundle\n", __FUNCTION__);
+		return false;
 	}
 	return (_iotaClient.storeTransactions(txs) &&
 			_iotaClient.broadcastTransactions(txs));
 }
 
 bool IotaWallet::addrVerifyCksum(String addr) {
-	if (addr.length() != NUM_HASH_TRYTES + NUM_ADDR_CKSUM_TRYTES) {
+	return addrVerifyCksum(addr.c_str());
+}
+
+bool IotaWallet::addrVerifyCksum(const char *addr) {
+	char hash[NUM_HASH_TRYTES];
+
+	if ((strlen(addr) != NUM_HASH_TRYTES + NUM_ADDR_CKSUM_TRYTES) ||
+			!iotaTrytesValidate(addr, NUM_HASH_TRYTES + NUM_ADDR_CKSUM_TRYTES)) {
 		return false;
 	}
-	return (address_verify_checksum(addr.c_str()) == 0);
+
+	/* The checksum is the tail of the Kerl hash of the address. */
+	iotaKerlHash(addr, NUM_HASH_TRYTES, hash);
+	return !memcmp(hash + NUM_HASH_TRYTES - NUM_ADDR_CKSUM_TRYTES,
+			addr + NUM_HASH_TRYTES, NUM_ADDR_CKSUM_TRYTES);
+}
+
+int IotaWallet::sendTransfer(uint64_t value, const char *recipient,
+		const char *tag, unsigned int inputStartIdx, unsigned int *inputAddrIdx,
+		unsigned int changeStartIdx, unsigned int *changeAddrIdx) {
+	return sendTransfer(value, String(recipient), String(tag), inputStartIdx,
+			inputAddrIdx, changeStartIdx, changeAddrIdx);
 }
 
 int IotaWallet::sendTransfer(uint64_t value, String recipient, String tag,
 		unsigned int inputStartIdx, unsigned int *inputAddrIdx,
 		unsigned int changeStartIdx, unsigned int *changeAddrIdx) {
+	IOTA_HEAP_SCOPE(IOTA_HEAP_OP_TRANSFER);
+	IOTA_TRACE_SCOPE("sendTransfer");
 	std::vector<struct iotaAddrWithBalance> inputAddrs;
-	uint64_t availableBalance;
+	String changeAddr;
+	uint64_t changeValue;
+	unsigned int changeIdx;
 	struct iotaWalletBundle *bundle;
-	String trunk, branch;
 	std::vector<String> txList;
-	int ret = IOTA_OK;
+	unsigned long signStartTime;
+	int ret;
+
+	ret = planTransfer(value, recipient, tag, inputStartIdx, inputAddrIdx,
+			changeStartIdx, &changeIdx, inputAddrs, changeAddr, &changeValue);
+	if (ret != IOTA_OK) {
+		return ret;
+	}
+	if (changeAddrIdx && changeValue) {
+		*changeAddrIdx = changeIdx;
+	}
+	if (_memoryLimit && (estimateTransferMemory(inputAddrs.size(),
+			changeValue != 0) > _memoryLimit)) {
+		DPRINTF("%s: transfer exceeds memory limit\n", __FUNCTION__);
+		return IOTA_ERR_NO_MEM;
+	}
+	bundle = (struct iotaWalletBundle *) allocBundle(inputAddrs.size(),
+			changeValue != 0);
+	if (!bundle) {
+		DPRINTF("%s: couldn't allocate memory for bundle\n", __FUNCTION__);
+		return IOTA_ERR_NO_MEM;
+	}
+	memcpy(bundle->descr.output_txs[0].address, recipient.c_str(),
+			sizeof(bundle->descr.output_txs[0].address));
+	bundle->descr.output_txs[0].value = (int64_t)value;
+	memcpy(bundle->descr.output_txs[0].tag, tag.c_str(), tag.length());
+	for (int i = 0; i < inputAddrs.size(); i++) {
+		String addr = getAddress(inputAddrs[i].addrIdx, false);
+
+		memcpy(bundle->descr.input_txs[i].address, addr.c_str(),
+				sizeof(bundle->descr.input_txs[i].address));
+		bundle->descr.input_txs[i].key_index = inputAddrs[i].addrIdx;
+		bundle->descr.input_txs[i].value = inputAddrs[i].balance;
+		DPRINTF("%s: input %d: key index %d, address %s, value %llu\n",
+				__FUNCTION__, i, bundle->descr.input_txs[i].key_index,
+				addr.c_str(), bundle->descr.input_txs[i].value);
+	}
+	if (changeValue != 0) {
+		memcpy(bundle->descr.change_tx->address, changeAddr.c_str(),
+				sizeof(bundle->descr.change_tx->address));
+		bundle->descr.change_tx->value = (int64_t)changeValue;
+		memcpy(bundle->descr.change_tx->tag, tag.c_str(), tag.length());
+	}
+	bundle->descr.timestamp = time(NULL);
+	DPRINTF("%s: creating bundle with %d output transaction(s), %d input "
+			"transaction(s) and %s change transaction\n", __FUNCTION__,
+			bundle->descr.output_txs_length, bundle->descr.input_txs_length,
+			bundle->descr.change_tx ? "1" : "no");
+	signStartTime = micros();
+	IOTA_TRACE_BEGIN("sign");
+	if ((_signingWorkers > 1) && (bundle->descr.input_txs_length > 1)) {
+		IotaBundle signedBundle(_seedBytes, _security);
+
+		if (!signedBundle.create(&bundle->descr)) {
+			DPRINTF("%s: couldn't create bundle\n", __FUNCTION__);
+			IOTA_TRACE_END("sign");
+			freeBundle(bundle);
+			return IOTA_ERR_NO_MEM;
+		}
+		DPRINTF("%s: signing %d inputs with %u workers\n", __FUNCTION__,
+				signedBundle.getNumInputs(), _signingWorkers);
+		signedBundle.signInputs(_signingWorkers);
+		signedBundle.getTransactions(txList);
+	}
+	else {
+		iotaWalletBundleHashPtr = bundle->bundleHash;
+		iotaWalletTxPtr = &txList;
+		iota_wallet_create_tx_bundle_mem(iotaWalletBundleHashReceiver,
+				iotaWalletTxReceiver, &bundle->descr, &bundle->bundle_ctx,
+				yield);
+	}
+	IOTA_TRACE_END("sign");
+	if (inputAddrs.size() != 0) {
+		unsigned long signTime = micros() - signStartTime;
+		unsigned long *avg = &_signTimePerFragment;
+
+		/* Keep moving averages of the signing time per fragment: with
+		 * multiple workers, the time is that of the fragments signed in
+		 * sequence by each worker, and is kept apart from the single-thread
+		 * time measured by calibrateSigning(). */
+		if ((_signingWorkers > 1) && (inputAddrs.size() > 1)) {
+			avg = &_workerSignTimePerFragment;
+		}
+		signTime /= signRounds(inputAddrs.size()) * _security;
+		*avg = (*avg ? ((3 * *avg + signTime) / 4) : signTime);
+	}
+	freeBundle(bundle);
+	return attachTransfer(txList, inputAddrs, inputAddrIdx == NULL,
+			changeValue ? changeIdx : -1);
+}
+
+int IotaWallet::prepareTransfer(IotaBundleBuilder &builder, uint64_t value,
+		String recipient, String tag, unsigned int inputStartIdx,
+		unsigned int *inputAddrIdx, unsigned int changeStartIdx,
+		unsigned int *changeAddrIdx) {
+	IOTA_HEAP_SCOPE(IOTA_HEAP_OP_TRANSFER);
+	std::vector<struct iotaAddrWithBalance> inputAddrs;
+	String changeAddr;
+	uint64_t changeValue;
+	unsigned int changeIdx;
+	int ret;
+
+	ret = planTransfer(value, recipient, tag, inputStartIdx, inputAddrIdx,
+			changeStartIdx, &changeIdx, inputAddrs, changeAddr, &changeValue);
+	if (ret != IOTA_OK) {
+		return ret;
+	}
+	if (changeAddrIdx && changeValue) {
+		*changeAddrIdx = changeIdx;
+	}
+	if (_memoryLimit && (estimateTransferMemory(inputAddrs.size(),
+			changeValue != 0) > _memoryLimit)) {
+		DPRINTF("%s: transfer exceeds memory limit\n", __FUNCTION__);
+		return IOTA_ERR_NO_MEM;
+	}
+	if (!builder.begin(_seedBytes, _security, value, recipient.c_str(),
+			tag.c_str(), inputAddrs,
+			(changeValue != 0) ? changeAddr.c_str() : NULL, changeValue)) {
+		return IOTA_ERR_NO_MEM;
+	}
+	builder._updateSpentAddr = (inputAddrIdx == NULL);
+	builder._changeAddrIdx = (changeValue ? changeIdx : -1);
+	return IOTA_OK;
+}
+
+int IotaWallet::estimateTransfer(struct iotaTransferEstimate &estimate,
+		uint64_t value, String recipient, String tag,
+		unsigned int inputStartIdx, unsigned int changeStartIdx) {
+	String changeAddr;
+	unsigned int changeIdx;
+	int ret;
+
+	estimate.inputs.clear();
+	ret = planTransfer(value, recipient, tag, inputStartIdx, NULL,
+			changeStartIdx, &changeIdx, estimate.inputs, changeAddr,
+			&estimate.changeValue);
+	if (ret != IOTA_OK) {
+		return ret;
+	}
+	estimate.changeAddrIdx = (estimate.changeValue ? (int)changeIdx : -1);
+	estimate.numSigFragments = estimate.inputs.size() * _security;
+	estimate.numTxs = 1 + estimate.numSigFragments +
+			(estimate.changeValue ? 1 : 0);
+
+	/* Transactions are uploaded for storage and broadcast and, unless Proof
+	 * of Work is done by a PoW client, for Proof of Work. */
+	estimate.uploadBytes = (_PoWClient ? 2 : 3) *
+			(estimate.numTxs * (NUM_TRANSACTION_TRYTES + 3) +
+			IOTAWALLET_REQ_OVERHEAD);
+	estimate.memoryBytes = estimateTransferMemory(estimate.inputs.size(),
+			estimate.changeValue != 0);
+	if ((_signingWorkers > 1) && (estimate.inputs.size() > 1)) {
+		unsigned long timePerFragment = _workerSignTimePerFragment;
+
+		/* Until a transfer has been signed with workers, assume that they
+		 * sign as fast as a single thread. */
+		if (!timePerFragment) {
+			timePerFragment = _signTimePerFragment;
+		}
+		estimate.signTime = signRounds(estimate.inputs.size()) * _security *
+				timePerFragment / 1000;
+	}
+	else {
+		estimate.signTime = estimate.numSigFragments * _signTimePerFragment /
+				1000;
+	}
+	estimate.powTime = estimate.numTxs * _powTimePerTx;
+	return IOTA_OK;
+}
+
+unsigned long IotaWallet::calibrateSigning() {
+	unsigned char sigBytes[SIGNATURE_FRAGMENT_SZ * NUM_HASH_BYTES];
+	tryte_t normalizedHash[NUM_HASH_TRYTES];
+	SIGNING_CTX ctx;
+	unsigned long startTime = micros();
+
+	/* Sign a dummy hash with the first address, as a transfer would do for
+	 * each input. */
+	memset(normalizedHash, 0, sizeof(normalizedHash));
+	signing_initialize(&ctx, _seedBytes, 0, _security, normalizedHash);
+	while (signing_has_next_fragment(&ctx)) {
+		signing_next_fragment(&ctx, sigBytes);
+		yield();
+	}
+	_signTimePerFragment = (micros() - startTime) / _security;
+	return _signTimePerFragment;
+}
+
+void IotaWallet::getTimings(unsigned long &signTimePerFragment,
+		unsigned long &powTimePerTx) {
+	signTimePerFragment = _signTimePerFragment;
+	powTimePerTx = _powTimePerTx;
+}
+
+void IotaWallet::setTimings(unsigned long signTimePerFragment,
+		unsigned long powTimePerTx) {
+	_signTimePerFragment = signTimePerFragment;
+	_powTimePerTx = powTimePerTx;
+}
+
+int IotaWallet::completeTransfer(IotaBundleBuilder &builder) {
+	IOTA_HEAP_SCOPE(IOTA_HEAP_OP_TRANSFER);
+	std::vector<String> txList;
+
+	if (!builder.getTransactions(txList)) {
+		return IOTA_ERR_NOT_READY;
+	}
+	return attachTransfer(txList, builder._inputs, builder._updateSpentAddr,
+			builder._changeAddrIdx);
+}
+
+int IotaWallet::planTransfer(uint64_t value, String &recipient, String &tag,
+		unsigned int inputStartIdx, unsigned int *inputAddrIdx,
+		unsigned int changeStartIdx, unsigned int *changeAddrIdx,
+		std::vector<struct iotaAddrWithBalance> &inputAddrs,
+		String &changeAddr, uint64_t *changeValue) {
+	uint64_t availableBalance = 0;
+	unsigned int maxInputs = inputLimit();
+	int ret;
 
+	*changeValue = 0;
 	if (!addrVerifyCksum(recipient)) {
 		return IOTA_ERR_INV_ADDR;
 	}
 	if ((tag.length() > NUM_TAG_TRYTES) ||
-			(tryte_chars_validate(tag.c_str(), tag.length()) < 0)) {
+			!iotaTrytesValidate(tag.c_str(), tag.length())) {
 		return IOTA_ERR_INV_TAG;
 	}
-	if (value != 0) {
-		if (!getAddrsWithBalance(&inputAddrs,
-				(MAX_BUNDLE_INDEX_SZ - 2) / _security,
-				&availableBalance, value, inputStartIdx, inputAddrIdx)) {
+	if (value == 0) {
+		return IOTA_OK;
+	}
+
+	/* Check the memory limit before any network communication, and don't
+	 * look for more inputs than fit in it. */
+	if (_memoryLimit) {
+		while ((maxInputs > 0) &&
+				(estimateTransferMemory(maxInputs, false) > _memoryLimit)) {
+			maxInputs--;
+		}
+		if (maxInputs == 0) {
+			DPRINTF("%s: transfer exceeds memory limit\n", __FUNCTION__);
+			return IOTA_ERR_NO_MEM;
+		}
+	}
+	if (_inputSelector) {
+		ret = selectInputs(value, maxInputs, inputStartIdx, inputAddrIdx,
+				inputAddrs, &availableBalance);
+		if ((ret == IOTA_ERR_FRAGM_BALANCE) && (maxInputs < inputLimit())) {
+			return IOTA_ERR_NO_MEM;
+		}
+		if (ret != IOTA_OK) {
+			return ret;
+		}
+		DPRINTF("%s: selected %d input address(es), with total balance "
+				"%llu\n", __FUNCTION__, inputAddrs.size(), availableBalance);
+	}
+	else {
+		if (!getAddrsWithBalance(&inputAddrs, maxInputs, &availableBalance,
+				value, inputStartIdx, inputAddrIdx)) {
 			DPRINTF("%s: couldn't get addresses with balance\n", __FUNCTION__);
 			return IOTA_ERR_NETWORK;
 		}
 		DPRINTF("%s: found %d input address(es), with total balance %llu\n",
 				__FUNCTION__, inputAddrs.size(), availableBalance);
 		if (availableBalance < value) {
-			if (inputAddrs.size() == (MAX_BUNDLE_INDEX_SZ - 2) / _security) {
-				return IOTA_ERR_FRAGM_BALANCE;
+			if (inputAddrs.size() == maxInputs) {
+				return ((maxInputs < inputLimit()) ? IOTA_ERR_NO_MEM :
+						IOTA_ERR_FRAGM_BALANCE);
 			}
 			else {
 				return IOTA_ERR_INSUFF_BALANCE;
 			}
 		}
 	}
-	bundle = (struct iotaWalletBundle *) allocBundle(inputAddrs.size(),
-			(value != 0) && (availableBalance > value));
-	if (!bundle) {
-		DPRINTF("%s: couldn't allocate memory for bundle\n", __FUNCTION__);
-		return IOTA_ERR_NO_MEM;
-	}
-	memcpy(bundle->descr.output_txs[0].address, recipient.c_str(),
-			sizeof(bundle->descr.output_txs[0].address));
-	bundle->descr.output_txs[0].value = (int64_t)value;
-	memcpy(bundle->descr.output_txs[0].tag, tag.c_str(), tag.length());
-	if (value != 0) {
-		for (int i = 0; i < inputAddrs.size(); i++) {
-			String addr = getAddress(inputAddrs[i].addrIdx, false);
-
-			memcpy(bundle->descr.input_txs[i].address, addr.c_str(),
-					sizeof(bundle->descr.input_txs[i].address));
-			bundle->descr.input_txs[i].key_index = inputAddrs[i].addrIdx;
-			bundle->descr.input_txs[i].value = inputAddrs[i].balance;
-			DPRINTF("%s: input %d: key index %d, address %s, value %llu\n",
-					__FUNCTION__, i, bundle->descr.input_txs[i].key_index,
-					addr.c_str(), bundle->descr.input_txs[i].value);
-		}
-		availableBalance -= value;
-
-		if (availableBalance != 0) {
-			String changeAddr;
-			unsigned int idx;
-
-			while (true) {
-				if (!getReceiveAddress(changeAddr, false, changeStartIdx, &idx))
-				{
-					DPRINTF("%s: couldn't get change address\n", __FUNCTION__);
-					ret = IOTA_ERR_NETWORK;
-					goto exit;
-				}
-				for (int i = 0; i < inputAddrs.size(); i++) {
-					if (inputAddrs[i].addrIdx == idx) {
-						changeStartIdx = idx + 1;
-						break;
-					}
-				}
-				if (changeStartIdx == idx + 1) {
-					DPRINTF("%s: address index %u found in input list, "
-							"searching for another change address\n",
-							__FUNCTION__, idx);
-					continue;
-				}
-				else {
+	availableBalance -= value;
+	if (availableBalance != 0) {
+		unsigned int idx;
+
+		while (true) {
+			if (!getReceiveAddress(changeAddr, false, changeStartIdx, &idx)) {
+				DPRINTF("%s: couldn't get change address\n", __FUNCTION__);
+				return IOTA_ERR_NETWORK;
+			}
+			for (int i = 0; i < inputAddrs.size(); i++) {
+				if (inputAddrs[i].addrIdx == idx) {
+					changeStartIdx = idx + 1;
 					break;
 				}
 			}
-			if (changeAddrIdx != NULL) {
-				*changeAddrIdx = idx;
+			if (changeStartIdx == idx + 1) {
+				DPRINTF("%s: address index %u found in input list, "
+						"searching for another change address\n",
+						__FUNCTION__, idx);
+				continue;
+			}
+			else {
+				break;
 			}
-			memcpy(bundle->descr.change_tx->address, changeAddr.c_str(),
-					sizeof(bundle->descr.change_tx->address));
-			bundle->descr.change_tx->value = (int64_t)availableBalance;
-			memcpy(bundle->descr.change_tx->tag, tag.c_str(), tag.length());
-			DPRINTF("%s: change transaction: address %s, value %llu\n",
-					__FUNCTION__, changeAddr.c_str(),
-					bundle->descr.change_tx->value);
 		}
+		if (changeAddrIdx != NULL) {
+			*changeAddrIdx = idx;
+		}
+		*changeValue = availableBalance;
+		DPRINTF("%s: change transaction: address %s, value %llu\n",
+				__FUNCTION__, changeAddr.c_str(), availableBalance);
 	}
-	if (!_iotaClient.getTransactionsToApprove(IOTAWALLET_RANDOMWALK_DEPTH,
-			trunk, branch)) {
-		DPRINTF("%s: couldn't get transactions to approve\n", __FUNCTION__);
-		ret = IOTA_ERR_NETWORK;
-		goto exit;
-	}
-	bundle->descr.timestamp = time(NULL);
-	iotaWalletBundleHashPtr = bundle->bundleHash;
+	return IOTA_OK;
+}
 
-	iotaWalletTxPtr = &txList;
-	DPRINTF("%s: creating bundle with %d output transaction(s), %d input "
-			"transaction(s) and %s change transaction\n", __FUNCTION__,
-			bundle->descr.output_txs_length, bundle->descr.input_txs_length,
-			bundle->descr.change_tx ? "1" : "no");
-	iota_wallet_create_tx_bundle_mem(iotaWalletBundleHashReceiver,
-			iotaWalletTxReceiver, &bundle->descr, &bundle->bundle_ctx, yield);
-	freeBundle(bundle);
-	if (_PoWClient) {
-		DPRINTF("%s: using external PoW client\n", __FUNCTION__);
-		if (!_PoWClient->pow(trunk, branch, _mwm, txList)) {
-			return IOTA_ERR_POW;
-		}
+int IotaWallet::attachTransfer(std::vector<String> &txList,
+		std::vector<struct iotaAddrWithBalance> &inputAddrs,
+		bool updateSpentAddr, unsigned int changeAddrIdx) {
+	IOTA_HEAP_SCOPE(IOTA_HEAP_OP_ATTACH);
+	IOTA_TRACE_SCOPE("attachTransfer");
+	String trunk, branch;
+	int ret;
+
+	ret = getTips(trunk, branch, txList.size());
+	if (ret != IOTA_OK) {
+		DPRINTF("%s: couldn't get transactions to approve\n", __FUNCTION__);
+		return ret;
 	}
-	else {
-		if (!_iotaClient.attachToTangle(trunk, branch, _mwm, txList)) {
-			DPRINTF("%s: couldn't attach to tangle\n", __FUNCTION__);
-			return IOTA_ERR_NETWORK;
-		}
+	if (!doPoW(trunk, branch, txList)) {
+		DPRINTF("%s: couldn't attach to tangle\n", __FUNCTION__);
+		return (_PoWClient ? IOTA_ERR_POW : IOTA_ERR_NETWORK);
 	}
 	if (!_iotaClient.storeTransactions(txList)) {
 		DPRINTF("%s: couldn't store transactions\n", __FUNCTION__);
 		return IOTA_ERR_NETWORK;
 	}
-	if (value != 0) {
+	if (inputAddrs.size() != 0) {
 		_firstUnspentAddr = -1;
-		if (inputAddrIdx == NULL) {
+		if (updateSpentAddr) {
 			_lastSpentAddr = inputAddrs[inputAddrs.size() - 1].addrIdx;
 		}
+		if (_ledger) {
+			for (auto it = inputAddrs.cbegin(); it != inputAddrs.cend(); it++) {
+				String addr;
+
+				/* The address is needed only if not tracked by index. */
+				if (it->addrIdx >= _ledger->getMaxIndex()) {
+					addr = getAddress(it->addrIdx, false);
+				}
+				_ledger->markSpent(it->addrIdx, addr.c_str());
+			}
+			_ledger->save();
+		}
 	}
-	return (_iotaClient.broadcastTransactions(txList) ? IOTA_OK :
-			IOTA_ERR_NETWORK);
-exit:
-	freeBundle(bundle);
-	return ret;
+	if (!_iotaClient.broadcastTransactions(txList)) {
+		return IOTA_ERR_NETWORK;
+	}
+	if (_tracker) {
+		_tracker->addTransfer(txList);
+	}
+	if (_balanceTracker) {
+		_balanceTracker->addTransfer(inputAddrs, changeAddrIdx);
+	}
+	return IOTA_OK;
 }
 
 String IotaWallet::getAddress(unsigned int index, bool withChecksum) {
+	char addr[NUM_HASH_TRYTES + NUM_ADDR_CKSUM_TRYTES + 1];
+
+	getAddressInto(index, addr, withChecksum);
+	return String(addr);
+}
+
+void IotaWallet::getAddressInto(unsigned int index, char *addr,
+		bool withChecksum) {
+	IOTA_TRACE_SCOPE("address");
 	unsigned char addrBytes[NUM_HASH_BYTES];
 
 	get_public_addr(_seedBytes, index, _security, addrBytes);
 	yield();
 	if (withChecksum) {
-		char fullAddr[NUM_HASH_TRYTES + NUM_ADDR_CKSUM_TRYTES + 1];
-
-		get_address_with_checksum(addrBytes, fullAddr);
-		fullAddr[NUM_HASH_TRYTES + NUM_ADDR_CKSUM_TRYTES] = '\0';
-		return String(fullAddr);
+		get_address_with_checksum(addrBytes, addr);
+		addr[NUM_HASH_TRYTES + NUM_ADDR_CKSUM_TRYTES] = '\0';
 	}
 	else {
-		char addrChars[NUM_HASH_TRYTES + 1];
-
-		bytes_to_chars(addrBytes, addrChars, NUM_HASH_BYTES);
-		addrChars[NUM_HASH_TRYTES] = '\0';
-		return String(addrChars);
+		bytes_to_chars(addrBytes, addr, NUM_HASH_BYTES);
+		addr[NUM_HASH_TRYTES] = '\0';
 	}
 }
 
@@ -422,7 +895,28 @@ bool IotaWallet::getAddrsWithBalance(
 		std::vector<struct iotaAddrWithBalance> *list, int listMaxSize,
 		uint64_t *totalBalance, uint64_t neededBalance,
 		unsigned int startAddrIdx, unsigned int *nextAddrIdx) {
-	std::vector<String> addrs;
+	IOTA_HEAP_SCOPE(IOTA_HEAP_OP_SCAN);
+	IOTA_TRACE_SCOPE("getAddrsWithBalance");
+
+	if (_storage) {
+		return scanAddrsWithBalance(*_storage->scanAddrs,
+				_storage->scanBalances, _storage->scanSpent, list, listMaxSize,
+				totalBalance, neededBalance, startAddrIdx, nextAddrIdx);
+	}
+	else {
+		IotaHashArray<IOTAWALLET_ADDR_BATCH> addrs;
+		uint64_t balances[IOTAWALLET_ADDR_BATCH];
+		bool spent[IOTAWALLET_ADDR_BATCH];
+
+		return scanAddrsWithBalance(addrs, balances, spent, list, listMaxSize,
+				totalBalance, neededBalance, startAddrIdx, nextAddrIdx);
+	}
+}
+
+bool IotaWallet::scanAddrsWithBalance(IotaHashList &addrs, uint64_t *balances,
+		bool *spent, std::vector<struct iotaAddrWithBalance> *list,
+		int listMaxSize, uint64_t *totalBalance, uint64_t neededBalance,
+		unsigned int startAddrIdx, unsigned int *nextAddrIdx) {
 	unsigned int addrIdx = startAddrIdx;
 	uint64_t balance = 0;
 
@@ -431,17 +925,16 @@ bool IotaWallet::getAddrsWithBalance(
 	}
 	while (true) {
 		addrs.clear();
-		for (int i = 0; i < 8; i++) {
-			addrs.push_back(getAddress(addrIdx, false));
+		while (addrs.size() < addrs.capacity()) {
+			getAddressInto(addrIdx, addrs.append(), false);
 			addrIdx++;
 		}
-		std::vector<uint64_t> balances;
 		if (!_iotaClient.getBalances(addrs, balances)) {
 			DPRINTF("%s: couldn't get balances\n", __FUNCTION__);
 			return false;
 		}
 		unsigned long partialBalance = 0;
-		for (int i = 0; i < balances.size(); i++) {
+		for (unsigned int i = 0; i < addrs.size(); i++) {
 			if (balances[i] != 0) {
 				partialBalance += balances[i];
 				if (list &&
@@ -455,7 +948,7 @@ bool IotaWallet::getAddrsWithBalance(
 				if ((neededBalance != 0) &&
 						(balance + partialBalance >= neededBalance)) {
 					balance += partialBalance;
-					addrIdx -= balances.size() - 1 - i;
+					addrIdx -= addrs.size() - 1 - i;
 					goto done;
 				}
 			}
@@ -464,14 +957,12 @@ bool IotaWallet::getAddrsWithBalance(
 			balance += partialBalance;
 			continue;
 		}
-		std::vector<bool> spent;
-		if (!_iotaClient.wereAddressesSpentFrom(addrs, spent)) {
-			DPRINTF("%s: couldn't get spent addresses\n", __FUNCTION__);
+		if (!getSpentStates(addrs, addrIdx - addrs.size(), spent)) {
 			return false;
 		}
 		bool spentAny = false;
-		for (auto it = spent.cbegin(); it != spent.cend(); it++) {
-			spentAny |= *it;
+		for (unsigned int i = 0; i < addrs.size(); i++) {
+			spentAny |= spent[i];
 		}
 		if (spentAny) {
 			continue;
@@ -491,59 +982,491 @@ done:
 }
 
 bool IotaWallet::findAddresses(std::vector<String> &addrs) {
-	unsigned char addrBytes[NUM_HASH_BYTES];
-	char addrChars[NUM_HASH_TRYTES + 1];
-	unsigned int addrIndex;
+	IOTA_TRACE_SCOPE("findAddresses");
 
 	addrs.clear();
-	addrChars[NUM_HASH_TRYTES] = '\0';
-	for (addrIndex = 0; ; addrIndex++) {
-		bool addrFound;
+	for (unsigned int addrIdx = 0; ; addrIdx++) {
+		std::vector<String> addresses;
+		std::vector<String> hashes;
 
-		get_public_addr(_seedBytes, addrIndex, _security, addrBytes);
-		yield();
-		bytes_to_chars(addrBytes, addrChars, NUM_HASH_BYTES);
-		if (!findAddress(addrChars, &addrFound)) {
+		addresses.push_back(getAddress(addrIdx, false));
+		if (!_iotaClient.findTransactions(hashes, std::vector<String>(),
+				addresses)) {
+			DPRINTF("%s: couldn't find transactions\n", __FUNCTION__);
 			return false;
 		}
-		if (!addrFound) {
+		if (hashes.empty()) {
 			break;
 		}
-		addrs.push_back(addrChars);
+		addrs.push_back(addresses[0]);
 	}
 	DPRINTF("%s: found %d address(es)\n", __FUNCTION__, addrs.size());
 	return true;
 }
 
-bool IotaWallet::findAddress(char *addr, bool *found) {
-	std::vector<String> addresses;
-	std::vector<String> bundles;
-	std::vector<String> txs;
+bool IotaWallet::findAddresses(std::vector<String> &addrs,
+		unsigned int gapLimit, unsigned int batchSize) {
+	IOTA_HEAP_SCOPE(IOTA_HEAP_OP_SCAN);
+	IOTA_TRACE_SCOPE("findAddresses");
+	std::vector<String> batch;
+	std::vector<bool> used;
+	unsigned int addrIdx = 0;
+	unsigned int gap = 0;
 
-	addresses.push_back(addr);
-	if (!_iotaClient.findTransactions(txs, bundles, addresses)) {
+	if (gapLimit == 0) {
+		gapLimit = 1;
+	}
+	if (batchSize == 0) {
+		batchSize = 1;
+	}
+	addrs.clear();
+	while (gap < gapLimit) {
+		deriveAddresses(addrIdx, batchSize, batch);
+		if (!findUsedAddresses(batch, addrIdx, used)) {
+			return false;
+		}
+		for (unsigned int i = 0; i < batch.size(); i++) {
+			if (used[i]) {
+				addrs.push_back(batch[i]);
+				gap = 0;
+			}
+			else if (++gap == gapLimit) {
+				break;
+			}
+		}
+		addrIdx += batchSize;
+	}
+	DPRINTF("%s: found %d address(es)\n", __FUNCTION__, addrs.size());
+	return true;
+}
+
+bool IotaWallet::getHistory(iotaHistoryCallback callback, void *arg,
+		unsigned int gapLimit, unsigned int pageSize) {
+	std::vector<String> batch;
+	std::vector<bool> used;
+	unsigned int addrIdx = 0;
+	unsigned int gap = 0;
+	bool stopped = false;
+
+	if (gapLimit == 0) {
+		gapLimit = 1;
+	}
+	if (pageSize == 0) {
+		pageSize = 1;
+	}
+	while (gap < gapLimit) {
+		deriveAddresses(addrIdx, IOTAWALLET_SCAN_BATCH, batch);
+		if (!getBatchHistory(batch, addrIdx, used, callback, arg, pageSize,
+				stopped)) {
+			return false;
+		}
+		if (stopped) {
+			break;
+		}
+		for (unsigned int i = 0; i < batch.size(); i++) {
+			if (used[i]) {
+				gap = 0;
+			}
+			else if (++gap == gapLimit) {
+				break;
+			}
+		}
+		addrIdx += batch.size();
+	}
+	return true;
+}
+
+bool IotaWallet::getBatchHistory(std::vector<String> &addrs,
+		unsigned int firstIdx, std::vector<bool> &used,
+		iotaHistoryCallback callback, void *arg, unsigned int pageSize,
+		bool &stopped) {
+	std::vector<String> hashes;
+	struct iotaWalletHistoryPage page;
+
+	used.assign(addrs.size(), false);
+	page.hashes = &hashes;
+	page.pageSize = pageSize;
+	page.skip = 0;
+	do {
+		hashes.clear();
+		page.count = 0;
+		page.more = false;
+		if (!_iotaClient.findTransactions(iotaWalletPageHash, &page,
+				std::vector<String>(), addrs)) {
+			DPRINTF("%s: couldn't find transactions\n", __FUNCTION__);
+			return false;
+		}
+		for (unsigned int i = 0; i < hashes.size(); ) {
+			std::vector<String> chunk;
+			std::vector<String> trytes;
+
+			for (; (i < hashes.size()) &&
+					(chunk.size() < IOTAWALLET_SCAN_TRYTES); i++) {
+				chunk.push_back(hashes[i]);
+			}
+			if (!_iotaClient.getTrytes(chunk, trytes)) {
+				DPRINTF("%s: couldn't get transaction trytes\n", __FUNCTION__);
+				return false;
+			}
+			for (unsigned int j = 0; j < trytes.size(); j++) {
+				struct iotaHistoryRecord record;
+				unsigned int k;
+
+				record.addr = trytes[j].substring(2187, 2268);
+				for (k = 0; k < addrs.size(); k++) {
+					if (addrs[k] == record.addr) {
+						break;
+					}
+				}
+				if (k == addrs.size()) {
+					continue;
+				}
+				used[k] = true;
+				record.addrIdx = firstIdx + k;
+				record.hash = chunk[j];
+				record.bundle = trytes[j].substring(2349, 2430);
+				record.value = iotaTrytesToInt64(trytes[j].c_str() + 2268, 27);
+				record.timestamp =
+						iotaTrytesToInt64(trytes[j].c_str() + 2322, 9);
+				if (!callback(record, arg)) {
+					stopped = true;
+					return true;
+				}
+			}
+		}
+		page.skip += hashes.size();
+	} while (page.more);
+	return true;
+}
+
+void IotaWallet::deriveAddresses(unsigned int startIdx, unsigned int count,
+		std::vector<String> &addrs) {
+	struct iotaWalletDeriveCtx ctx;
+
+	ctx.seedBytes = _seedBytes;
+	ctx.security = _security;
+	ctx.startIdx = startIdx;
+	ctx.addrChars = (char *) malloc(count * (NUM_HASH_TRYTES + 1));
+	addrs.clear();
+	if (!ctx.addrChars) {
+		for (unsigned int i = 0; i < count; i++) {
+			addrs.push_back(getAddress(startIdx + i, false));
+		}
+		return;
+	}
+	iotaParallelFor(count, _signingWorkers, iotaWalletDeriveWorker, &ctx);
+	for (unsigned int i = 0; i < count; i++) {
+		addrs.push_back(ctx.addrChars + i * (NUM_HASH_TRYTES + 1));
+	}
+	free(ctx.addrChars);
+	yield();
+}
+
+bool IotaWallet::findUsedAddresses(std::vector<String> &addrs,
+		unsigned int firstIdx, std::vector<bool> &used) {
+	std::vector<uint64_t> balances;
+	std::vector<bool> spent;
+
+	if (!_iotaClient.getBalances(addrs, balances) ||
+			(balances.size() != addrs.size())) {
+		DPRINTF("%s: couldn't get balances\n", __FUNCTION__);
+		return false;
+	}
+	if (!getSpentStates(addrs, firstIdx, spent)) {
+		return false;
+	}
+
+	/* Only addresses with no balance and never spent from need to be looked up
+	 * in transactions. */
+	std::vector<String> unknown;
+	used.resize(addrs.size());
+	for (unsigned int i = 0; i < addrs.size(); i++) {
+		used[i] = ((balances[i] != 0) || spent[i]);
+		if (!used[i]) {
+			unknown.push_back(addrs[i]);
+		}
+	}
+	if (unknown.empty()) {
+		return true;
+	}
+	std::vector<String> hashes;
+	if (!_iotaClient.findTransactions(hashes, std::vector<String>(),
+			unknown)) {
 		DPRINTF("%s: couldn't find transactions\n", __FUNCTION__);
 		return false;
 	}
-	*found = (txs.size() != 0);
+
+	/* Map transaction hashes back to addresses, retrieving trytes in small
+	 * chunks and stopping as soon as every address is known to be used. */
+	std::vector<String> chunk, trytes;
+	unsigned int remaining = unknown.size();
+	for (auto it = hashes.cbegin(); (it != hashes.cend()) && remaining; ) {
+		auto last = ((hashes.cend() - it > IOTACLIENT_STATIC_BATCH) ?
+				it + IOTACLIENT_STATIC_BATCH : hashes.cend());
+
+		chunk.assign(it, last);
+		it = last;
+		if (!_iotaClient.getTrytes(chunk, trytes)) {
+			DPRINTF("%s: couldn't get transaction trytes\n", __FUNCTION__);
+			return false;
+		}
+		for (auto tx = trytes.cbegin(); tx != trytes.cend(); tx++) {
+			String txAddr = tx->substring(IOTA_TX_ADDRESS_OFFSET,
+					IOTA_TX_ADDRESS_OFFSET + NUM_HASH_TRYTES);
+
+			for (unsigned int j = 0; j < addrs.size(); j++) {
+				if (!used[j] && (addrs[j] == txAddr)) {
+					used[j] = true;
+					remaining--;
+					break;
+				}
+			}
+		}
+	}
 	return true;
 }
 
-void *IotaWallet::allocBundle(int numInputs, bool withChange) {
-	struct iotaWalletBundle *bundle =
-			(struct iotaWalletBundle *) malloc(sizeof(*bundle));
+bool IotaWallet::getSpentStates(std::vector<String> &addrs,
+		unsigned int firstIdx, std::vector<bool> &spent) {
+	std::vector<String> unknown;
+	std::vector<bool> unknownSpent;
+
+	spent.resize(addrs.size());
+	for (unsigned int i = 0; i < addrs.size(); i++) {
+		spent[i] = (_ledger &&
+				_ledger->isSpent(firstIdx + i, addrs[i].c_str()));
+		if (!spent[i]) {
+			unknown.push_back(addrs[i]);
+		}
+	}
+	if (unknown.empty()) {
+		return true;
+	}
+	if (!_iotaClient.wereAddressesSpentFrom(unknown, unknownSpent) ||
+			(unknownSpent.size() != unknown.size())) {
+		DPRINTF("%s: couldn't get spent addresses\n", __FUNCTION__);
+		return false;
+	}
+	for (unsigned int i = 0, j = 0; i < addrs.size(); i++) {
+		if (spent[i]) {
+			continue;
+		}
+		if (unknownSpent[j++]) {
+			spent[i] = true;
+			if (_ledger) {
+				_ledger->markSpent(firstIdx + i, addrs[i].c_str());
+			}
+		}
+	}
+	if (_ledger) {
+		_ledger->save();
+	}
+	return true;
+}
+
+bool IotaWallet::getSpentStates(const IotaHashList &addrs,
+		unsigned int firstIdx, bool *spent) {
+	IotaHashArray<IOTACLIENT_STATIC_BATCH> unknown;
+	unsigned int unknownIdx[IOTACLIENT_STATIC_BATCH];
+	bool unknownSpent[IOTACLIENT_STATIC_BATCH];
 
+	for (unsigned int i = 0; i < addrs.size(); i++) {
+		spent[i] = (_ledger && _ledger->isSpent(firstIdx + i, addrs[i]));
+		if (!spent[i]) {
+			unknownIdx[unknown.size()] = i;
+			unknown.add(addrs[i]);
+		}
+
+		/* Query the node for addresses not in the ledger, one batch at a
+		 * time. */
+		if ((unknown.size() == unknown.capacity()) ||
+				((i == addrs.size() - 1) && (unknown.size() > 0))) {
+			if (!_iotaClient.wereAddressesSpentFrom(unknown, unknownSpent)) {
+				DPRINTF("%s: couldn't get spent addresses\n", __FUNCTION__);
+				return false;
+			}
+			for (unsigned int j = 0; j < unknown.size(); j++) {
+				if (unknownSpent[j]) {
+					spent[unknownIdx[j]] = true;
+					if (_ledger) {
+						_ledger->markSpent(firstIdx + unknownIdx[j],
+								unknown[j]);
+					}
+				}
+			}
+			unknown.clear();
+		}
+	}
+	if (_ledger) {
+		_ledger->save();
+	}
+	return true;
+}
+
+bool IotaWallet::createZeroValueTx(const char *addr,
+		std::vector<String> &txs) {
+	IOTA_TRACE_SCOPE("bundle");
+	struct iotaWalletBundle *bundle;
+
+	bundle = (struct iotaWalletBundle *) allocBundle(0, false);
 	if (!bundle) {
 		DPRINTF("%s: couldn't allocate memory for bundle\n", __FUNCTION__);
-		return NULL;
+		return false;
+	}
+	memcpy(bundle->outTx.address, addr, sizeof(bundle->outTx.address));
+	bundle->outTx.value = 0;
+	bundle->descr.timestamp = time(NULL);
+	iotaWalletBundleHashPtr = bundle->bundleHash;
+	iotaWalletTxPtr = &txs;
+	iota_wallet_create_tx_bundle_mem(iotaWalletBundleHashReceiver,
+			iotaWalletTxReceiver, &bundle->descr, &bundle->bundle_ctx, yield);
+	freeBundle(bundle);
+	return (txs.size() != 0);
+}
+
+bool IotaWallet::doPoW(String &trunk, String &branch,
+		std::vector<String> &txs) {
+	IOTA_TRACE_SCOPE("pow");
+	unsigned long startTime = millis();
+	bool ret;
+
+	if (_PoWClient) {
+		DPRINTF("%s: using external PoW client\n", __FUNCTION__);
+		ret = _PoWClient->pow(trunk, branch, _mwm, txs);
+	}
+	else {
+		ret = _iotaClient.attachToTangle(trunk, branch, _mwm, txs);
+	}
+	if (ret && (txs.size() != 0)) {
+		unsigned long timePerTx = (millis() - startTime) / txs.size();
+
+		/* Keep a moving average of the Proof of Work time per transaction. */
+		_powTimePerTx = (_powTimePerTx ? ((3 * _powTimePerTx + timePerTx) / 4) :
+				timePerTx);
+	}
+	return ret;
+}
+
+int IotaWallet::selectInputs(uint64_t value, unsigned int maxInputs,
+		unsigned int startAddrIdx, unsigned int *nextAddrIdx,
+		std::vector<struct iotaAddrWithBalance> &inputs,
+		uint64_t *inputBalance) {
+	std::vector<struct iotaAddrWithBalance> available;
+	uint64_t totalBalance;
+	unsigned int scanEndIdx;
+
+	/* Gather the balance index once, then let the selector choose. */
+	if (!getAddrsWithBalance(&available, 0, &totalBalance, 0, startAddrIdx,
+			&scanEndIdx)) {
+		DPRINTF("%s: couldn't get addresses with balance\n", __FUNCTION__);
+		return IOTA_ERR_NETWORK;
+	}
+	if (totalBalance < value) {
+		return IOTA_ERR_INSUFF_BALANCE;
+	}
+	if (!_inputSelector->select(available, value, maxInputs, inputs) ||
+			(inputs.size() > maxInputs)) {
+		return IOTA_ERR_FRAGM_BALANCE;
+	}
+	*inputBalance = 0;
+	for (auto it = inputs.cbegin(); it != inputs.cend(); it++) {
+		*inputBalance += it->balance;
+	}
+	if (*inputBalance < value) {
+		return IOTA_ERR_FRAGM_BALANCE;
+	}
+	if (nextAddrIdx) {
+		*nextAddrIdx = scanEndIdx;
+		for (auto it = available.cbegin(); it != available.cend(); it++) {
+			bool isInput = false;
+
+			for (auto in = inputs.cbegin(); in != inputs.cend(); in++) {
+				if (in->addrIdx == it->addrIdx) {
+					isInput = true;
+					break;
+				}
+			}
+			if (!isInput && (it->addrIdx < *nextAddrIdx)) {
+				*nextAddrIdx = it->addrIdx;
+			}
+		}
+	}
+	return IOTA_OK;
+}
+
+/* Selects the transactions to be approved; if an approvee is supplied, it is
+ * approved together with the trunk tip instead of the branch tip, and the
+ * consistency check is done on the approvee and the trunk tip. */
+int IotaWallet::getTips(String &trunk, String &branch, unsigned int numTxs,
+		const String *approvee) {
+	IOTA_TRACE_SCOPE("tips");
+
+	for (int i = 0; i < IOTAWALLET_TIPS_ATTEMPTS; i++) {
+		std::vector<String> tips;
+		bool consistent;
+
+		if (!_iotaClient.getTransactionsToApprove(_depth, trunk, branch)) {
+			return IOTA_ERR_NETWORK;
+		}
+		if (!_checkConsistency) {
+			return IOTA_OK;
+		}
+		tips.push_back(approvee ? *approvee : trunk);
+		tips.push_back(approvee ? trunk : branch);
+		if (!_iotaClient.checkConsistency(tips, consistent)) {
+			return IOTA_ERR_NETWORK;
+		}
+		if (consistent) {
+			return IOTA_OK;
+		}
+		DPRINTF("%s: inconsistent tips, retrying\n", __FUNCTION__);
+		_powTimeSaved += _powTimePerTx * numTxs;
+	}
+	return IOTA_ERR_INCONSISTENT;
+}
+
+unsigned int IotaWallet::signRounds(unsigned int numInputs) {
+	if ((_signingWorkers <= 1) || (numInputs <= 1)) {
+		return numInputs;
+	}
+	return (numInputs + _signingWorkers - 1) / _signingWorkers;
+}
+
+unsigned int IotaWallet::inputLimit() {
+	unsigned int limit = (MAX_BUNDLE_INDEX_SZ - 2) / _security;
+
+	if (_storage && (_storage->maxInputs < limit)) {
+		limit = _storage->maxInputs;
+	}
+	return limit;
+}
+
+void *IotaWallet::allocBundle(int numInputs, bool withChange) {
+	struct iotaWalletBundle *bundle;
+
+	if (_storage) {
+		if (numInputs > (int)_storage->maxInputs) {
+			DPRINTF("%s: too many inputs (%d)\n", __FUNCTION__, numInputs);
+			return NULL;
+		}
+		bundle = _storage->bundle;
+	}
+	else {
+		bundle = (struct iotaWalletBundle *) malloc(sizeof(*bundle));
+		if (!bundle) {
+			DPRINTF("%s: couldn't allocate memory for bundle\n",
+					__FUNCTION__);
+			return NULL;
+		}
 	}
 	memset(&bundle->descr, 0, sizeof(bundle->descr));
 	memset(bundle->outTx.tag, '9', sizeof(bundle->outTx.tag));
 	bundle->descr.output_txs = &bundle->outTx;
 	bundle->descr.output_txs_length = 1;
 	if (numInputs > 0) {
-		bundle->descr.input_txs = (iota_wallet_tx_input_t *) malloc(
-				numInputs * sizeof(iota_wallet_tx_input_t));
+		bundle->descr.input_txs = (_storage ? _storage->inputTxs :
+				(iota_wallet_tx_input_t *) malloc(
+				numInputs * sizeof(iota_wallet_tx_input_t)));
 		if (!bundle->descr.input_txs) {
 			DPRINTF("%s: couldn't allocate memory for input transactions\n",
 					__FUNCTION__);
@@ -553,8 +1476,9 @@ void *IotaWallet::allocBundle(int numInputs, bool withChange) {
 		bundle->descr.input_txs_length = numInputs;
 	}
 	if (withChange) {
-		bundle->descr.change_tx = (iota_wallet_tx_output_t *) malloc(
-				sizeof(iota_wallet_tx_output_t));
+		bundle->descr.change_tx = (_storage ? _storage->changeTx :
+				(iota_wallet_tx_output_t *) malloc(
+				sizeof(iota_wallet_tx_output_t)));
 		if (!bundle->descr.change_tx) {
 			DPRINTF("%s: couldn't allocate memory for change transaction\n",
 					__FUNCTION__);
@@ -571,6 +1495,9 @@ void *IotaWallet::allocBundle(int numInputs, bool withChange) {
 }
 
 void IotaWallet::freeBundle(void *bundle) {
+	if (_storage) {
+		return;
+	}
 	free(((struct iotaWalletBundle *)bundle)->descr.change_tx);
 	free(((struct iotaWalletBundle *)bundle)->descr.input_txs);
 	free(bundle);
@@ -46,12 +46,73 @@
 #define IOTA_ERR_INSUFF_BALANCE	-5
 #define IOTA_ERR_POW			-6
 #define IOTA_ERR_NO_MEM			-7
+#define IOTA_ERR_NOT_READY		-8
+#define IOTA_ERR_INCONSISTENT	-9
+
+/* Default number of transaction hashes retrieved at once by getHistory(). */
+#ifndef IOTAWALLET_HISTORY_PAGE
+#define IOTAWALLET_HISTORY_PAGE	32
+#endif
+
+/* Number of addresses derived and queried at once when looking for balances
+ * and receive addresses. */
+#ifndef IOTAWALLET_ADDR_BATCH
+#define IOTAWALLET_ADDR_BATCH	8
+#endif
+
+/* Default depth used by the IOTA node for the random walk that selects the
+ * transactions to be approved by a new bundle. */
+#ifndef IOTAWALLET_RANDOMWALK_DEPTH
+#define IOTAWALLET_RANDOMWALK_DEPTH	10
+#endif
+
+/* Default number of addresses derived and queried at once by findAddresses(). */
+#ifndef IOTAWALLET_SCAN_BATCH
+#define IOTAWALLET_SCAN_BATCH	16
+#endif
+
+class IotaBalanceTracker;
+class IotaBundleBuilder;
+class IotaInputSelector;
+class IotaSpentLedger;
+class IotaTransferTracker;
+
+struct iotaWalletStorage;
 
 struct iotaAddrWithBalance {
 	unsigned int addrIdx;
 	uint64_t balance;
 };
 
+struct iotaTransferEstimate {
+	std::vector<struct iotaAddrWithBalance> inputs;
+	int changeAddrIdx;	/* -1 if the transfer has no change transaction */
+	uint64_t changeValue;
+	unsigned int numTxs;
+	unsigned int numSigFragments;	/* 2187-tryte signature fragments */
+	size_t uploadBytes;		/* bytes sent to the node (not to a PoW client) */
+	size_t memoryBytes;		/* see IotaWallet::estimateTransferMemory() */
+	unsigned long signTime;	/* milliseconds, 0 if not calibrated */
+	unsigned long powTime;	/* milliseconds, 0 if not calibrated */
+};
+
+struct iotaHistoryRecord {
+	unsigned int addrIdx;
+	String addr;
+	String hash;
+	String bundle;
+	int64_t value;
+	int64_t timestamp;
+};
+
+/** Callback function for account history records
+      @param record  Transaction record
+      @param arg  Opaque argument supplied by the caller
+      @return true to continue receiving records, false to stop
+*/
+typedef bool (*iotaHistoryCallback)(const struct iotaHistoryRecord &record,
+		void *arg);
+
 class IotaWallet {
 public:
 
@@ -67,6 +128,12 @@ public:
 	*/
 	bool begin(String seed);
 
+	/** Initialize IOTA wallet with seed
+      @param seed  Null-terminated 81-character IOTA seed
+      @return true if supplied seed is valid, false otherwise
+	*/
+	bool begin(const char *seed);
+
 	/** Retrieve current security level
       The security level is an integer number between 1 and 3 that is used to
       generate IOTA addresses and to sign transactions.
@@ -77,6 +144,8 @@ public:
 	/** Configure security level
       The security level is an integer number between 1 and 3 that is used to
       generate IOTA addresses and to sign transactions.
+      The security level of a BasicIotaWallet is fixed at compile time and cannot
+      be changed.
       @param security  Security level
       @return true if supplied security level is valid, false otherwise
 	*/
@@ -108,6 +177,109 @@ public:
 	*/
 	void setPoWClient(PoWClient &client);
 
+	/** Configure transfer tracker
+      When a transfer tracker is configured, the transactions of each bundle
+      successfully sent with the sendTransfer() method are handed over to the
+      tracker, which can then monitor the bundle until it is confirmed,
+      promoting or reattaching it as needed without re-signing it.
+      @param tracker  Transfer tracker to which sent bundles are added
+      @return none
+	*/
+	void setTransferTracker(IotaTransferTracker &tracker);
+
+	/** Configure input selection strategy
+      By default, the sendTransfer() method uses as inputs the addresses with
+      positive balance in index order, until the transfer amount is covered.
+      With this method it is possible to use a different strategy (see the
+      IotaInputSelector abstract class and its implementations): in this case,
+      the balances of all addresses derived from the seed are retrieved once,
+      and the input selector chooses the inputs among them.
+      @param selector  IotaInputSelector class implementation that will be used
+             to select the inputs of a transfer
+      @return none
+	*/
+	void setInputSelector(IotaInputSelector &selector);
+
+	/** Configure balance tracker
+      When a balance tracker is configured, input and change addresses of
+      transfers sent by the wallet are added to the watched set of the
+      tracker.
+      @param tracker  Reference to balance tracker
+      @return none
+	*/
+	void setBalanceTracker(IotaBalanceTracker &tracker);
+
+	/** Configure local ledger of spent addresses
+      When a ledger is configured, addresses recorded in the ledger as spent
+      from are not checked with the IOTA full node when looking for receive
+      addresses, addresses with balance or used addresses; addresses found to
+      be spent from when querying the full node and inputs of transfers sent
+      by the wallet are recorded in the ledger, which is saved to its storage
+      backend (if any) whenever it changes. The ledger is bound to the wallet
+      seed and security level, and is cleared when either of them changes.
+      @param ledger  Reference to spent address ledger
+      @return none
+	*/
+	void setSpentLedger(IotaSpentLedger &ledger);
+
+	/** Configure number of signing workers
+      When a transfer has multiple inputs, the signatures of different inputs
+      can be computed in parallel on multi-core platforms; the same workers are
+      used to derive addresses in findAddresses(). By default, the
+      number of signing workers equals the number of processor cores (which
+      means that on single-core platforms inputs are signed serially).
+      @param workers  Maximum number of inputs signed in parallel; if 1, inputs
+             are signed serially
+      @return none
+	*/
+	void setSigningWorkers(unsigned int workers);
+
+	/** Enable or disable consistency check of transactions to be approved
+      When enabled, the transactions to be approved (tips) returned by the IOTA
+      node are checked for consistency before doing Proof of Work on a bundle;
+      inconsistent tips are discarded and new tips are requested, so that
+      Proof of Work is not wasted on a bundle that would be rejected by the
+      tangle. If no consistent tips are found after a few attempts, transfers
+      fail with IOTA_ERR_INCONSISTENT. Consistency check is disabled by
+      default.
+      @param enable  true to enable consistency check, false to disable it
+      @return none
+	*/
+	void setConsistencyCheck(bool enable);
+
+	/** Retrieve Proof of Work time saved by consistency checks
+      Each time a consistency check avoids doing Proof of Work on inconsistent
+      tips, the time that would have been spent doing Proof of Work is
+      estimated from the average Proof of Work time per transaction measured in
+      previous operations, and added to the value returned by this method.
+      @return estimated Proof of Work time saved, in milliseconds
+	*/
+	unsigned long getPoWTimeSaved();
+
+	/** Configure heap memory limit for transfers
+      When a limit is set, transfers whose estimated heap memory usage (see
+      estimateTransferMemory()) exceeds the limit fail with IOTA_ERR_NO_MEM:
+      the limit is checked before communicating with the IOTA node, and the
+      number of input addresses looked up is limited to those that fit in it;
+      the final check, which includes the change transaction, is done after
+      input addresses are selected, before the bundle is created.
+      @param bytes  Maximum heap memory usage, in bytes; 0 disables the limit
+      @return none
+	*/
+	void setMemoryLimit(size_t bytes);
+
+	/** Estimate heap memory needed to send a transfer
+      The estimate covers the creation of the bundle and its attachment to the
+      tangle, which are the most memory-intensive steps of a transfer; buffers
+      used by the network transport are not included. Actual usage can be
+      measured with iotaHeapGetStats() when the library is built with
+      IOTA_HEAP_STATS defined.
+      @param numInputs  Number of input addresses of the transfer
+      @param withChange  true if the transfer has a change transaction
+      @return estimated peak heap memory usage, in bytes
+	*/
+	size_t estimateTransferMemory(unsigned int numInputs, bool withChange);
+
 	/** Retrieve IOTA balance in the wallet
       This method works by requesting from the connected IOTA full node the
       balances associated to a series of consecutive addresses derived from the
@@ -151,6 +323,21 @@ public:
 	bool getReceiveAddress(String &addr, bool withChecksum = true,
 			unsigned int startIdx = -1, unsigned int *addrIdx = NULL);
 
+	/** Retrieve an address that can be used to receive an IOTA transfer
+      This method does the same as the previous one, without allocating heap
+      memory.
+      @param addr  Buffer that will hold the null-terminated address; it must
+             be at least 91 bytes long if the checksum is requested, 82 bytes
+             long otherwise
+      @param withChecksum  See previous method
+      @param startIdx  See previous method
+      @param addrIdx  See previous method
+      @return true if communication with the IOTA full node is successful, false
+              otherwise
+	*/
+	bool getReceiveAddress(char *addr, bool withChecksum = true,
+			unsigned int startIdx = -1, unsigned int *addrIdx = NULL);
+
 	/** Attach an address to the tangle
       This method creates a zero-valued IOTA transaction with the specified
       address and attaches it to the tangle by doing Proof of Work.
@@ -161,6 +348,51 @@ public:
 	*/
 	bool attachAddress(String addr);
 
+	/** Attach an address to the tangle
+      @param addr  Null-terminated address to be attached to the tangle (the
+             address checksum is not necessary)
+      @return true if communication with the IOTA full node is successful, false
+              otherwise
+	*/
+	bool attachAddress(const char *addr);
+
+	/** Promote a transaction
+      This method creates a zero-valued IOTA transaction that approves the
+      supplied transaction and attaches it to the tangle by doing Proof of
+      Work, in order to increase the probability that the supplied transaction
+      gets confirmed.
+      @param tailHash  Hash of the transaction to be promoted (typically the
+             tail transaction of a bundle)
+      @return true if communication with the IOTA full node is successful, false
+              otherwise
+	*/
+	bool promoteTransaction(String &tailHash);
+
+	/** Check whether a transaction can be promoted
+      A transaction can be promoted if it is consistent with the current ledger
+      state; if it is not, its bundle must be reattached instead.
+      @param tailHash  Hash of the transaction to be checked (typically the
+             tail transaction of a bundle)
+      @param promotable  Reference to variable that will be set to true if the
+             transaction can be promoted, false otherwise
+      @return true if communication with the IOTA full node is successful, false
+              otherwise
+	*/
+	bool isPromotable(String &tailHash, bool &promotable);
+
+	/** Reattach a bundle to the tangle
+      This method attaches an existing bundle to the tangle on top of newly
+      selected tips, by doing Proof of Work on the bundle transactions; the
+      bundle is not re-signed.
+      @param txs  Transactions constituting the bundle, in the same order as
+             supplied to the attachToTangle() method of the IOTA client; these
+             transactions are modified inside this method by replacing Proof of
+             Work data
+      @return true if communication with the IOTA full node is successful, false
+              otherwise
+	*/
+	bool reattachBundle(std::vector<String> &txs);
+
 	/** Verifies address checksum for correctness
       @param addr  Address (with appended 9-tryte checksum) whose checksum has
              to be verified
@@ -168,6 +400,13 @@ public:
 	*/
 	bool addrVerifyCksum(String addr);
 
+	/** Verifies address checksum for correctness
+      @param addr  Null-terminated address (with appended 9-tryte checksum)
+             whose checksum has to be verified
+      @return true if checksum is correct, false otherwise
+	*/
+	bool addrVerifyCksum(const char *addr);
+
 	/** Send a IOTA amount to a recipient address
       This method works by requesting from the connected IOTA full node the
       balances associated to a series of consecutive addresses derived from the
@@ -188,7 +427,9 @@ public:
              where the next call uses a "inputStartIdx" argument set to the
              value stored in the "inputAddrIdx" argument in the previous call;
              in this way, unnecessary queries to the IOTA full node to retrieve
-             the available balance can be avoided
+             the available balance can be avoided; if an input selector is
+             configured, this is the lowest index of the addresses with
+             positive balance that have not been selected as inputs
       @param changeStartIdx  Starting index to be used to search for the address
              to which the remainder from the IOTA transfer is sent ("change"
              address); if -1 (default value), this method manages internally the
@@ -202,6 +443,8 @@ public:
               IOTA_ERR_INV_ADDR: invalid recipient address
               IOTA_ERR_INV_TAG: invalid transaction tag
               IOTA_ERR_NETWORK: communication with IOTA full node failed
+              IOTA_ERR_INCONSISTENT: no consistent tips could be found (only
+                                     if consistency check is enabled)
               IOTA_ERR_FRAGM_BALANCE: the IOTA amount needed for the transfer is
                                       split between too many addresses
               IOTA_ERR_INSUFF_BALANCE: the IOTA amount needed for the transfer
@@ -216,6 +459,100 @@ public:
 			unsigned int changeStartIdx = -1,
 			unsigned int *changeAddrIdx = NULL);
 
+	/** Send a IOTA amount to a recipient address
+      Same as the previous method, with recipient address and tag supplied as
+      null-terminated strings.
+	*/
+	int sendTransfer(uint64_t value, const char *recipient,
+			const char *tag = "", unsigned int inputStartIdx = -1,
+			unsigned int *inputAddrIdx = NULL, unsigned int changeStartIdx = -1,
+			unsigned int *changeAddrIdx = NULL);
+
+	/** Prepare a transfer to be built incrementally
+      This method does the same network operations as sendTransfer() to
+      select the inputs and the change address of a transfer, and then
+      initializes the supplied builder, which does the CPU-intensive part of
+      creating the bundle (input address derivation, bundle assembly and
+      signing) in time-bounded steps (see the IotaBundleBuilder class). After
+      the builder is done, the transfer is sent with completeTransfer().
+      @param builder  Bundle builder to be initialized
+      @param value  IOTA amount to be sent to recipient
+      @param recipient  Address of recipient; it must have the 9-tryte checksum
+             appended to it
+      @param tag  Transaction tag (up to 27 trytes)
+      @param inputStartIdx  See sendTransfer()
+      @param inputAddrIdx  See sendTransfer()
+      @param changeStartIdx  See sendTransfer()
+      @param changeAddrIdx  See sendTransfer()
+      @return result codes: see sendTransfer()
+	*/
+	int prepareTransfer(IotaBundleBuilder &builder, uint64_t value,
+			String recipient, String tag = "", unsigned int inputStartIdx = -1,
+			unsigned int *inputAddrIdx = NULL, unsigned int changeStartIdx = -1,
+			unsigned int *changeAddrIdx = NULL);
+
+	/** Estimate the cost of a transfer without sending it
+      This method does the same network operations as sendTransfer() to
+      select the inputs and the change address of a transfer, and then reports
+      the bundle that would be created and the estimated time needed to sign
+      it and to do Proof of Work on it. Nothing is signed, attached or
+      broadcast. Time estimates are based on the signing time measured by
+      calibrateSigning() or by previous transfers, and on the Proof of Work
+      time measured by previous transfers or attachAddress() calls.
+      @param estimate  Structure that will hold the transfer estimate
+      @param value  IOTA amount to be sent to recipient
+      @param recipient  Address of recipient; it must have the 9-tryte checksum
+             appended to it
+      @param tag  Transaction tag (up to 27 trytes)
+      @param inputStartIdx  See sendTransfer()
+      @param changeStartIdx  See sendTransfer()
+      @return result codes: see sendTransfer()
+	*/
+	int estimateTransfer(struct iotaTransferEstimate &estimate, uint64_t value,
+			String recipient, String tag = "", unsigned int inputStartIdx = -1,
+			unsigned int changeStartIdx = -1);
+
+	/** Measure the time needed to compute a signature fragment
+      A signature fragment is computed for each input transaction of a bundle;
+      the measured time is used by estimateTransfer(), and is refined by
+      subsequent transfers signed in a single thread. Transfers whose inputs
+      are signed by multiple workers are timed separately, and their timing
+      is used to estimate transfers that will be signed the same way.
+      @return time needed to compute a signature fragment, in microseconds
+	*/
+	unsigned long calibrateSigning();
+
+	/** Retrieve calibrated operation timings
+      Timings can be saved to persistent storage and restored with
+      setTimings(), so that calibration is not repeated at each boot.
+      @param signTimePerFragment  Time needed to compute a signature fragment,
+             in microseconds
+      @param powTimePerTx  Proof of Work time per transaction, in milliseconds
+      @return none
+	*/
+	void getTimings(unsigned long &signTimePerFragment,
+			unsigned long &powTimePerTx);
+
+	/** Restore calibrated operation timings
+      @param signTimePerFragment  Time needed to compute a signature fragment,
+             in microseconds
+      @param powTimePerTx  Proof of Work time per transaction, in milliseconds
+      @return none
+	*/
+	void setTimings(unsigned long signTimePerFragment,
+			unsigned long powTimePerTx);
+
+	/** Send a transfer built incrementally
+      This method attaches to the tangle the bundle created by a builder that
+      has been initialized with prepareTransfer(), and then stores and
+      broadcasts it.
+      @param builder  Bundle builder that has completed building the bundle
+      @return result codes: see sendTransfer(); in addition,
+              IOTA_ERR_NOT_READY is returned if the builder has not completed
+              building the bundle
+	*/
+	int completeTransfer(IotaBundleBuilder &builder);
+
 	/** Generate IOTA public address from private seed
       @param index  Index to be used to generate the address
       @param withChecksum  boolean value indicating whether the returned address
@@ -226,6 +563,18 @@ public:
 	*/
 	String getAddress(unsigned int index = 0, bool withChecksum = true);
 
+	/** Generate IOTA public address from private seed into a buffer
+      @param index  Index to be used to generate the address
+      @param addr  Buffer that will hold the null-terminated address; it must
+             be at least 91 bytes long if the checksum is requested, 82 bytes
+             long otherwise
+      @param withChecksum  boolean value indicating whether the 9-tryte
+             checksum should be appended to the address
+      @return none
+	*/
+	void getAddressInto(unsigned int index, char *addr,
+			bool withChecksum = true);
+
 	/** Retrieve address indexes with positive balance
       This method works by requesting from the connected IOTA full node the
       balances associated to a series of consecutive addresses derived from the
@@ -274,15 +623,122 @@ public:
 	*/
 	bool findAddresses(std::vector<String> &addrs);
 
+	/** Retrieve addresses with transactions in the tangle, with a gap limit
+      This method scans addresses derived from the private seed in batches,
+      starting from address index 0: the addresses of each batch are derived
+      in parallel (see setSigningWorkers()), and the IOTA full node is queried
+      for all addresses of a batch at once. An address is considered used if it
+      has a positive balance, has been spent from, or is contained in at least
+      a transaction; the scan stops when a number of consecutive unused
+      addresses equal to the gap limit is found.
+      @param addrs  Reference to list to be filled with used addresses, in
+             ascending index order
+      @param gapLimit  Number of consecutive unused addresses after which the
+             scan is stopped
+      @param batchSize  Number of addresses derived and queried at once
+      @return true if communication with the IOTA full node is successful, false
+              otherwise
+	*/
+	bool findAddresses(std::vector<String> &addrs, unsigned int gapLimit,
+			unsigned int batchSize = IOTAWALLET_SCAN_BATCH);
+
+	/** Retrieve account history
+      This method scans addresses derived from the private seed in batches of
+      IOTAWALLET_SCAN_BATCH addresses, starting from address index 0, and
+      passes a record for each transaction found on these addresses to a
+      callback function; the scan stops when a number of consecutive addresses
+      without transactions equal to the gap limit is found. Transaction hashes
+      are retrieved in pages of a given size (the transactions of each page
+      are then retrieved a few at a time), so that the memory used does not
+      depend on the number of transactions; since the IOTA full node has no
+      paging support, pages after the first one are obtained by repeating the
+      query and skipping hashes already processed, which relies on the node
+      returning hashes in a consistent order.
+      @param callback  Function called for each transaction; if it returns
+             false, the scan is stopped
+      @param arg  Opaque argument passed to the callback function
+      @param gapLimit  Number of consecutive addresses without transactions
+             after which the scan is stopped
+      @param pageSize  Maximum number of transaction hashes held in memory
+      @return true if communication with the IOTA full node is successful, false
+              otherwise
+	*/
+	bool getHistory(iotaHistoryCallback callback, void *arg,
+			unsigned int gapLimit = 1,
+			unsigned int pageSize = IOTAWALLET_HISTORY_PAGE);
+
+protected:
+
+	/** Create an IOTA wallet that uses caller-supplied storage
+      Used by BasicIotaWallet to replace heap allocations and run-time limits
+      with buffers whose size is fixed at compile time. The storage is only
+      referenced by the constructor, so it may be filled in afterwards.
+      @param iotaClient  IOTA client used to communicate with full IOTA node
+      @param security  Security level, which cannot be changed afterwards
+      @param depth  Depth of the random walk used to select transactions to
+             approve
+      @param storage  Fixed-capacity storage for address scans and bundles
+      @return none
+	*/
+	IotaWallet(IotaClient &iotaClient, unsigned int security,
+			unsigned int depth, struct iotaWalletStorage &storage);
+
 private:
-	bool findAddress(char *addr, bool *found);
+	bool getBatchHistory(std::vector<String> &addrs, unsigned int firstIdx,
+			std::vector<bool> &used, iotaHistoryCallback callback, void *arg,
+			unsigned int pageSize, bool &stopped);
+	void deriveAddresses(unsigned int startIdx, unsigned int count,
+			std::vector<String> &addrs);
+	bool findUsedAddresses(std::vector<String> &addrs, unsigned int firstIdx,
+			std::vector<bool> &used);
+	bool getSpentStates(std::vector<String> &addrs, unsigned int firstIdx,
+			std::vector<bool> &spent);
+	bool getSpentStates(const IotaHashList &addrs, unsigned int firstIdx,
+			bool *spent);
+	bool scanReceiveAddress(IotaHashList &addrs, bool *spent, char *addr,
+			bool withChecksum, unsigned int startIdx, unsigned int *addrIdx);
+	bool scanAddrsWithBalance(IotaHashList &addrs, uint64_t *balances,
+			bool *spent, std::vector<struct iotaAddrWithBalance> *list,
+			int listMaxSize, uint64_t *totalBalance, uint64_t neededBalance,
+			unsigned int startAddrIdx, unsigned int *nextAddrIdx);
+	unsigned int inputLimit();
+	unsigned int signRounds(unsigned int numInputs);
+	bool createZeroValueTx(const char *addr, std::vector<String> &txs);
+	bool doPoW(String &trunk, String &branch, std::vector<String> &txs);
+	int getTips(String &trunk, String &branch, unsigned int numTxs,
+			const String *approvee = NULL);
+	int planTransfer(uint64_t value, String &recipient, String &tag,
+			unsigned int inputStartIdx, unsigned int *inputAddrIdx,
+			unsigned int changeStartIdx, unsigned int *changeAddrIdx,
+			std::vector<struct iotaAddrWithBalance> &inputAddrs,
+			String &changeAddr, uint64_t *changeValue);
+	int attachTransfer(std::vector<String> &txList,
+			std::vector<struct iotaAddrWithBalance> &inputAddrs,
+			bool updateSpentAddr, unsigned int changeAddrIdx);
+	int selectInputs(uint64_t value, unsigned int maxInputs,
+			unsigned int startAddrIdx, unsigned int *nextAddrIdx,
+			std::vector<struct iotaAddrWithBalance> &inputs,
+			uint64_t *inputBalance);
 	void *allocBundle(int numInputs, bool withChange);
 	void freeBundle(void *bundle);
+	void bindLedger();
 	unsigned char _seedBytes[48];
 	unsigned int _security;
+	unsigned int _depth;
 	unsigned int _mwm;
+	struct iotaWalletStorage *_storage;
+	size_t _memoryLimit;
 	IotaClient &_iotaClient;
 	PoWClient *_PoWClient;
+	IotaTransferTracker *_tracker;
+	IotaBalanceTracker *_balanceTracker;
+	IotaInputSelector *_inputSelector;
+	IotaSpentLedger *_ledger;
+	bool _seeded;
+	unsigned int _signingWorkers;
+	bool _checkConsistency;
+	unsigned long _powTimePerTx, _powTimeSaved;
+	unsigned long _signTimePerFragment, _workerSignTimePerFragment;
 	int _firstUnspentAddr, _lastSpentAddr;
 };
 
@@ -0,0 +1,146 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "IotaWorkers.h"
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#elif defined(__linux__)
+#include <exception>
+#include <thread>
+#include <vector>
+#endif
+
+/* Work items are claimed atomically only where workers can run concurrently;
+ * elsewhere the calling task is the only worker, and some targets (e.g.
+ * Cortex-M0) lack the atomic helpers. */
+#if defined(ESP32) || defined(__linux__)
+#define IOTAWORKER_NEXT_INDEX(job)	\
+	__atomic_fetch_add(&(job)->next, 1, __ATOMIC_RELAXED)
+#else
+#define IOTAWORKER_NEXT_INDEX(job)	((job)->next++)
+#endif
+
+struct iotaWorkerJob {
+	void (*func)(void *arg, unsigned int idx);
+	void *arg;
+	unsigned int count;
+	unsigned int next;
+#if defined(ESP32)
+	SemaphoreHandle_t done;
+#endif
+};
+
+static void iotaWorkerRun(struct iotaWorkerJob *job) {
+	unsigned int idx;
+
+	while ((idx = IOTAWORKER_NEXT_INDEX(job)) < job->count) {
+		job->func(job->arg, idx);
+	}
+}
+
+#if defined(ESP32)
+static void iotaWorkerTask(void *param) {
+	struct iotaWorkerJob *job = (struct iotaWorkerJob *) param;
+
+	iotaWorkerRun(job);
+	xSemaphoreGive(job->done);
+	vTaskDelete(NULL);
+}
+#endif
+
+unsigned int iotaWorkersDefault() {
+#if defined(ESP32)
+	return portNUM_PROCESSORS;
+#elif defined(__linux__)
+	unsigned int cores = std::thread::hardware_concurrency();
+
+	return (cores ? cores : 1);
+#else
+	return 1;
+#endif
+}
+
+void iotaParallelFor(unsigned int count, unsigned int workers,
+		void (*func)(void *arg, unsigned int idx), void *arg) {
+	struct iotaWorkerJob job;
+
+	job.func = func;
+	job.arg = arg;
+	job.count = count;
+	job.next = 0;
+	if (workers > count) {
+		workers = count;
+	}
+	if (workers <= 1) {
+		iotaWorkerRun(&job);
+		return;
+	}
+#if defined(ESP32)
+	unsigned int spawned = 0;
+
+	job.done = xSemaphoreCreateCounting(workers - 1, 0);
+	if (job.done) {
+		for (unsigned int i = 1; i < workers; i++) {
+			if (xTaskCreatePinnedToCore(iotaWorkerTask, "iotaWorker",
+					IOTAWORKERS_STACK_SIZE, &job, uxTaskPriorityGet(NULL),
+					NULL, i % portNUM_PROCESSORS) == pdPASS) {
+				spawned++;
+			}
+		}
+	}
+
+	/* If some tasks could not be created, the calling task does their share
+	 * of work. */
+	iotaWorkerRun(&job);
+	for (unsigned int i = 0; i < spawned; i++) {
+		xSemaphoreTake(job.done, portMAX_DELAY);
+	}
+	if (job.done) {
+		vSemaphoreDelete(job.done);
+	}
+#elif defined(__linux__)
+	std::vector<std::thread> threads;
+
+	/* If some threads could not be created (std::system_error), the calling
+	 * thread does their share of work. */
+	try {
+		threads.reserve(workers - 1);
+		for (unsigned int i = 1; i < workers; i++) {
+			threads.emplace_back(iotaWorkerRun, &job);
+		}
+	}
+	catch (const std::exception &) {
+	}
+	iotaWorkerRun(&job);
+	for (auto it = threads.begin(); it != threads.end(); it++) {
+		it->join();
+	}
+#else
+	iotaWorkerRun(&job);
+#endif
+}
@@ -0,0 +1,55 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Francesco Lavra <francescolavra.fl@gmail.com>
+ * and Contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _IOTA_WORKERS_H_
+#define _IOTA_WORKERS_H_
+
+/* Stack size of worker tasks on FreeRTOS-based platforms. */
+#ifndef IOTAWORKERS_STACK_SIZE
+#define IOTAWORKERS_STACK_SIZE	8192
+#endif
+
+/** Retrieve the default number of workers
+      @return number of processor cores available to run workers in parallel
+              (1 on single-core platforms)
+*/
+unsigned int iotaWorkersDefault();
+
+/** Run a function on a range of indexes using a pool of workers
+      The function is called once for each index between 0 and count - 1,
+      possibly from different threads or tasks; the calling thread takes part
+      in the work, and this function returns only after all indexes have been
+      processed. On platforms without multi-threading support, or if the number
+      of workers is 1, indexes are processed serially by the calling thread.
+      @param count  Number of indexes to be processed
+      @param workers  Maximum number of workers (including the calling thread)
+      @param func  Function to be called for each index
+      @param arg  Opaque argument passed to each invocation of the function
+      @return none
+*/
+void iotaParallelFor(unsigned int count, unsigned int workers,
+		void (*func)(void *arg, unsigned int idx), void *arg);
+
+#endif